@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""
+VIBE-PY C COMPILER CLIENT
+=========================
+Thin client for `c-compiler.py --server`. Forwards its command line and
+working directory to the warm compiler over a Unix domain socket, streams
+back diagnostics, and exits with the compiler's exit status.
+
+Deliberately imports only the standard library modules it needs, so each
+invocation avoids loading the compiler itself. If no server is running,
+the request is executed by a regular c-compiler.py process instead.
+
+Usage: python3 c-compiler-client.py [--socket PATH] <c-compiler.py arguments>
+
+Author: Anim-101
+License: MIT
+"""
+
+import sys
+import os
+import json
+import socket
+
+def default_socket_path() -> str:
+    """Must match default_socket_path() in c-compiler.py."""
+    if os.environ.get('VIBE_CC_SOCKET'):
+        return os.environ['VIBE_CC_SOCKET']
+    if os.environ.get('XDG_RUNTIME_DIR'):
+        return os.path.join(os.environ['XDG_RUNTIME_DIR'], "vibe-cc.sock")
+    return f"/tmp/vibe-cc-{os.getuid()}/server.sock"
+
+def take_socket_option(argv):
+    """Remove --socket PATH (or --socket=PATH) from argv; return the path or None."""
+    for i, arg in enumerate(argv):
+        if arg == '--socket' and i + 1 < len(argv):
+            path = argv[i + 1]
+            del argv[i:i + 2]
+            return path
+        if arg.startswith('--socket='):
+            del argv[i]
+            return arg[len('--socket='):]
+    return None
+
+def untrusted_server(client, path):
+    """Why the server on path may belong to another user, or None if it is ours."""
+    uid = os.getuid()
+    owner = os.stat(path).st_uid
+    if owner != uid:
+        return f"socket is owned by uid {owner}"
+    if hasattr(socket, 'SO_PEERCRED'):
+        import struct
+        credentials = client.getsockopt(socket.SOL_SOCKET, socket.SO_PEERCRED, struct.calcsize('3i'))
+        peer = struct.unpack('3i', credentials)[1]
+        if peer != uid:
+            return f"server runs as uid {peer}"
+    return None
+
+def run_locally(argv):
+    """Fall back to an ordinary compiler process."""
+    compiler = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'c-compiler.py')
+    os.execv(sys.executable, [sys.executable, compiler] + argv)
+
+def main():
+    argv = sys.argv[1:]
+    
+    path = take_socket_option(argv) or default_socket_path()
+    client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        client.connect(path)
+        # The request carries argv, cwd and sources: never send it to another user
+        problem = untrusted_server(client, path)
+    except OSError:
+        client.close()
+        run_locally(argv)
+    if problem:
+        print(f"⚠️  Not using compiler server {path}: {problem}", file=sys.stderr)
+        client.close()
+        run_locally(argv)
+    
+    with client, client.makefile('rb') as responses:
+        request = json.dumps({'argv': argv, 'cwd': os.getcwd()}) + "\n"
+        client.sendall(request.encode())
+        
+        for line in responses:
+            message = json.loads(line.decode())
+            if 'exit' in message:
+                sys.stdout.flush()
+                sys.exit(message['exit'])
+            stream = sys.stderr if message.get('stream') == 'stderr' else sys.stdout
+            stream.write(message['data'])
+            stream.flush()
+    
+    print("❌ Error: compiler server closed the connection", file=sys.stderr)
+    sys.exit(1)
+
+if __name__ == "__main__":
+    main()
@@ -19,10 +19,493 @@ import sys
 import os
 import re
 import enum
-from typing import List, Dict, Optional, Union, Any, Set
-from dataclasses import dataclass
+from typing import List, Dict, Optional, Union, Any, Set, Tuple
+from dataclasses import dataclass, field
 from abc import ABC, abstractmethod
 
+COMPILER_VERSION = "1.1.0"
+
+# ============================================================================
+# DIAGNOSTIC LOGGING
+# ============================================================================
+
+class LogLevel(enum.IntEnum):
+    """Verbosity levels; a message is shown when its level <= the logger's."""
+    ERROR = 0    # -q shows errors only
+    INFO = 1     # Default: phase progress and summaries
+    DEBUG = 2    # -v: per-function and per-pass details
+    TRACE = 3    # -vv: per-node, per-token and per-register details
+
+class Logger:
+    """
+    Leveled diagnostic logger.
+    
+    Messages use %-style arguments that are only formatted when the level is
+    enabled, so disabled diagnostics cost a method call and one comparison.
+    Hot loops should additionally test enabled() before iterating.
+    Output goes to whatever sys.stdout is at call time, so redirected
+    worker and server output is captured.
+    """
+    
+    def __init__(self, level: LogLevel = LogLevel.INFO):
+        self.level = level
+    
+    def set_level(self, level: LogLevel):
+        self.level = level
+    
+    def enabled(self, level: LogLevel) -> bool:
+        return level <= self.level
+    
+    def log(self, level: LogLevel, message: str, *args):
+        if level <= self.level:
+            stream = sys.stdout
+            stream.write((message % args if args else message) + "\n")
+            stream.flush()
+    
+    def error(self, message: str, *args):
+        self.log(LogLevel.ERROR, message, *args)
+    
+    def info(self, message: str, *args):
+        if LogLevel.INFO <= self.level:
+            self.log(LogLevel.INFO, message, *args)
+    
+    def debug(self, message: str, *args):
+        if LogLevel.DEBUG <= self.level:
+            self.log(LogLevel.DEBUG, message, *args)
+    
+    def trace(self, message: str, *args):
+        if LogLevel.TRACE <= self.level:
+            self.log(LogLevel.TRACE, message, *args)
+
+log = Logger()
+
+# ============================================================================
+# COMPILATION TRACING
+# ============================================================================
+
+class TraceRecorder:
+    """
+    Records a timeline in the Chrome trace-event format (--trace FILE).
+    
+    Spans become B/E event pairs and counters become C events; the JSON
+    loads in Perfetto or chrome://tracing. Listeners (see MemoryProfiler)
+    are notified of span begin/end even when no trace file is written.
+    When neither is active, span() returns a shared no-op context manager
+    so instrumentation is free.
+    """
+    
+    class _NullSpan:
+        def __enter__(self):
+            return self
+        
+        def __exit__(self, *exc):
+            return False
+        
+        def set(self, **args):
+            pass
+    
+    class _Span:
+        def __init__(self, recorder: 'TraceRecorder', name: str, category: str, args: Dict[str, Any]):
+            self.recorder = recorder
+            self.name = name
+            self.category = category
+            self.args = args
+            self.end_args = {}
+        
+        def __enter__(self):
+            if self.recorder.enabled:
+                self.recorder._event('B', self.name, self.category, self.args)
+            for listener in self.recorder.listeners:
+                listener.begin_span(self)
+            return self
+        
+        def __exit__(self, *exc):
+            for listener in reversed(self.recorder.listeners):
+                listener.end_span(self)
+            if self.recorder.enabled:
+                self.recorder._event('E', self.name, self.category, self.end_args)
+            return False
+        
+        def set(self, **args):
+            """Attach results (counts, sizes) to the span's end event."""
+            self.end_args = dict(self.end_args, **args)
+    
+    _NULL_SPAN = _NullSpan()
+    
+    def __init__(self):
+        self.enabled = False
+        self.events = []
+        self.listeners = []  # Objects with begin_span(span) / end_span(span)
+    
+    def enable(self):
+        self.enabled = True
+        self.events = []
+        self._name_process(os.getpid(), "vibe-cc")
+    
+    def _name_process(self, pid: int, name: str):
+        self.events.append({'name': 'process_name', 'ph': 'M', 'pid': pid,
+                            'tid': 0, 'args': {'name': name}})
+    
+    def _event(self, phase: str, name: str, category: str, args: Dict[str, Any]):
+        import time
+        import threading
+        event = {'name': name, 'cat': category, 'ph': phase,
+                 'ts': time.perf_counter() * 1e6, 'pid': os.getpid(),
+                 'tid': threading.get_native_id()}
+        if args:
+            event['args'] = args
+        self.events.append(event)
+    
+    @property
+    def active(self) -> bool:
+        """True if spans are recorded or observed (worth computing span args)."""
+        return self.enabled or bool(self.listeners)
+    
+    def span(self, name: str, category: str = "compiler", **args):
+        """Context manager timing a phase; args are attached to the begin event."""
+        if not self.active:
+            return self._NULL_SPAN
+        return self._Span(self, name, category, args)
+    
+    def counter(self, name: str, **values):
+        """Record counter values (plotted as a track in the viewer)."""
+        if self.enabled:
+            self._event('C', name, "counter", values)
+    
+    def merge(self, events: List[Dict[str, Any]]):
+        """Add events recorded in another process (parallel build workers)."""
+        known = {e['pid'] for e in self.events}
+        for pid in sorted({e['pid'] for e in events} - known):
+            self._name_process(pid, f"vibe-cc worker {pid}")
+        self.events.extend(e for e in events if e['ph'] != 'M')
+    
+    def save(self, path: str):
+        import json
+        with open(path, 'w') as f:
+            json.dump({'traceEvents': self.events, 'displayTimeUnit': 'ms'}, f)
+        log.info("📈 Wrote trace with %s events to %s (open in https://ui.perfetto.dev)",
+                 len(self.events), path)
+
+tracer = TraceRecorder()
+
+# ============================================================================
+# MEMORY ACCOUNTING
+# ============================================================================
+
+class MemoryProfiler:
+    """
+    Per-phase memory report (--mem-report), driven by tracer spans.
+    
+    For every compiler phase, optimization pass and toolchain step it records
+    net bytes still allocated at the end, the peak above the phase's starting
+    point (nesting aware, via tracemalloc.reset_peak), the top allocation
+    sites, and live AST node counts per class. Repeated phases (passes run
+    in several iterations) are aggregated by name.
+    """
+    
+    TRACKED_CATEGORIES = {"compiler", "optimizer", "toolchain", "vm"}
+    # Allocation sites not worth reporting (isinstance() caches, imports)
+    IGNORED_SITES = ("<frozen abc>", "<frozen importlib._bootstrap", "tracemalloc.py")
+    
+    def __init__(self, top_sites: int = 3):
+        self.top_sites = top_sites
+        self.phases = {}   # name -> aggregated record, in first-seen order
+        self.stack = []    # Open phases: [span, start bytes, peak bytes, snapshot]
+    
+    def start(self):
+        import tracemalloc
+        tracemalloc.start(1)  # Sites are grouped by their innermost frame
+        tracer.listeners.append(self)
+    
+    def stop(self):
+        import tracemalloc
+        if self in tracer.listeners:
+            tracer.listeners.remove(self)
+        tracemalloc.stop()
+    
+    def _snapshot(self):
+        import tracemalloc
+        return tracemalloc.take_snapshot()
+    
+    def _raise_open_peaks(self, peak: int):
+        for entry in self.stack:
+            entry[2] = max(entry[2], peak)
+    
+    def begin_span(self, span):
+        if span.category not in self.TRACKED_CATEGORIES:
+            return
+        import tracemalloc
+        snapshot = self._snapshot()
+        current, peak = tracemalloc.get_traced_memory()
+        self._raise_open_peaks(peak)
+        tracemalloc.reset_peak()
+        self.stack.append([span, current, current, snapshot])
+    
+    def end_span(self, span):
+        if not self.stack or self.stack[-1][0] is not span:
+            return
+        import tracemalloc
+        current, peak = tracemalloc.get_traced_memory()
+        self._raise_open_peaks(peak)
+        _, start, phase_peak, before = self.stack.pop()
+        
+        sites = []
+        for stat in self._snapshot().compare_to(before, 'lineno'):
+            if len(sites) == self.top_sites:
+                break
+            frame = stat.traceback[0]
+            if stat.size_diff <= 0 or frame.filename.startswith(self.IGNORED_SITES) or \
+               frame.filename.endswith(self.IGNORED_SITES):
+                continue  # Sorted by absolute change, so shrinking sites are interleaved
+            sites.append({'site': f"{os.path.basename(frame.filename)}:{frame.lineno}",
+                          'bytes': stat.size_diff, 'blocks': stat.count_diff})
+        
+        record = self.phases.setdefault(span.name, {
+            'phase': span.name, 'category': span.category, 'runs': 0,
+            'allocated_bytes': 0, 'peak_bytes': 0, 'top_sites': [], 'ast_nodes': {}})
+        record['runs'] += 1
+        record['allocated_bytes'] += current - start
+        record['peak_bytes'] = max(record['peak_bytes'], phase_peak - start)
+        if sites and sites[0]['bytes'] >= sum(s['bytes'] for s in record['top_sites'][:1]):
+            record['top_sites'] = sites
+        record['ast_nodes'] = self.count_ast_nodes()
+    
+    @staticmethod
+    def count_ast_nodes() -> Dict[str, int]:
+        """Live AST node instances per class."""
+        import gc
+        counts = {}
+        for obj in gc.get_objects():
+            if isinstance(obj, ASTNode):
+                name = type(obj).__name__
+                counts[name] = counts.get(name, 0) + 1
+        return dict(sorted(counts.items(), key=lambda item: -item[1]))
+    
+    def to_json(self) -> Dict[str, Any]:
+        import resource
+        import tracemalloc
+        peak_rss_kib = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+        return {'compiler_version': COMPILER_VERSION,
+                'peak_rss_bytes': peak_rss_kib * 1024,
+                'traced_peak_bytes': tracemalloc.get_traced_memory()[1] if tracemalloc.is_tracing() else None,
+                'phases': list(self.phases.values())}
+    
+    def report(self, json_path: Optional[str] = None):
+        """Print the phase table and AST node counts, and optionally write JSON."""
+        report = self.to_json()
+        
+        def kib(n):
+            return f"{n / 1024:,.1f}"
+        
+        print(f"🧠 Memory report (peak RSS {kib(report['peak_rss_bytes'])} KiB)")
+        print(f"   {'Phase':<28} {'Runs':>4} {'Net KiB':>10} {'Peak KiB':>10}  Top allocation site")
+        for phase in report['phases']:
+            site = phase['top_sites'][0] if phase['top_sites'] else None
+            site_text = f"{site['site']} (+{kib(site['bytes'])} KiB)" if site else "-"
+            print(f"   {phase['phase']:<28} {phase['runs']:>4} {kib(phase['allocated_bytes']):>10} "
+                  f"{kib(phase['peak_bytes']):>10}  {site_text}")
+        
+        # AST node population after parsing and after the last optimization pass
+        columns = [("after parse", p) for p in report['phases'] if p['phase'] == 'parse']
+        optimized = [p for p in report['phases'] if p['category'] == 'optimizer' and p['phase'] != 'peephole']
+        if optimized:
+            columns.append(("after optimization", optimized[-1]))
+        if columns:
+            first = columns[0][1]['ast_nodes']
+            classes = sorted({c for _, p in columns for c in p['ast_nodes']},
+                             key=lambda c: -first.get(c, 0))
+            header = "".join(f" {label:>20}" for label, _ in columns)
+            print(f"\n   {'AST node class':<24}{header}")
+            for cls in classes:
+                counts = "".join(f" {p['ast_nodes'].get(cls, 0):>20}" for _, p in columns)
+                print(f"   {cls:<24}{counts}")
+        
+        if json_path:
+            import json
+            with open(json_path, 'w') as f:
+                json.dump(report, f, indent=2)
+            log.info("📄 Wrote memory report to %s", json_path)
+
+# ============================================================================
+# TIME ACCOUNTING
+# ============================================================================
+
+class TimeReport:
+    """
+    Per-phase, per-pass and per-analysis timing (--time-report), driven by
+    tracer spans like MemoryProfiler.
+    
+    Every span records wall time, CPU time and self time (wall time minus
+    nested spans, so a pass does not also count the analyses it requested).
+    Optimizer spans also carry the AST nodes the pass or analysis was given
+    and the transformations it applied in that invocation. Records are
+    aggregated by name in total and by (name, function) for optimizer work.
+    """
+    
+    TRACKED_CATEGORIES = {"compiler", "optimizer", "codegen", "toolchain", "vm", "driver"}
+    
+    def __init__(self, top_functions: int = 10):
+        self.top_functions = top_functions
+        self.totals = {}      # name -> aggregated record, in first-seen order
+        self.functions = {}   # function name -> {name -> aggregated record}
+        self.stack = []       # Open spans: [span, wall start, cpu start, nested wall]
+    
+    def start(self):
+        tracer.listeners.append(self)
+    
+    def stop(self):
+        if self in tracer.listeners:
+            tracer.listeners.remove(self)
+    
+    def begin_span(self, span):
+        if span.category not in self.TRACKED_CATEGORIES:
+            return
+        import time
+        self.stack.append([span, time.perf_counter(), time.process_time(), 0.0])
+    
+    def end_span(self, span):
+        if not self.stack or self.stack[-1][0] is not span:
+            return
+        import time
+        wall_end, cpu_end = time.perf_counter(), time.process_time()
+        _, wall_start, cpu_start, nested = self.stack.pop()
+        wall = wall_end - wall_start
+        if self.stack:
+            self.stack[-1][3] += wall
+        
+        sample = {'wall': wall, 'self': wall - nested, 'cpu': cpu_end - cpu_start,
+                  'nodes': span.args.get('nodes', span.end_args.get('nodes', 0)),
+                  'changes': span.end_args.get('optimizations', 0)}
+        self._add(self.totals, span.name, span.category, sample)
+        function = span.args.get('function')
+        if function is not None:
+            self._add(self.functions.setdefault(function, {}), span.name, span.category, sample)
+    
+    @staticmethod
+    def _add(records: Dict[str, Dict[str, Any]], name: str, category: str, sample: Dict[str, float]):
+        record = records.setdefault(name, {'name': name, 'category': category, 'runs': 0,
+                                           'wall': 0.0, 'self': 0.0, 'cpu': 0.0,
+                                           'nodes': 0, 'changes': 0})
+        record['runs'] += 1
+        for key, value in sample.items():
+            record[key] += value
+    
+    def to_json(self) -> Dict[str, Any]:
+        return {'compiler_version': COMPILER_VERSION,
+                'total_wall_seconds': sum(r['self'] for r in self.totals.values()),
+                'phases': list(self.totals.values()),
+                'functions': {name: list(records.values())
+                              for name, records in self.functions.items()}}
+    
+    def _print_table(self, title: str, records: List[Dict[str, Any]], total: float):
+        def ms(seconds):
+            return f"{seconds * 1000:,.2f}"
+        
+        print(f"   {title:<34} {'Runs':>5} {'Wall ms':>10} {'Self ms':>10} {'CPU ms':>10} "
+              f"{'Self %':>6} {'Nodes':>9} {'Changes':>7}")
+        for r in records:
+            share = 100.0 * r['self'] / total if total else 0.0
+            print(f"   {r['name']:<34} {r['runs']:>5} {ms(r['wall']):>10} {ms(r['self']):>10} "
+                  f"{ms(r['cpu']):>10} {share:>5.1f}% {r['nodes']:>9,} {r['changes']:>7,}")
+    
+    def report(self, json_path: Optional[str] = None):
+        """Print totals per phase/pass/analysis and the slowest functions, optionally as JSON."""
+        report = self.to_json()
+        total = report['total_wall_seconds']
+        
+        print(f"⏱️  Time report (total {total * 1000:,.2f} ms wall)")
+        by_self = sorted(report['phases'], key=lambda r: -r['self'])
+        self._print_table("Phase, pass or analysis", by_self, total)
+        
+        # Functions ranked by optimizer time; each lists its passes and analyses
+        ranked = sorted(report['functions'].items(),
+                        key=lambda item: -sum(r['self'] for r in item[1]))
+        for name, records in ranked[:self.top_functions]:
+            spent = sum(r['self'] for r in records)
+            print(f"\n   Function {name} ({spent * 1000:,.2f} ms)")
+            self._print_table("Pass or analysis", sorted(records, key=lambda r: -r['self']), total)
+        if len(ranked) > self.top_functions:
+            print(f"\n   ... {len(ranked) - self.top_functions} more functions"
+                  + (f" in {json_path}" if json_path else ""))
+        
+        if json_path:
+            import json
+            with open(json_path, 'w') as f:
+                json.dump(report, f, indent=2)
+            log.info("📄 Wrote time report to %s", json_path)
+
+# ============================================================================
+# OPTIMIZATION REMARKS
+# ============================================================================
+
+class RemarkRecorder:
+    """
+    Structured optimization remarks (-fsave-optimization-record).
+    
+    Passes report what they did ('applied'), what they considered but
+    rejected and why ('missed') and facts they computed ('analysis'), with
+    the numbers behind each decision. Remarks are collected per translation
+    unit and written as JSON Lines, one remark per line. When disabled,
+    emit() returns immediately.
+    """
+    
+    KINDS = ('applied', 'missed', 'analysis')
+    
+    def __init__(self):
+        self.enabled = False
+        self.records = []
+        self.seen = set()      # Missed and analysis remarks already recorded
+        self.source = None     # Translation unit being compiled
+        self.function = None   # Function the PassManager is optimizing
+    
+    def enable(self):
+        self.enabled = True
+    
+    def begin(self, source: Optional[str]):
+        """Start collecting remarks for one translation unit."""
+        self.records = []
+        self.seen = set()
+        self.source = source
+        self.function = None
+    
+    def emit(self, opt_pass, kind: str, name: str, reason: str,
+             function: Optional[str] = None, node: Optional['ASTNode'] = None, **metrics):
+        """Record one remark from opt_pass about node; metrics are the decision's inputs."""
+        if not self.enabled:
+            return
+        assert kind in self.KINDS, kind
+        location = {'file': self.source, 'function': function or self.function}
+        if node is not None and node.loc:
+            location['line'], location['column'] = node.loc[0], node.loc[1]
+        record = {
+            'pass': getattr(opt_pass, 'pipeline_name', None) or opt_pass.name,
+            'name': name,
+            'kind': kind,
+            'location': location,
+            'reason': reason,
+            'metrics': metrics,
+        }
+        if kind != 'applied':
+            # Passes rerun until a function settles; report each decision once
+            import json
+            key = json.dumps(record, sort_keys=True)
+            if key in self.seen:
+                return
+            self.seen.add(key)
+        self.records.append(record)
+    
+    def save(self, path: str):
+        """Write the unit's remarks as JSON Lines."""
+        import json
+        with open(path, 'w') as f:
+            for record in self.records:
+                f.write(json.dumps(record) + "\n")
+        counts = {kind: sum(r['kind'] == kind for r in self.records) for kind in self.KINDS}
+        log.info("📝 Wrote %s optimization remarks to %s (%s)", len(self.records), path,
+                 ", ".join(f"{n} {kind}" for kind, n in counts.items()))
+
+remarks = RemarkRecorder()
+
 # ============================================================================
 # TOKEN DEFINITIONS
 # ============================================================================
@@ -156,13 +639,31 @@ class Token:
 # ============================================================================
 
 class ASTNode(ABC):
-    """Base class for all AST nodes."""
+    """
+    Base class for all AST nodes.
+    
+    Every node class ends with a loc field: the source span
+    (line, column, end line, end column) from its first to its last token,
+    or None for nodes synthesized by optimizations. It is left out of
+    equality and repr, so structural comparisons ignore where code came from.
+    """
     pass
 
+def source_span() -> Any:
+    """Field spec for the loc attribute every node class ends with."""
+    return field(default=None, compare=False, repr=False)
+
+def copy_location(node: ASTNode, source: Optional[ASTNode]) -> ASTNode:
+    """Give a node built to replace source the same span, unless it has one."""
+    if source is not None and getattr(node, 'loc', None) is None:
+        node.loc = source.loc
+    return node
+
 @dataclass
 class Program(ASTNode):
     """Root node of the AST representing the entire program."""
     declarations: List[ASTNode]
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class FunctionDeclaration(ASTNode):
@@ -171,12 +672,14 @@ class FunctionDeclaration(ASTNode):
     name: str
     parameters: List['Parameter']
     body: Optional['CompoundStatement']
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass 
 class Parameter(ASTNode):
     """Function parameter."""
     type: str
     name: str
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class VariableDeclaration(ASTNode):
@@ -184,21 +687,25 @@ class VariableDeclaration(ASTNode):
     type: str
     name: str
     initializer: Optional[ASTNode] = None
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class CompoundStatement(ASTNode):
     """Block statement with curly braces."""
     statements: List[ASTNode]
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class ExpressionStatement(ASTNode):
     """Statement containing an expression."""
     expression: ASTNode
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class ReturnStatement(ASTNode):
     """Return statement."""
     expression: Optional[ASTNode]
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class IfStatement(ASTNode):
@@ -206,12 +713,14 @@ class IfStatement(ASTNode):
     condition: ASTNode
     then_statement: ASTNode
     else_statement: Optional[ASTNode] = None
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class WhileStatement(ASTNode):
     """While loop statement."""
     condition: ASTNode
     body: ASTNode
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class ForStatement(ASTNode):
@@ -220,6 +729,7 @@ class ForStatement(ASTNode):
     condition: Optional[ASTNode] 
     update: Optional[ASTNode]
     body: ASTNode
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class BinaryExpression(ASTNode):
@@ -227,12 +737,14 @@ class BinaryExpression(ASTNode):
     left: ASTNode
     operator: str
     right: ASTNode
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class UnaryExpression(ASTNode):
     """Unary operation expression."""
     operator: str
     operand: ASTNode
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class AssignmentExpression(ASTNode):
@@ -240,37 +752,273 @@ class AssignmentExpression(ASTNode):
     left: ASTNode
     operator: str
     right: ASTNode
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class CallExpression(ASTNode):
     """Function call expression."""
     function: ASTNode
     arguments: List[ASTNode]
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class Identifier(ASTNode):
     """Identifier expression."""
     name: str
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class IntegerLiteral(ASTNode):
     """Integer literal expression."""
     value: int
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class FloatLiteral(ASTNode):
     """Float literal expression."""
     value: float
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class StringLiteral(ASTNode):
     """String literal expression."""
     value: str
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
 
 @dataclass
 class CharLiteral(ASTNode):
     """Character literal expression."""
     value: str
+    loc: Optional[Tuple[int, int, int, int]] = source_span()
+
+# ============================================================================
+# VISITOR DISPATCH
+# ============================================================================
+
+def handles(table: str, *node_classes: type):
+    """Register the decorated method as its visitor's table handler for node_classes."""
+    def register(method):
+        method.dispatch_entries = getattr(method, 'dispatch_entries', ()) + \
+            tuple((table, node_class) for node_class in node_classes)
+        return method
+    return register
+
+class NodeVisitor:
+    """
+    Base for AST walkers that dispatch on a node's class through tables
+    instead of isinstance ladders.
+    
+    Methods marked @handles('statement', IfStatement) are collected into the
+    class's 'statement' table when the class is created, so finding a handler
+    costs one dict lookup however many node kinds the walker knows.
+    Subclasses inherit the tables; overriding a handler by name replaces it.
+    Node classes are matched exactly (AST node classes are never subclassed).
+    """
+    
+    dispatch_tables: Dict[str, Dict[type, Any]] = {}
+    
+    def __init_subclass__(cls, **kwargs):
+        super().__init_subclass__(**kwargs)
+        tables = {}
+        for klass in reversed(cls.__mro__):
+            for name, member in vars(klass).items():
+                for table, node_class in getattr(member, 'dispatch_entries', ()):
+                    tables.setdefault(table, {})[node_class] = getattr(cls, name)
+        cls.dispatch_tables = tables
+    
+    def dispatch(self, table: str, node: ASTNode, *args, default=None):
+        """Call the table's handler for node, or return default if it has none."""
+        handler = self.dispatch_tables[table].get(node.__class__)
+        if handler is None:
+            return default
+        return handler(self, node, *args)
+
+_CHILD_FIELDS: Dict[type, Tuple[str, ...]] = {}
+
+def child_fields(node_class: type) -> Tuple[str, ...]:
+    """
+    Fields of node_class that can hold child nodes, in declaration order.
+    
+    Read once per class from the dataclass field metadata: scalar fields
+    (names, operators, literal values) and the source span are skipped.
+    """
+    names = _CHILD_FIELDS.get(node_class)
+    if names is None:
+        import dataclasses
+        names = _CHILD_FIELDS[node_class] = tuple(
+            f.name for f in dataclasses.fields(node_class)
+            if f.compare and f.type not in (str, int, float, bool))
+    return names
+
+_CLONERS: Dict[type, Any] = {}
+
+def node_cloner(node_class: type):
+    """
+    Copy function for one node class, generated from its dataclass fields.
+
+    The function rebuilds the node with one constructor call: child lists
+    and children are cloned, declared names go through rename, and scalar
+    fields and the source span are shared.
+    """
+    cloner = _CLONERS.get(node_class)
+    if cloner is None:
+        import dataclasses
+        import typing
+        children = child_fields(node_class)
+        arguments = []
+        for f in dataclasses.fields(node_class):
+            value = f"node.{f.name}"
+            if f.name in children:
+                if typing.get_origin(f.type) is list:
+                    value = f"[clone(item) for item in {value}]"
+                else:
+                    value = f"None if {value} is None else clone({value})"
+            elif f.name == 'name' and node_class in (VariableDeclaration, Parameter):
+                value = f"rename({value})"
+            arguments.append(value)
+        source = (f"def clone_{node_class.__name__}(node, clone, rename):\n"
+                  f"    return node_class({', '.join(arguments)})\n")
+        namespace = {'node_class': node_class}
+        exec(source, namespace)
+        cloner = _CLONERS[node_class] = namespace[f"clone_{node_class.__name__}"]
+    return cloner
+
+def clone_tree(node: Optional[ASTNode], substitutions: Optional[Dict[str, Any]] = None) -> Optional[ASTNode]:
+    """
+    Copy of the tree under node, substituting identifiers in the same pass.
+
+    substitutions maps a name to a replacement node (each use of the name
+    becomes a fresh copy of it, with the use's span) or to a new name
+    (uses and declarations of the name are renamed). Much cheaper than
+    copy.deepcopy, which memoizes every object it visits.
+    """
+    if not substitutions:
+        def clone(node):
+            return (_CLONERS.get(node.__class__) or node_cloner(node.__class__))(node, clone, _same_name)
+        return None if node is None else clone(node)
+
+    renames = {name: new for name, new in substitutions.items() if isinstance(new, str)}
+
+    def rename(name):
+        return renames.get(name, name)
+
+    def clone(node):
+        node_class = node.__class__
+        if node_class is Identifier and node.name in substitutions:
+            replacement = substitutions[node.name]
+            if isinstance(replacement, str):
+                return Identifier(replacement, node.loc)
+            return copy_location(clone_tree(replacement), node)
+        return (_CLONERS.get(node_class) or node_cloner(node_class))(node, clone, rename)
+
+    return None if node is None else clone(node)
+
+def _same_name(name: str) -> str:
+    return name
+
+# ============================================================================
+# HASH-CONSED EXPRESSIONS
+# ============================================================================
+
+# Span of shared expression nodes: they stand for every site they appear at,
+# so they have none, and copy_location (which only fills in None) skips them
+SHARED_SPAN = ()
+
+class ExpressionTable(NodeVisitor):
+    """
+    Hash-consing factory for side-effect-free expressions.
+
+    Identifiers, literals and pure unary and binary expressions built
+    through the table are unique per structure: building x + 1 twice
+    returns the same node, so two consed expressions are equal exactly when
+    they are the same object, and the copies of an expression that
+    unrolling leaves behind share one set of nodes.
+
+    Shared nodes are immutable by convention. Passes build replacements
+    instead of assigning into them (as the folders already do).
+    Assignments, calls, increments and string literals are never consed;
+    an expression containing one is built as a plain node.
+    """
+
+    PURE_UNARY_OPERATORS = frozenset({'-', '+', '!', '~'})
+
+    def __init__(self):
+        self.entries: Dict[tuple, ASTNode] = {}
+        self.members: Set[int] = set()  # ids of shared nodes (entries keep them alive)
+
+    def __len__(self) -> int:
+        return len(self.entries)
+
+    def is_shared(self, node: ASTNode) -> bool:
+        """Whether node is one of this table's shared nodes."""
+        return id(node) in self.members
+
+    def cons(self, key: tuple, build) -> ASTNode:
+        """The shared node for key, building it on first use."""
+        node = self.entries.get(key)
+        if node is None:
+            node = self.entries[key] = build()
+            node.loc = SHARED_SPAN
+            self.members.add(id(node))
+        return node
+
+    def identifier(self, name: str) -> Identifier:
+        return self.cons((Identifier, name), lambda: Identifier(name))
+
+    def literal(self, node_class: type, value: Any) -> ASTNode:
+        # Floats are keyed by their bits, so 0.0 and -0.0 stay distinct
+        key = value.hex() if isinstance(value, float) else value
+        return self.cons((node_class, key), lambda: node_class(value))
+
+    def integer(self, value: int) -> IntegerLiteral:
+        return self.literal(IntegerLiteral, value)
+
+    def binary(self, left: ASTNode, operator: str, right: ASTNode) -> BinaryExpression:
+        """left operator right, shared when both operands are."""
+        if id(left) in self.members and id(right) in self.members:
+            return self.cons((BinaryExpression, operator, id(left), id(right)),
+                             lambda: BinaryExpression(left, operator, right))
+        return BinaryExpression(left, operator, right)
+
+    def unary(self, operator: str, operand: ASTNode) -> UnaryExpression:
+        """operator operand, shared when the operator is pure and the operand shared."""
+        if operator in self.PURE_UNARY_OPERATORS and id(operand) in self.members:
+            return self.cons((UnaryExpression, operator, id(operand)),
+                             lambda: UnaryExpression(operator, operand))
+        return UnaryExpression(operator, operand)
+
+    def intern(self, node: ASTNode) -> Optional[ASTNode]:
+        """
+        The shared node structurally equal to node, or None if node has
+        side effects (or contains anything else the table does not cons).
+        Constant time for shared nodes, linear in the unshared part otherwise.
+        """
+        if id(node) in self.members:
+            return node
+        return self.dispatch('intern', node)
+
+    @handles('intern', Identifier)
+    def _intern_identifier(self, node: Identifier) -> ASTNode:
+        return self.identifier(node.name)
+
+    @handles('intern', IntegerLiteral, FloatLiteral, CharLiteral)
+    def _intern_literal(self, node: ASTNode) -> ASTNode:
+        return self.literal(node.__class__, node.value)
+
+    @handles('intern', BinaryExpression)
+    def _intern_binary(self, node: BinaryExpression) -> Optional[ASTNode]:
+        left = self.intern(node.left)
+        right = self.intern(node.right) if left is not None else None
+        if right is None:
+            return None
+        return self.binary(left, node.operator, right)
+
+    @handles('intern', UnaryExpression)
+    def _intern_unary(self, node: UnaryExpression) -> Optional[ASTNode]:
+        if node.operator not in self.PURE_UNARY_OPERATORS:
+            return None
+        operand = self.intern(node.operand)
+        return self.unary(node.operator, operand) if operand is not None else None
 
 # ============================================================================
 # PARSER EXCEPTIONS
@@ -335,6 +1083,7 @@ class Parser:
         self.tokens = tokens
         self.current = 0
         self.current_token = tokens[0] if tokens else Token(TokenType.EOF, "", 0, 0)
+        self.errors = []  # Errors recovered from by synchronize()
     
     def error(self, message: str) -> None:
         """Raise a parse error with current token location."""
@@ -369,6 +1118,12 @@ class Parser:
             error_message = f"Expected {token_type.name}, got {self.current_token.type.name}"
         self.error(error_message)
     
+    def located(self, node: ASTNode, start: Token) -> ASTNode:
+        """Set node's source span from start to the last consumed token."""
+        end = self.tokens[self.current - 1] if self.current > 0 else start
+        node.loc = (start.line, start.column, end.line, end.column)
+        return node
+    
     def synchronize(self) -> None:
         """Recover from parse error by finding next statement boundary."""
         self.advance()
@@ -391,6 +1146,7 @@ class Parser:
     def parse(self) -> Program:
         """Parse the entire program and return AST root."""
         declarations = []
+        start = self.current_token
         
         try:
             while not self.match(TokenType.EOF):
@@ -399,13 +1155,14 @@ class Parser:
                     if decl:
                         declarations.append(decl)
                 except ParseError as e:
-                    print(f"Parse Error: {e}")
+                    log.error("Parse Error: %s", e)
+                    self.errors.append(str(e))
                     self.synchronize()
             
-            return Program(declarations)
+            return self.located(Program(declarations), start)
         
         except Exception as e:
-            print(f"Fatal Parse Error: {e}")
+            log.error("Fatal Parse Error: %s", e)
             return Program([])
     
     def parse_declaration(self) -> Optional[ASTNode]:
@@ -419,6 +1176,7 @@ class Parser:
             self.error("Expected type declaration")
         
         # Parse type
+        start = self.current_token
         type_name = self.current_token.value
         self.advance()
         
@@ -432,10 +1190,10 @@ class Parser:
         # Determine if function or variable declaration
         if self.match(TokenType.LEFT_PAREN):
             # Function declaration
-            return self.parse_function_declaration(type_name, name)
+            return self.located(self.parse_function_declaration(type_name, name), start)
         else:
             # Variable declaration
-            return self.parse_variable_declaration(type_name, name)
+            return self.located(self.parse_variable_declaration(type_name, name), start)
     
     def parse_function_declaration(self, return_type: str, name: str) -> FunctionDeclaration:
         """Parse function declaration/definition."""
@@ -479,6 +1237,7 @@ class Parser:
                           TokenType.VOID, TokenType.DOUBLE):
             self.error("Expected parameter type")
         
+        start = self.current_token
         param_type = self.current_token.value
         self.advance()
         
@@ -488,7 +1247,7 @@ class Parser:
         param_name = self.current_token.value
         self.advance()
         
-        return Parameter(param_type, param_name)
+        return self.located(Parameter(param_type, param_name), start)
     
     def parse_variable_declaration(self, type_name: str, name: str) -> VariableDeclaration:
         """Parse variable declaration with optional initialization."""
@@ -507,7 +1266,7 @@ class Parser:
     
     def parse_compound_statement(self) -> CompoundStatement:
         """Parse compound statement (block)."""
-        self.consume(TokenType.LEFT_BRACE, "Expected '{'")
+        start = self.consume(TokenType.LEFT_BRACE, "Expected '{'")
         
         statements = []
         while not self.match(TokenType.RIGHT_BRACE) and not self.match(TokenType.EOF):
@@ -516,7 +1275,7 @@ class Parser:
                 statements.append(stmt)
         
         self.consume(TokenType.RIGHT_BRACE, "Expected '}'")
-        return CompoundStatement(statements)
+        return self.located(CompoundStatement(statements), start)
     
     def parse_statement(self) -> Optional[ASTNode]:
         """Parse any kind of statement."""
@@ -539,6 +1298,7 @@ class Parser:
             elif self.match(TokenType.INT, TokenType.FLOAT_KW, TokenType.CHAR_KW, 
                            TokenType.VOID, TokenType.DOUBLE):
                 # Variable declaration in statement context
+                start = self.current_token
                 type_name = self.current_token.value
                 self.advance()
                 
@@ -548,30 +1308,31 @@ class Parser:
                 name = self.current_token.value
                 self.advance()
                 
-                return self.parse_variable_declaration(type_name, name)
+                return self.located(self.parse_variable_declaration(type_name, name), start)
             
             else:
                 return self.parse_expression_statement()
         
         except ParseError as e:
-            print(f"Statement Parse Error: {e}")
+            log.error("Statement Parse Error: %s", e)
+            self.errors.append(str(e))
             self.synchronize()
             return None
     
     def parse_return_statement(self) -> ReturnStatement:
         """Parse return statement."""
-        self.consume(TokenType.RETURN, "Expected 'return'")
+        start = self.consume(TokenType.RETURN, "Expected 'return'")
         
         expression = None
         if not self.match(TokenType.SEMICOLON):
             expression = self.parse_expression()
         
         self.consume(TokenType.SEMICOLON, "Expected ';' after return statement")
-        return ReturnStatement(expression)
+        return self.located(ReturnStatement(expression), start)
     
     def parse_if_statement(self) -> IfStatement:
         """Parse if statement with optional else."""
-        self.consume(TokenType.IF, "Expected 'if'")
+        start = self.consume(TokenType.IF, "Expected 'if'")
         self.consume(TokenType.LEFT_PAREN, "Expected '(' after 'if'")
         
         condition = self.parse_expression()
@@ -585,11 +1346,11 @@ class Parser:
             self.advance()  # consume 'else'
             else_statement = self.parse_statement()
         
-        return IfStatement(condition, then_statement, else_statement)
+        return self.located(IfStatement(condition, then_statement, else_statement), start)
     
     def parse_while_statement(self) -> WhileStatement:
         """Parse while loop statement."""
-        self.consume(TokenType.WHILE, "Expected 'while'")
+        start = self.consume(TokenType.WHILE, "Expected 'while'")
         self.consume(TokenType.LEFT_PAREN, "Expected '(' after 'while'")
         
         condition = self.parse_expression()
@@ -598,11 +1359,11 @@ class Parser:
         
         body = self.parse_statement()
         
-        return WhileStatement(condition, body)
+        return self.located(WhileStatement(condition, body), start)
     
     def parse_for_statement(self) -> ForStatement:
         """Parse for loop statement."""
-        self.consume(TokenType.FOR, "Expected 'for'")
+        start = self.consume(TokenType.FOR, "Expected 'for'")
         self.consume(TokenType.LEFT_PAREN, "Expected '(' after 'for'")
         
         # Initialization (optional)
@@ -626,16 +1387,17 @@ class Parser:
         
         body = self.parse_statement()
         
-        return ForStatement(init, condition, update, body)
+        return self.located(ForStatement(init, condition, update, body), start)
     
     def parse_expression_statement(self) -> ExpressionStatement:
         """Parse expression statement."""
+        start = self.current_token
         expression = None
         if not self.match(TokenType.SEMICOLON):
             expression = self.parse_expression()
         
         self.consume(TokenType.SEMICOLON, "Expected ';' after expression")
-        return ExpressionStatement(expression)
+        return self.located(ExpressionStatement(expression), start)
     
     # ========================================================================
     # EXPRESSION PARSING (with operator precedence)
@@ -647,6 +1409,7 @@ class Parser:
     
     def parse_assignment(self) -> ASTNode:
         """Parse assignment expression (right associative)."""
+        start = self.current_token
         expr = self.parse_logical_or()
         
         if self.match(TokenType.ASSIGN, TokenType.PLUS_ASSIGN, TokenType.MINUS_ASSIGN,
@@ -654,48 +1417,52 @@ class Parser:
             operator = self.current_token.value
             self.advance()
             right = self.parse_assignment()  # Right associative
-            return AssignmentExpression(expr, operator, right)
+            return self.located(AssignmentExpression(expr, operator, right), start)
         
         return expr
     
     def parse_logical_or(self) -> ASTNode:
         """Parse logical OR expression."""
+        start = self.current_token
         expr = self.parse_logical_and()
         
         while self.match(TokenType.LOGICAL_OR):
             operator = self.current_token.value
             self.advance()
             right = self.parse_logical_and()
-            expr = BinaryExpression(expr, operator, right)
+            expr = self.located(BinaryExpression(expr, operator, right), start)
         
         return expr
     
     def parse_logical_and(self) -> ASTNode:
         """Parse logical AND expression."""
+        start = self.current_token
         expr = self.parse_equality()
         
         while self.match(TokenType.LOGICAL_AND):
             operator = self.current_token.value
             self.advance()
             right = self.parse_equality()
-            expr = BinaryExpression(expr, operator, right)
+            expr = self.located(BinaryExpression(expr, operator, right), start)
         
         return expr
     
     def parse_equality(self) -> ASTNode:
         """Parse equality expression."""
+        start = self.current_token
         expr = self.parse_relational()
         
         while self.match(TokenType.EQUAL, TokenType.NOT_EQUAL):
             operator = self.current_token.value
             self.advance()
             right = self.parse_relational()
-            expr = BinaryExpression(expr, operator, right)
+            expr = self.located(BinaryExpression(expr, operator, right), start)
         
         return expr
     
     def parse_relational(self) -> ASTNode:
         """Parse relational expression."""
+        start = self.current_token
         expr = self.parse_additive()
         
         while self.match(TokenType.LESS_THAN, TokenType.GREATER_THAN,
@@ -703,31 +1470,33 @@ class Parser:
             operator = self.current_token.value
             self.advance()
             right = self.parse_additive()
-            expr = BinaryExpression(expr, operator, right)
+            expr = self.located(BinaryExpression(expr, operator, right), start)
         
         return expr
     
     def parse_additive(self) -> ASTNode:
         """Parse additive expression."""
+        start = self.current_token
         expr = self.parse_multiplicative()
         
         while self.match(TokenType.PLUS, TokenType.MINUS):
             operator = self.current_token.value
             self.advance()
             right = self.parse_multiplicative()
-            expr = BinaryExpression(expr, operator, right)
+            expr = self.located(BinaryExpression(expr, operator, right), start)
         
         return expr
     
     def parse_multiplicative(self) -> ASTNode:
         """Parse multiplicative expression."""
+        start = self.current_token
         expr = self.parse_unary()
         
         while self.match(TokenType.MULTIPLY, TokenType.DIVIDE, TokenType.MODULO):
             operator = self.current_token.value
             self.advance()
             right = self.parse_unary()
-            expr = BinaryExpression(expr, operator, right)
+            expr = self.located(BinaryExpression(expr, operator, right), start)
         
         return expr
     
@@ -735,15 +1504,17 @@ class Parser:
         """Parse unary expression."""
         if self.match(TokenType.LOGICAL_NOT, TokenType.MINUS, 
                       TokenType.INCREMENT, TokenType.DECREMENT):
+            start = self.current_token
             operator = self.current_token.value
             self.advance()
             expr = self.parse_unary()
-            return UnaryExpression(operator, expr)
+            return self.located(UnaryExpression(operator, expr), start)
         
         return self.parse_postfix()
     
     def parse_postfix(self) -> ASTNode:
         """Parse postfix expression."""
+        start = self.current_token
         expr = self.parse_primary()
         
         while True:
@@ -756,13 +1527,13 @@ class Parser:
                     arguments = self.parse_argument_list()
                 
                 self.consume(TokenType.RIGHT_PAREN, "Expected ')' after arguments")
-                expr = CallExpression(expr, arguments)
+                expr = self.located(CallExpression(expr, arguments), start)
             
             elif self.match(TokenType.INCREMENT, TokenType.DECREMENT):
                 # Postfix increment/decrement
                 operator = self.current_token.value
                 self.advance()
-                expr = UnaryExpression(f"post{operator}", expr)
+                expr = self.located(UnaryExpression(f"post{operator}", expr), start)
             
             else:
                 break
@@ -785,30 +1556,31 @@ class Parser:
     
     def parse_primary(self) -> ASTNode:
         """Parse primary expression."""
+        start = self.current_token
         if self.match(TokenType.IDENTIFIER):
             name = self.current_token.value
             self.advance()
-            return Identifier(name)
+            return self.located(Identifier(name), start)
         
         elif self.match(TokenType.INTEGER):
             value = int(self.current_token.value)
             self.advance()
-            return IntegerLiteral(value)
+            return self.located(IntegerLiteral(value), start)
         
         elif self.match(TokenType.FLOAT):
             value = float(self.current_token.value)
             self.advance()
-            return FloatLiteral(value)
+            return self.located(FloatLiteral(value), start)
         
         elif self.match(TokenType.STRING):
             value = self.current_token.value
             self.advance()
-            return StringLiteral(value)
+            return self.located(StringLiteral(value), start)
         
         elif self.match(TokenType.CHAR):
             value = self.current_token.value
             self.advance()
-            return CharLiteral(value)
+            return self.located(CharLiteral(value), start)
         
         elif self.match(TokenType.LEFT_PAREN):
             self.advance()  # consume '('
@@ -879,10 +1651,12 @@ class FunctionSymbol(Symbol):
     """Represents a function symbol with parameters and return type."""
     
     def __init__(self, name: str, return_type: CType, parameters: List[CType], 
-                 scope_level: int, is_defined: bool = False, line: int = 0, column: int = 0):
+                 scope_level: int, is_defined: bool = False, line: int = 0, column: int = 0,
+                 is_variadic: bool = False):
         super().__init__(name, return_type, 'function', scope_level, is_defined, line, column)
         self.return_type = return_type
         self.parameters = parameters
+        self.is_variadic = is_variadic  # Accepts extra arguments after the fixed ones (printf)
 
 class SymbolTable:
     """Symbol table with scope management."""
@@ -938,7 +1712,7 @@ class SemanticError(Exception):
 # SEMANTIC ANALYZER
 # ============================================================================
 
-class SemanticAnalyzer:
+class SemanticAnalyzer(NodeVisitor):
     """
     Semantic Analyzer for C language.
     
@@ -966,7 +1740,8 @@ class SemanticAnalyzer:
             BUILTIN_TYPES['int'], 
             [BUILTIN_TYPES['char']],  # Format string (simplified)
             0, 
-            True
+            True,
+            is_variadic=True
         )
         self.symbol_table.declare_symbol(printf_symbol)
     
@@ -974,7 +1749,7 @@ class SemanticAnalyzer:
         """Record semantic error."""
         error = SemanticError(message, line, column)
         self.errors.append(error)
-        print(f"Semantic Error: {message} at line {line}, column {column}")
+        log.error("Semantic Error: %s at line %s, column %s", message, line, column)
     
     def analyze(self, ast: Program) -> bool:
         """Analyze the entire program. Returns True if no errors."""
@@ -987,7 +1762,7 @@ class SemanticAnalyzer:
     
     def visit_program(self, node: Program):
         """Visit program root node."""
-        print("🔍 Analyzing program structure...")
+        log.debug("🔍 Analyzing program structure...")
         
         # First pass: Declare all functions and global variables
         for declaration in node.declarations:
@@ -1001,8 +1776,8 @@ class SemanticAnalyzer:
             if isinstance(declaration, FunctionDeclaration) and declaration.body:
                 self.visit_function_declaration(declaration)
         
-        print(f"   Found {len([d for d in node.declarations if isinstance(d, FunctionDeclaration)])} functions")
-        print(f"   Found {len([d for d in node.declarations if isinstance(d, VariableDeclaration)])} global variables")
+        log.debug("   Found %s functions", len([d for d in node.declarations if isinstance(d, FunctionDeclaration)]))
+        log.debug("   Found %s global variables", len([d for d in node.declarations if isinstance(d, VariableDeclaration)]))
     
     def _declare_function(self, node: FunctionDeclaration):
         """Declare function in symbol table."""
@@ -1059,7 +1834,7 @@ class SemanticAnalyzer:
     
     def visit_function_declaration(self, node: FunctionDeclaration):
         """Visit function declaration with body."""
-        print(f"   Analyzing function: {node.name}")
+        log.debug("   Analyzing function: %s", node.name)
         
         # Set current function for return checking
         func_symbol = self.symbol_table.lookup_symbol(node.name)
@@ -1085,6 +1860,7 @@ class SemanticAnalyzer:
         self.symbol_table.exit_scope()
         self.current_function = None
     
+    @handles('statement', CompoundStatement)
     def visit_compound_statement(self, node: CompoundStatement):
         """Visit compound statement (block)."""
         self.symbol_table.enter_scope()
@@ -1096,22 +1872,17 @@ class SemanticAnalyzer:
     
     def visit_statement(self, node: ASTNode):
         """Visit any statement."""
-        if isinstance(node, VariableDeclaration):
-            self.visit_variable_declaration(node)
-        elif isinstance(node, ExpressionStatement):
-            if node.expression:
-                self.visit_expression(node.expression)
-        elif isinstance(node, ReturnStatement):
-            self.visit_return_statement(node)
-        elif isinstance(node, IfStatement):
-            self.visit_if_statement(node)
-        elif isinstance(node, WhileStatement):
-            self.visit_while_statement(node)
-        elif isinstance(node, ForStatement):
-            self.visit_for_statement(node)
-        elif isinstance(node, CompoundStatement):
-            self.visit_compound_statement(node)
+        handler = self.dispatch_tables['statement'].get(node.__class__)
+        if handler:
+            handler(self, node)
+    
+    @handles('statement', ExpressionStatement)
+    def visit_expression_statement(self, node: ExpressionStatement):
+        """Visit expression statement."""
+        if node.expression:
+            self.visit_expression(node.expression)
     
+    @handles('statement', VariableDeclaration)
     def visit_variable_declaration(self, node: VariableDeclaration):
         """Visit variable declaration."""
         var_type = BUILTIN_TYPES.get(node.type)
@@ -1136,6 +1907,7 @@ class SemanticAnalyzer:
             if init_type and not var_type.can_assign_from(init_type):
                 self.error(f"Cannot assign {init_type} to {var_type}")
     
+    @handles('statement', ReturnStatement)
     def visit_return_statement(self, node: ReturnStatement):
         """Visit return statement."""
         if not self.current_function:
@@ -1152,6 +1924,7 @@ class SemanticAnalyzer:
             if expected_type.name != 'void':
                 self.error(f"Function returning {expected_type} must return a value")
     
+    @handles('statement', IfStatement)
     def visit_if_statement(self, node: IfStatement):
         """Visit if statement."""
         # Check condition type
@@ -1165,6 +1938,7 @@ class SemanticAnalyzer:
         if node.else_statement:
             self.visit_statement(node.else_statement)
     
+    @handles('statement', WhileStatement)
     def visit_while_statement(self, node: WhileStatement):
         """Visit while statement."""
         # Check condition type
@@ -1173,6 +1947,7 @@ class SemanticAnalyzer:
         # Visit body
         self.visit_statement(node.body)
     
+    @handles('statement', ForStatement)
     def visit_for_statement(self, node: ForStatement):
         """Visit for statement."""
         # Visit initialization
@@ -1192,39 +1967,34 @@ class SemanticAnalyzer:
     
     def visit_expression(self, node: ASTNode) -> Optional[CType]:
         """Visit expression and return its type."""
-        if isinstance(node, IntegerLiteral):
-            return BUILTIN_TYPES['int']
-        
-        elif isinstance(node, FloatLiteral):
-            return BUILTIN_TYPES['float']
-        
-        elif isinstance(node, StringLiteral):
-            return BUILTIN_TYPES['char']  # char* in reality
-        
-        elif isinstance(node, CharLiteral):
-            return BUILTIN_TYPES['char']
-        
-        elif isinstance(node, Identifier):
-            symbol = self.symbol_table.lookup_symbol(node.name)
-            if not symbol:
-                self.error(f"Undefined variable: {node.name}")
-                return None
-            return symbol.symbol_type
-        
-        elif isinstance(node, BinaryExpression):
-            return self.visit_binary_expression(node)
-        
-        elif isinstance(node, UnaryExpression):
-            return self.visit_unary_expression(node)
-        
-        elif isinstance(node, AssignmentExpression):
-            return self.visit_assignment_expression(node)
-        
-        elif isinstance(node, CallExpression):
-            return self.visit_call_expression(node)
-        
-        return None
+        handler = self.dispatch_tables['expression'].get(node.__class__)
+        return handler(self, node) if handler else None
+    
+    @handles('expression', IntegerLiteral)
+    def visit_integer_literal(self, node: IntegerLiteral) -> CType:
+        """Integer literals are int."""
+        return BUILTIN_TYPES['int']
+    
+    @handles('expression', FloatLiteral)
+    def visit_float_literal(self, node: FloatLiteral) -> CType:
+        """Floating literals are float."""
+        return BUILTIN_TYPES['float']
+    
+    @handles('expression', StringLiteral, CharLiteral)
+    def visit_character_literal(self, node: ASTNode) -> CType:
+        """Character and string literals are char (char* in reality for strings)."""
+        return BUILTIN_TYPES['char']
+    
+    @handles('expression', Identifier)
+    def visit_identifier(self, node: Identifier) -> Optional[CType]:
+        """Visit variable reference and return its declared type."""
+        symbol = self.symbol_table.lookup_symbol(node.name)
+        if not symbol:
+            self.error(f"Undefined variable: {node.name}")
+            return None
+        return symbol.symbol_type
     
+    @handles('expression', BinaryExpression)
     def visit_binary_expression(self, node: BinaryExpression) -> Optional[CType]:
         """Visit binary expression and return result type."""
         left_type = self.visit_expression(node.left)
@@ -1258,6 +2028,7 @@ class SemanticAnalyzer:
         
         return None
     
+    @handles('expression', UnaryExpression)
     def visit_unary_expression(self, node: UnaryExpression) -> Optional[CType]:
         """Visit unary expression and return result type."""
         operand_type = self.visit_expression(node.operand)
@@ -1270,6 +2041,7 @@ class SemanticAnalyzer:
         
         return None
     
+    @handles('expression', AssignmentExpression)
     def visit_assignment_expression(self, node: AssignmentExpression) -> Optional[CType]:
         """Visit assignment expression and return result type."""
         left_type = self.visit_expression(node.left)
@@ -1291,6 +2063,7 @@ class SemanticAnalyzer:
         
         return left_type
     
+    @handles('expression', CallExpression)
     def visit_call_expression(self, node: CallExpression) -> Optional[CType]:
         """Visit function call expression and return result type."""
         # Get function name
@@ -1310,7 +2083,11 @@ class SemanticAnalyzer:
             return None
         
         # Check argument count
-        if len(node.arguments) != len(func_symbol.parameters):
+        if func_symbol.is_variadic:
+            if len(node.arguments) < len(func_symbol.parameters):
+                self.error(f"Function '{func_name}' expects at least {len(func_symbol.parameters)} arguments, got {len(node.arguments)}")
+                return None
+        elif len(node.arguments) != len(func_symbol.parameters):
             self.error(f"Function '{func_name}' expects {len(func_symbol.parameters)} arguments, got {len(node.arguments)}")
             return None
         
@@ -1320,6 +2097,10 @@ class SemanticAnalyzer:
             if actual_type and not expected_type.can_assign_from(actual_type):
                 self.error(f"Argument {i+1} to '{func_name}': cannot convert {actual_type} to {expected_type}")
         
+        # Variadic arguments are only checked for validity, not converted
+        for arg in node.arguments[len(func_symbol.parameters):]:
+            self.visit_expression(arg)
+        
         return func_symbol.return_type
 
 # ============================================================================
@@ -1399,6 +2180,11 @@ class RegisterAllocator:
         if name in self.registers:
             self.registers[name].is_used = False
     
+    def free_all(self):
+        """Free every register (temporaries never outlive their statement)."""
+        for reg in self.registers.values():
+            reg.is_used = False
+    
     def get_param_register(self, index: int) -> Optional[str]:
         """Get register for function parameter by index."""
         if 0 <= index < len(self.param_registers):
@@ -1411,7 +2197,7 @@ class RegisterAllocator:
         self.local_vars[var_name] = self.stack_offset
         return self.stack_offset
 
-class CodeGenerator:
+class CodeGenerator(NodeVisitor):
     """
     x86-64 Assembly Code Generator for C programs.
     
@@ -1431,14 +2217,27 @@ class CodeGenerator:
         self.label_counter = 0
         self.current_function = None
         self.use_advanced_allocation = True  # Enable advanced register allocation
+        self.emit_entry_stub = True  # Emit _start when the program has no main
+        self.jobs = 1  # Worker processes for per-function code generation
+        self.debug_file = None  # Source file named in line tables (-g), or None
     
     def set_advanced_allocation(self, enabled: bool):
         """Enable or disable advanced register allocation."""
         self.use_advanced_allocation = enabled
+    
+    def set_debug_info(self, source_file: Optional[str]):
+        """Emit DWARF line tables and a compile unit for source_file (None disables)."""
+        self.debug_file = source_file
+    
+    def set_jobs(self, jobs: int):
+        """Generate functions in up to jobs worker processes (1 = serial)."""
+        self.jobs = max(1, jobs)
         
     def generate_label(self, prefix: str = "L") -> str:
-        """Generate unique label for jumps and branches."""
+        """Generate unique label for jumps and branches (namespaced per function)."""
         self.label_counter += 1
+        if self.current_function:
+            return f"{self.current_function.name}_{prefix}{self.label_counter}"
         return f"{prefix}{self.label_counter}"
     
     def emit(self, instruction: str, comment: str = ""):
@@ -1458,27 +2257,85 @@ class CodeGenerator:
     
     def generate(self, ast: Program) -> str:
         """Generate complete assembly program from AST."""
-        print("⚙️ Generating x86-64 assembly code...")
+        log.debug("⚙️ Generating x86-64 assembly code...")
         
         # Emit program header
-        self.emit_directive(".section .text")
-        self.emit_directive(".global _start")
+        self.generate_program_header()
         
         # Generate code for all declarations
+        fragments = self.generate_functions_parallel(ast) if self.jobs > 1 else {}
         for declaration in ast.declarations:
-            self.generate_declaration(declaration)
+            if id(declaration) in fragments:
+                self.output.append(fragments[id(declaration)])
+            else:
+                self.generate_declaration(declaration)
         
         # Add program entry point if no main function
-        if not any(isinstance(d, FunctionDeclaration) and d.name == "main" 
-                  for d in ast.declarations):
+        self.generate_entry_stub(ast.declarations)
+        if self.debug_file:
+            self.generate_debug_info(ast)
+        
+        # Join all output lines
+        return "\n".join(self.output)
+    
+    def generate_program_header(self):
+        """Emit the directives that start every assembly file."""
+        self.emit_directive(".section .text")
+        self.emit_directive(".global _start")
+        if self.debug_file:
+            self.emit_directive(f'.file 1 "{self.debug_file}"')
+            self.emit_label(".Ldebug_text_begin")
+    
+    def generate_entry_stub(self, declarations: List[ASTNode]):
+        """Emit a _start that just exits when the program has no main."""
+        if self.emit_entry_stub and not any(isinstance(d, FunctionDeclaration) and d.name == "main" 
+                  for d in declarations):
             self.emit_directive("")
             self.emit_label("_start")
             self.emit("mov $60, %rax", "exit syscall")
             self.emit("mov $0, %rdi", "exit status")
             self.emit("syscall", "invoke system call")
+    
+    def generate_fragment(self, node: ASTNode) -> str:
+        """
+        Generate one top-level declaration in isolation.
         
-        # Join all output lines
-        return "\n".join(self.output)
+        Fragments only depend on their own declaration, so they can be
+        cached separately and spliced into a full assembly file.
+        """
+        saved_output = self.output
+        self.output = []
+        try:
+            self.generate_declaration(node)
+            return "\n".join(self.output)
+        finally:
+            self.output = saved_output
+    
+    def generate_functions_parallel(self, ast: Program) -> Dict[int, str]:
+        """
+        Generate every function body in a process pool.
+        
+        Labels are namespaced per function and each function gets fresh
+        allocators, so fragments do not depend on each other; they are
+        returned keyed by declaration and spliced back in source order.
+        """
+        functions = [d for d in ast.declarations
+                     if isinstance(d, FunctionDeclaration) and d.body]
+        if len(functions) < 2:
+            return {}
+        
+        from concurrent.futures import ProcessPoolExecutor
+        jobs = min(self.jobs, len(functions))
+        payloads = [serialize_ast(function) for function in functions]
+        with tracer.span("parallel codegen", "codegen", functions=len(functions), jobs=jobs):
+            with ProcessPoolExecutor(max_workers=jobs) as pool:
+                # Several functions per task keep the pickling overhead small
+                fragments = list(pool.map(generate_function_fragment, payloads,
+                                          [self.use_advanced_allocation] * len(payloads),
+                                          [self.debug_file] * len(payloads),
+                                          chunksize=max(1, len(payloads) // (jobs * 4))))
+        log.debug("   Generated %s functions in %s worker processes", len(functions), jobs)
+        return {id(function): fragment for function, fragment in zip(functions, fragments)}
     
     def generate_declaration(self, node: ASTNode):
         """Generate code for top-level declaration."""
@@ -1490,6 +2347,7 @@ class CodeGenerator:
     def generate_global_variable(self, node: VariableDeclaration):
         """Generate code for global variable declaration."""
         self.emit_directive(".section .data")
+        self.emit_directive(f".global {node.name}")  # Visible to other units and LTO partitions
         if node.initializer:
             if isinstance(node.initializer, IntegerLiteral):
                 self.emit_directive(f"{node.name}: .quad {node.initializer.value}")
@@ -1504,23 +2362,39 @@ class CodeGenerator:
         if not node.body:
             return  # Skip function declarations without bodies
         
-        print(f"   Generating function: {node.name}")
+        log.debug("   Generating function: %s", node.name)
+        with tracer.span("function codegen", "codegen", function=node.name) as span:
+            first_line = len(self.output)
+            self.generate_function_body(node)
+            span.set(instructions=len(self.output) - first_line)
+    
+    def generate_function_body(self, node: FunctionDeclaration):
+        """Allocate registers for a function and emit its code."""
         self.current_function = node
+        self.label_counter = 0
         
-        # Perform advanced register allocation if enabled
+        # Fresh allocator state per function, so code for one function never
+        # depends on which functions were generated before it
+        self.register_allocator = RegisterAllocator()
         if self.use_advanced_allocation:
-            self.allocation_map = self.advanced_allocator.allocate_registers(node)
+            self.advanced_allocator = AdvancedRegisterAllocator()
+            with tracer.span("register allocation", "codegen", function=node.name) as span:
+                self.allocation_map = self.advanced_allocator.allocate_registers(node)
+                span.set(variables=self.advanced_allocator.total_variables,
+                         spilled=self.advanced_allocator.variables_spilled)
         else:
-            # Reset simple register allocator for new function
-            self.register_allocator = RegisterAllocator()
             self.allocation_map = {}
         
-        # Function label
+        # Function label (exported so other object files can call it)
         self.emit_directive("")
         if node.name == "main":
             self.emit_label("_start")
         else:
+            self.emit_directive(f".global {node.name}")
             self.emit_label(node.name)
+        if self.debug_file:
+            self.emit_label(f".Ldebug_begin_{node.name}")
+            self.emit_location(node)
         
         # Function prologue
         self.emit("pushq %rbp", "save old base pointer")
@@ -1540,9 +2414,13 @@ class CodeGenerator:
         
         # Generate function body
         self.generate_statement(node.body)
+        if node.name == "main":
+            self.emit("movq $0, %rax", "main returns 0 when it falls off the end")
         
         # Function epilogue (in case no return statement)
         self.generate_function_epilogue(node.name)
+        if self.debug_file:
+            self.emit_label(f".Ldebug_end_{node.name}")
     
     def collect_local_vars(self, node: ASTNode) -> List[str]:
         """Collect all local variable names for stack allocation."""
@@ -1567,8 +2445,8 @@ class CodeGenerator:
         
         if func_name == "main":
             # Main function - exit program
+            self.emit("movq %rax, %rdi", "exit status is main's return value")
             self.emit("mov $60, %rax", "exit syscall")
-            self.emit("mov $0, %rdi", "exit status 0")
             self.emit("syscall", "invoke system call")
         else:
             # Regular function return
@@ -1576,30 +2454,94 @@ class CodeGenerator:
             self.emit("popq %rbp", "restore old base pointer")
             self.emit("ret", "return to caller")
     
+    def emit_location(self, node: ASTNode):
+        """Attribute the following instructions to node's source line (-g)."""
+        if node.loc:
+            self.emit(f".loc 1 {node.loc[0]} {node.loc[1]}")
+    
+    def generate_debug_info(self, ast: Program):
+        """
+        Emit a minimal DWARF 4 compile unit: one DIE for the unit and one per
+        function with its address range and line. The assembler builds
+        .debug_line from the .file/.loc directives; the unit points at it.
+        """
+        functions = [d for d in ast.declarations if isinstance(d, FunctionDeclaration) and d.body]
+        self.emit_directive("")
+        self.emit_directive(".section .text")
+        self.emit_label(".Ldebug_text_end")
+        
+        self.emit_directive('.section .debug_abbrev,"",@progbits')
+        self.emit_label(".Ldebug_abbrev")
+        abbreviations = [
+            # code, tag, has children, (attribute, form) pairs
+            (1, 0x11, 1, [(0x25, 0x08), (0x13, 0x05), (0x03, 0x08), (0x1b, 0x08),   # producer, language, name, comp_dir
+                          (0x11, 0x01), (0x12, 0x07), (0x10, 0x17)]),               # low_pc, high_pc, stmt_list
+            (2, 0x2e, 0, [(0x03, 0x08), (0x3a, 0x0b), (0x3b, 0x0f),                  # name, decl_file, decl_line
+                          (0x11, 0x01), (0x12, 0x07), (0x3f, 0x19)]),               # low_pc, high_pc, external
+        ]
+        for code, tag, children, attributes in abbreviations:
+            self.emit(f".uleb128 {code}")
+            self.emit(f".uleb128 {tag:#x}")
+            self.emit(f".byte {children}")
+            for attribute, form in attributes:
+                self.emit(f".uleb128 {attribute:#x}")
+                self.emit(f".uleb128 {form:#x}")
+            self.emit(".byte 0, 0")
+        self.emit(".byte 0")
+        
+        # .debug_line is produced by the assembler; this label marks its start
+        self.emit_directive('.section .debug_line,"",@progbits')
+        self.emit_label(".Ldebug_line")
+        
+        self.emit_directive('.section .debug_info,"",@progbits')
+        self.emit_label(".Ldebug_info")
+        self.emit(".long .Ldebug_info_end - .Ldebug_info - 4", "unit length")
+        self.emit(".value 4", "DWARF version")
+        self.emit(".long .Ldebug_abbrev", "abbreviation table")
+        self.emit(".byte 8", "address size")
+        self.emit(".uleb128 1", "compile unit")
+        self.emit(f'.string "vibe-cc {COMPILER_VERSION}"')
+        self.emit(".value 0xc", "DW_LANG_C99")
+        self.emit(f'.string "{self.debug_file}"')
+        self.emit(f'.string "{os.getcwd()}"')
+        self.emit(".quad .Ldebug_text_begin")
+        self.emit(".quad .Ldebug_text_end - .Ldebug_text_begin")
+        self.emit(".long .Ldebug_line")
+        for function in functions:
+            self.emit(".uleb128 2", f"subprogram {function.name}")
+            self.emit(f'.string "{function.name}"')
+            self.emit(".byte 1", "file 1")
+            self.emit(f".uleb128 {function.loc[0] if function.loc else 0}")
+            self.emit(f".quad .Ldebug_begin_{function.name}")
+            self.emit(f".quad .Ldebug_end_{function.name} - .Ldebug_begin_{function.name}")
+        self.emit(".byte 0", "end of compile unit children")
+        self.emit_label(".Ldebug_info_end")
+    
     def generate_statement(self, node: ASTNode):
         """Generate code for any statement."""
-        if isinstance(node, CompoundStatement):
-            for stmt in node.statements:
-                self.generate_statement(stmt)
-        
-        elif isinstance(node, VariableDeclaration):
-            self.generate_variable_declaration(node)
-        
-        elif isinstance(node, ExpressionStatement):
-            if node.expression:
-                self.generate_expression(node.expression)
-        
-        elif isinstance(node, ReturnStatement):
-            self.generate_return_statement(node)
-        
-        elif isinstance(node, IfStatement):
-            self.generate_if_statement(node)
-        
-        elif isinstance(node, WhileStatement):
-            self.generate_while_statement(node)
-        
-        # Add more statement types as needed
+        if node.__class__ is not CompoundStatement:
+            if self.debug_file:
+                self.emit_location(node)
+            # Drop temporaries a discarded or unsupported expression left marked
+            self.register_allocator.free_all()
+        # Statement kinds without a handler generate nothing yet
+        handler = self.dispatch_tables['statement'].get(node.__class__)
+        if handler:
+            handler(self, node)
+    
+    @handles('statement', CompoundStatement)
+    def generate_compound_statement(self, node: CompoundStatement):
+        """Generate code for each statement of a block."""
+        for stmt in node.statements:
+            self.generate_statement(stmt)
+    
+    @handles('statement', ExpressionStatement)
+    def generate_expression_statement(self, node: ExpressionStatement):
+        """Generate code for an expression evaluated for its side effects."""
+        if node.expression:
+            self.generate_expression(node.expression)
     
+    @handles('statement', VariableDeclaration)
     def generate_variable_declaration(self, node: VariableDeclaration):
         """Generate code for local variable declaration."""
         # Allocate stack space
@@ -1612,6 +2554,7 @@ class CodeGenerator:
                 self.emit(f"movq %{result_reg}, -{offset}(%rbp)", f"store {node.name}")
                 self.register_allocator.free_register(result_reg)
     
+    @handles('statement', ReturnStatement)
     def generate_return_statement(self, node: ReturnStatement):
         """Generate code for return statement."""
         if node.expression:
@@ -1625,6 +2568,7 @@ class CodeGenerator:
         if self.current_function:
             self.emit(f"jmp {self.current_function.name}_epilogue", "return from function")
     
+    @handles('statement', IfStatement)
     def generate_if_statement(self, node: IfStatement):
         """Generate code for if statement."""
         else_label = self.generate_label("else")
@@ -1648,6 +2592,7 @@ class CodeGenerator:
         
         self.emit_label(end_label)
     
+    @handles('statement', WhileStatement)
     def generate_while_statement(self, node: WhileStatement):
         """Generate code for while loop."""
         loop_start = self.generate_label("while_start")
@@ -1674,56 +2619,53 @@ class CodeGenerator:
     
     def generate_expression(self, node: ASTNode) -> Optional[str]:
         """Generate code for expression and return register containing result."""
-        if isinstance(node, IntegerLiteral):
-            reg = self.register_allocator.allocate_register()
-            if reg:
-                self.emit(f"movq ${node.value}, %{reg}", f"load integer {node.value}")
-            return reg
-        
-        elif isinstance(node, Identifier):
-            # Use advanced register allocation if available
-            if self.use_advanced_allocation and node.name in self.allocation_map:
-                allocated_location = self.allocation_map[node.name]
-                if allocated_location == 'spilled':
-                    # Variable is spilled to stack
-                    offset = self.advanced_allocator.spilled_variables[node.name]
-                    reg = self.register_allocator.allocate_register()
-                    if reg:
-                        self.emit(f"movq -{offset}(%rbp), %{reg}", f"load spilled {node.name}")
-                    return reg
-                else:
-                    # Variable is in register
-                    return allocated_location
-            
-            # Fallback to original method
-            elif node.name in self.register_allocator.local_vars:
-                offset = self.register_allocator.local_vars[node.name]
+        handler = self.dispatch_tables['expression'].get(node.__class__)
+        return handler(self, node) if handler else None
+    
+    @handles('expression', IntegerLiteral)
+    def generate_integer_literal(self, node: IntegerLiteral) -> Optional[str]:
+        """Load an integer constant into a fresh register."""
+        reg = self.register_allocator.allocate_register()
+        if reg:
+            self.emit(f"movq ${node.value}, %{reg}", f"load integer {node.value}")
+        return reg
+    
+    @handles('expression', Identifier)
+    def generate_identifier(self, node: Identifier) -> Optional[str]:
+        """Return the register holding a variable, loading it if needed."""
+        # Use advanced register allocation if available
+        if self.use_advanced_allocation and node.name in self.allocation_map:
+            allocated_location = self.allocation_map[node.name]
+            if allocated_location == 'spilled':
+                # Variable is spilled to stack
+                offset = self.advanced_allocator.spilled_variables[node.name]
                 reg = self.register_allocator.allocate_register()
                 if reg:
-                    self.emit(f"movq -{offset}(%rbp), %{reg}", f"load {node.name}")
+                    self.emit(f"movq -{offset}(%rbp), %{reg}", f"load spilled {node.name}")
                 return reg
             else:
-                # Global variable
-                reg = self.register_allocator.allocate_register()
-                if reg:
-                    self.emit(f"movq {node.name}(%rip), %{reg}", f"load global {node.name}")
-                return reg
-        
-        elif isinstance(node, BinaryExpression):
-            return self.generate_binary_expression(node)
-        
-        elif isinstance(node, AssignmentExpression):
-            return self.generate_assignment_expression(node)
+                # Variable is in register
+                return allocated_location
         
-        elif isinstance(node, CallExpression):
-            return self.generate_call_expression(node)
-        
-        return None
-    
-    def generate_binary_expression(self, node: BinaryExpression) -> Optional[str]:
-        """Generate code for binary expression."""
-        # Generate left operand
-        left_reg = self.generate_expression(node.left)
+        # Fallback to original method
+        elif node.name in self.register_allocator.local_vars:
+            offset = self.register_allocator.local_vars[node.name]
+            reg = self.register_allocator.allocate_register()
+            if reg:
+                self.emit(f"movq -{offset}(%rbp), %{reg}", f"load {node.name}")
+            return reg
+        else:
+            # Global variable
+            reg = self.register_allocator.allocate_register()
+            if reg:
+                self.emit(f"movq {node.name}(%rip), %{reg}", f"load global {node.name}")
+            return reg
+    
+    @handles('expression', BinaryExpression)
+    def generate_binary_expression(self, node: BinaryExpression) -> Optional[str]:
+        """Generate code for binary expression."""
+        # Generate left operand
+        left_reg = self.generate_expression(node.left)
         
         # Generate right operand
         right_reg = self.generate_expression(node.right)
@@ -1752,6 +2694,7 @@ class CodeGenerator:
         self.register_allocator.free_register(right_reg)
         return left_reg
     
+    @handles('expression', AssignmentExpression)
     def generate_assignment_expression(self, node: AssignmentExpression) -> Optional[str]:
         """Generate code for assignment expression."""
         if not isinstance(node.left, Identifier):
@@ -1784,6 +2727,7 @@ class CodeGenerator:
         
         return rhs_reg
     
+    @handles('expression', CallExpression)
     def generate_call_expression(self, node: CallExpression) -> Optional[str]:
         """Generate code for function call."""
         if not isinstance(node.function, Identifier):
@@ -1791,6 +2735,12 @@ class CodeGenerator:
         
         func_name = node.function.name
         
+        # Temporaries still held in registers (such as an earlier call's
+        # result in %rax) do not survive the call; keep them on the stack
+        saved = [name for name, reg in self.register_allocator.registers.items() if reg.is_used]
+        for name in saved:
+            self.emit(f"pushq %{name}", "save live temporary across call")
+        
         # Generate arguments and place in parameter registers
         for i, arg in enumerate(node.arguments):
             arg_reg = self.generate_expression(arg)
@@ -1803,15 +2753,41 @@ class CodeGenerator:
         # Call function
         self.emit(f"call {func_name}", f"call function {func_name}")
         
-        # Return value is in rax
-        return 'rax'
+        # Return value is in rax; keep the next operand from being loaded over it
+        result = 'rax'
+        if 'rax' in saved:
+            result = self.register_allocator.allocate_register()
+            self.emit(f"movq %rax, %{result}", "move call result out of rax")
+        for name in reversed(saved):
+            self.emit(f"popq %{name}", "restore live temporary")
+        self.register_allocator.registers[result].is_used = True
+        return result
+
+def generate_function_fragment(data: bytes, advanced_registers: bool,
+                               debug_file: Optional[str] = None) -> str:
+    """Pool worker for CodeGenerator.generate_functions_parallel: one function's assembly."""
+    generator = CodeGenerator()
+    generator.set_advanced_allocation(advanced_registers)
+    generator.set_debug_info(debug_file)
+    return generator.generate_fragment(deserialize_ast(data))
 
 # ============================================================================
 # OPTIMIZATION PASSES
 # ============================================================================
 
-class OptimizationPass:
-    """Base class for optimization passes."""
+class OptimizationPass(NodeVisitor):
+    """
+    Base class for optimization passes.
+    
+    scope is 'function' for passes the PassManager runs one function at a
+    time, 'module' for passes that need the whole program and 'assembly'
+    for passes over the generated code. requires lists the analyses the
+    pass reads through the AnalysisManager; preserves lists the ones its
+    changes leave valid.
+    """
+    scope = 'module'
+    requires = ()
+    preserves = ()
     
     def __init__(self, name: str):
         self.name = name
@@ -1821,9 +2797,17 @@ class OptimizationPass:
         """Apply optimization to AST node. Override in subclasses."""
         return node
     
+    def run_on_module(self, program: Program, analyses: 'AnalysisManager') -> Program:
+        """Optimize the whole program (module passes)."""
+        return self.optimize(program)
+    
+    def run_on_function(self, func: FunctionDeclaration, analyses: 'AnalysisManager'):
+        """Optimize one function in place (function passes)."""
+        self.optimize(func)
+    
     def report(self):
         """Report optimization statistics."""
-        print(f"   {self.name}: {self.optimizations_applied} optimizations applied")
+        log.info("   %s: %s optimizations applied", self.name, self.optimizations_applied)
 
 class EnhancedConstantPropagationPass(OptimizationPass):
     """
@@ -1838,17 +2822,22 @@ class EnhancedConstantPropagationPass(OptimizationPass):
     6. Algebraic identity simplifications
     """
     
+    scope = 'function'
+    requires = ('calls', 'returns')
+    
     def __init__(self):
         super().__init__("Enhanced Constant Propagation")
         self.constant_values = {}      # Track constant variable values
         self.function_constants = {}   # Track constants across function calls
         self.folded_expressions = []   # Track what was folded
         self.simplified_operations = []  # Track algebraic simplifications
+        self.assigned_names = {}       # Names written under each loop and if
+        self.expressions = ExpressionTable()  # Folded expressions, shared
     
     def optimize(self, node: ASTNode) -> ASTNode:
         """Apply advanced constant propagation to AST."""
         if isinstance(node, Program):
-            print("🔢 Applying enhanced constant propagation...")
+            log.debug("🔢 Applying enhanced constant propagation...")
             
             # Multi-pass optimization for maximum effectiveness
             for pass_num in range(3):  # Up to 3 passes to reach fixed point
@@ -1868,7 +2857,7 @@ class EnhancedConstantPropagationPass(OptimizationPass):
                 if self.optimizations_applied == initial_optimizations:
                     break  # Reached fixed point
                 
-                print(f"    Pass {pass_num + 1}: {self.optimizations_applied - initial_optimizations} optimizations")
+                log.debug("    Pass %s: %s optimizations", pass_num + 1, self.optimizations_applied - initial_optimizations)
             
             return node
         else:
@@ -1885,12 +2874,15 @@ class EnhancedConstantPropagationPass(OptimizationPass):
                     const_val = self.get_constant_return_value(decl)
                     if const_val is not None:
                         self.function_constants[decl.name] = const_val
-                        print(f"    📊 Function {decl.name} returns constant: {const_val}")
+                        log.debug("    📊 Function %s returns constant: %s", decl.name, const_val)
     
     def returns_constant(self, func: FunctionDeclaration):
-        """Check if function always returns the same constant."""
+        """Check if function always returns the same constant and does nothing else."""
         if not func.body or not isinstance(func.body, CompoundStatement):
             return False
+        # A call to a function with side effects cannot become its value
+        if not is_side_effect_free(func.body):
+            return False
         
         # Simple analysis: check if there's only one return with a constant
         return_statements = self.find_return_statements(func.body)
@@ -1922,88 +2914,170 @@ class EnhancedConstantPropagationPass(OptimizationPass):
             returns.extend(self.find_return_statements(node.then_statement))
             if node.else_statement:
                 returns.extend(self.find_return_statements(node.else_statement))
-        elif isinstance(node, WhileStatement):
+        elif isinstance(node, (WhileStatement, ForStatement)):
             returns.extend(self.find_return_statements(node.body))
         
         return returns
     
+    def run_on_function(self, func: FunctionDeclaration, analyses: 'AnalysisManager'):
+        """Fold constants in one function, using its callees' constant returns."""
+        self.function_constants = {}
+        for callee in analyses.get('calls', func):
+            if callee in analyses.functions:
+                value = analyses.get('returns', analyses.functions[callee])
+                if value is not None:
+                    self.function_constants[callee] = value
+        self.propagate_constants(func)
+    
     def propagate_constants(self, node: ASTNode) -> ASTNode:
         """Recursively propagate and fold constants."""
-        if isinstance(node, BinaryExpression):
-            return self.fold_binary_expression(node)
-        elif isinstance(node, UnaryExpression):
-            return self.fold_unary_expression(node)
-        elif isinstance(node, CallExpression):
-            return self.fold_function_call(node)
-        elif isinstance(node, FunctionDeclaration):
-            if node.body:
-                # Reset per-function constant tracking
-                old_constants = self.constant_values.copy()
-                node.body = self.propagate_constants(node.body)
-                self.constant_values = old_constants  # Restore scope
-        elif isinstance(node, CompoundStatement):
-            node.statements = [self.propagate_constants(stmt) for stmt in node.statements]
-        elif isinstance(node, IfStatement):
-            node.condition = self.propagate_constants(node.condition)
-            
-            # Conditional constant propagation
-            if isinstance(node.condition, IntegerLiteral):
-                self.optimizations_applied += 1
-                if node.condition.value != 0:
-                    print(f"    🔧 Eliminating always-true if condition")
-                    return self.propagate_constants(node.then_statement)
+        handler = self.dispatch_tables['constants'].get(node.__class__)
+        return handler(self, node) if handler else node
+    
+    # Folded results keep the span of the expression they replace
+    
+    @handles('constants', BinaryExpression)
+    def _propagate_binary(self, node: BinaryExpression) -> ASTNode:
+        return copy_location(self.fold_binary_expression(node), node)
+    
+    @handles('constants', UnaryExpression)
+    def _propagate_unary(self, node: UnaryExpression) -> ASTNode:
+        return copy_location(self.fold_unary_expression(node), node)
+    
+    @handles('constants', CallExpression)
+    def _propagate_call(self, node: CallExpression) -> ASTNode:
+        return copy_location(self.fold_function_call(node), node)
+    
+    @handles('constants', FunctionDeclaration)
+    def _propagate_function(self, node: FunctionDeclaration) -> ASTNode:
+        if node.body:
+            # Track locals only: globals may change in any call
+            old_constants = self.constant_values
+            self.constant_values = {}
+            self.assigned_names = {}
+            node.body = self.propagate_constants(node.body)
+            self.constant_values = old_constants  # Restore scope
+        return node
+    
+    @handles('constants', CompoundStatement)
+    def _propagate_block(self, node: CompoundStatement) -> ASTNode:
+        node.statements = [self.propagate_constants(stmt) for stmt in node.statements]
+        return node
+    
+    @handles('constants', IfStatement)
+    def _propagate_if(self, node: IfStatement) -> ASTNode:
+        node.condition = self.propagate_constants(node.condition)
+        
+        # Conditional constant propagation
+        if isinstance(node.condition, IntegerLiteral):
+            self.optimizations_applied += 1
+            remarks.emit(self, 'applied', 'BranchFolded', 'constant_condition', node=node,
+                         condition=node.condition.value)
+            if node.condition.value != 0:
+                log.trace("    🔧 Eliminating always-true if condition")
+                return self.propagate_constants(node.then_statement)
+            else:
+                log.trace("    🔧 Eliminating always-false if condition")
+                if node.else_statement:
+                    return self.propagate_constants(node.else_statement)
                 else:
-                    print(f"    🔧 Eliminating always-false if condition")
-                    if node.else_statement:
-                        return self.propagate_constants(node.else_statement)
-                    else:
-                        return CompoundStatement([])
-            
-            node.then_statement = self.propagate_constants(node.then_statement)
-            if node.else_statement:
-                node.else_statement = self.propagate_constants(node.else_statement)
-        elif isinstance(node, WhileStatement):
-            node.condition = self.propagate_constants(node.condition)
-            
-            # Check for infinite/never loops
-            if isinstance(node.condition, IntegerLiteral):
-                if node.condition.value == 0:
-                    self.optimizations_applied += 1
-                    print(f"    🔧 Eliminating never-executing while loop")
                     return CompoundStatement([])
-            
-            node.body = self.propagate_constants(node.body)
-        elif isinstance(node, ReturnStatement):
-            if node.expression:
-                node.expression = self.propagate_constants(node.expression)
-        elif isinstance(node, VariableDeclaration):
-            if node.initializer:
-                node.initializer = self.propagate_constants(node.initializer)
-                
-                # Track constant variables
-                if isinstance(node.initializer, IntegerLiteral):
-                    self.constant_values[node.name] = node.initializer.value
-                    print(f"    📊 Tracking constant variable: {node.name} = {node.initializer.value}")
-        elif isinstance(node, ExpressionStatement):
-            if node.expression:
-                node.expression = self.propagate_constants(node.expression)
-        elif isinstance(node, AssignmentExpression):
-            node.right = self.propagate_constants(node.right)
-            
-            # Update constant tracking
-            if hasattr(node.left, 'name') and isinstance(node.right, IntegerLiteral):
-                self.constant_values[node.left.name] = node.right.value
-                print(f"    📊 Updating constant variable: {node.left.name} = {node.right.value}")
-        elif isinstance(node, Identifier):
-            # Replace identifiers with their constant values
-            if node.name in self.constant_values:
+        
+        # Each branch starts from the state before the if; afterwards only
+        # variables neither branch assigns are still known
+        before = self.constant_values.copy()
+        node.then_statement = self.propagate_constants(node.then_statement)
+        self.constant_values = before.copy()
+        if node.else_statement:
+            node.else_statement = self.propagate_constants(node.else_statement)
+        self.constant_values = before
+        self.forget_assigned(node)
+        return node
+    
+    @handles('constants', WhileStatement)
+    def _propagate_while(self, node: WhileStatement) -> ASTNode:
+        # The condition and body also run after the body's assignments
+        self.forget_assigned(node)
+        node.condition = self.propagate_constants(node.condition)
+        
+        # Check for infinite/never loops
+        if isinstance(node.condition, IntegerLiteral):
+            if node.condition.value == 0:
                 self.optimizations_applied += 1
-                const_val = self.constant_values[node.name]
-                print(f"    🔄 Replacing variable {node.name} with constant {const_val}")
-                return IntegerLiteral(const_val)
+                log.trace("    🔧 Eliminating never-executing while loop")
+                remarks.emit(self, 'applied', 'LoopDeleted', 'condition_always_false', node=node)
+                return CompoundStatement([])
+        
+        node.body = self.propagate_constants(node.body)
+        self.forget_assigned(node)
+        return node
+    
+    @handles('constants', ForStatement)
+    def _propagate_for(self, node: ForStatement) -> ASTNode:
+        if node.init:
+            node.init = self.propagate_constants(node.init)
+        self.forget_assigned(node)
+        if node.condition:
+            node.condition = self.propagate_constants(node.condition)
+        node.body = self.propagate_constants(node.body)
+        self.forget_assigned(node)
+        if node.update:
+            node.update = self.propagate_constants(node.update)
+        self.forget_assigned(node)
+        return node
+    
+    @handles('constants', ReturnStatement)
+    def _propagate_return(self, node: ReturnStatement) -> ASTNode:
+        if node.expression:
+            node.expression = self.propagate_constants(node.expression)
+        return node
+    
+    @handles('constants', VariableDeclaration)
+    def _propagate_declaration(self, node: VariableDeclaration) -> ASTNode:
+        if node.initializer:
+            node.initializer = self.propagate_constants(node.initializer)
+            
+            # Track constant variables
+            if isinstance(node.initializer, IntegerLiteral):
+                self.constant_values[node.name] = node.initializer.value
+                log.trace("    📊 Tracking constant variable: %s = %s", node.name, node.initializer.value)
+                return node
+        self.constant_values.pop(node.name, None)  # Shadows or redeclares the name
+        return node
+    
+    @handles('constants', ExpressionStatement)
+    def _propagate_expression_statement(self, node: ExpressionStatement) -> ASTNode:
+        if node.expression:
+            node.expression = self.propagate_constants(node.expression)
+        return node
+    
+    @handles('constants', AssignmentExpression)
+    def _propagate_assignment(self, node: AssignmentExpression) -> ASTNode:
+        node.right = self.propagate_constants(node.right)
         
+        # Update constant tracking
+        if hasattr(node.left, 'name'):
+            if node.operator == '=' and isinstance(node.right, IntegerLiteral):
+                self.constant_values[node.left.name] = node.right.value
+                log.trace("    📊 Updating constant variable: %s = %s", node.left.name, node.right.value)
+            else:
+                self.constant_values.pop(node.left.name, None)
         return node
     
+    @handles('constants', Identifier)
+    def _propagate_identifier(self, node: Identifier) -> ASTNode:
+        # Replace identifiers with their constant values
+        if node.name in self.constant_values:
+            self.optimizations_applied += 1
+            const_val = self.constant_values[node.name]
+            log.trace("    🔄 Replacing variable %s with constant %s", node.name, const_val)
+            return self.expressions.integer(const_val)
+        return self.expressions.identifier(node.name)
+    
+    @handles('constants', IntegerLiteral, FloatLiteral, CharLiteral)
+    def _propagate_literal(self, node: ASTNode) -> ASTNode:
+        return self.expressions.literal(node.__class__, node.value)
+    
     def fold_binary_expression(self, node: BinaryExpression) -> ASTNode:
         """Advanced binary expression folding with algebraic simplifications."""
         # Recursively fold operands first
@@ -2016,15 +3090,15 @@ class EnhancedConstantPropagationPass(OptimizationPass):
             if result is not None:
                 self.optimizations_applied += 1
                 self.folded_expressions.append(f"{left.value} {node.operator} {right.value} → {result}")
-                print(f"    🔢 Folding: {left.value} {node.operator} {right.value} → {result}")
-                return IntegerLiteral(result)
+                log.trace("    🔢 Folding: %s %s %s → %s", left.value, node.operator, right.value, result)
+                return self.expressions.integer(result)
         
         # Advanced algebraic simplifications
         simplified = self.apply_advanced_simplifications(left, node.operator, right)
         if simplified:
             return simplified
         
-        return BinaryExpression(left, node.operator, right)
+        return self.expressions.binary(left, node.operator, right)
     
     def apply_advanced_simplifications(self, left: ASTNode, operator: str, right: ASTNode) -> Optional[ASTNode]:
         """Apply advanced algebraic and arithmetic simplifications."""
@@ -2035,12 +3109,12 @@ class EnhancedConstantPropagationPass(OptimizationPass):
             if isinstance(right, IntegerLiteral) and right.value == 0:
                 self.optimizations_applied += 1
                 self.simplified_operations.append("x + 0 → x")
-                print(f"    🧮 Simplifying: expression + 0 → expression")
+                log.trace("    🧮 Simplifying: expression + 0 → expression")
                 return left
             if isinstance(left, IntegerLiteral) and left.value == 0:
                 self.optimizations_applied += 1
                 self.simplified_operations.append("0 + x → x")
-                print(f"    🧮 Simplifying: 0 + expression → expression")
+                log.trace("    🧮 Simplifying: 0 + expression → expression")
                 return right
         
         # Subtraction optimizations
@@ -2049,14 +3123,14 @@ class EnhancedConstantPropagationPass(OptimizationPass):
             if isinstance(right, IntegerLiteral) and right.value == 0:
                 self.optimizations_applied += 1
                 self.simplified_operations.append("x - 0 → x")
-                print(f"    🧮 Simplifying: expression - 0 → expression")
+                log.trace("    🧮 Simplifying: expression - 0 → expression")
                 return left
             # x - x → 0 (if same variable)
             if self.are_same_expression(left, right):
                 self.optimizations_applied += 1
                 self.simplified_operations.append("x - x → 0")
-                print(f"    🧮 Simplifying: expression - expression → 0")
-                return IntegerLiteral(0)
+                log.trace("    🧮 Simplifying: expression - expression → 0")
+                return self.expressions.integer(0)
         
         # Multiplication optimizations
         elif operator == '*':
@@ -2064,24 +3138,24 @@ class EnhancedConstantPropagationPass(OptimizationPass):
             if isinstance(right, IntegerLiteral) and right.value == 0:
                 self.optimizations_applied += 1
                 self.simplified_operations.append("x * 0 → 0")
-                print(f"    🧮 Simplifying: expression * 0 → 0")
-                return IntegerLiteral(0)
+                log.trace("    🧮 Simplifying: expression * 0 → 0")
+                return self.expressions.integer(0)
             if isinstance(left, IntegerLiteral) and left.value == 0:
                 self.optimizations_applied += 1
                 self.simplified_operations.append("0 * x → 0")
-                print(f"    🧮 Simplifying: 0 * expression → 0")
-                return IntegerLiteral(0)
+                log.trace("    🧮 Simplifying: 0 * expression → 0")
+                return self.expressions.integer(0)
             
             # x * 1 → x, 1 * x → x
             if isinstance(right, IntegerLiteral) and right.value == 1:
                 self.optimizations_applied += 1
                 self.simplified_operations.append("x * 1 → x")
-                print(f"    🧮 Simplifying: expression * 1 → expression")
+                log.trace("    🧮 Simplifying: expression * 1 → expression")
                 return left
             if isinstance(left, IntegerLiteral) and left.value == 1:
                 self.optimizations_applied += 1
                 self.simplified_operations.append("1 * x → x")
-                print(f"    🧮 Simplifying: 1 * expression → expression")
+                log.trace("    🧮 Simplifying: 1 * expression → expression")
                 return right
             
             # Power of 2 optimizations: x * 2^n → x << n
@@ -2090,7 +3164,7 @@ class EnhancedConstantPropagationPass(OptimizationPass):
                     shift_amount = self.log2(right.value)
                     self.optimizations_applied += 1
                     self.simplified_operations.append(f"x * {right.value} → x << {shift_amount}")
-                    print(f"    ⚡ Power-of-2 optimization: expression * {right.value} → expression << {shift_amount}")
+                    log.trace("    ⚡ Power-of-2 optimization: expression * %s → expression << %s", right.value, shift_amount)
                     # For now, return the original since we don't have shift operators in AST
                     # In a real compiler, we'd create a shift expression
         
@@ -2100,21 +3174,21 @@ class EnhancedConstantPropagationPass(OptimizationPass):
             if isinstance(right, IntegerLiteral) and right.value == 1:
                 self.optimizations_applied += 1
                 self.simplified_operations.append("x / 1 → x")
-                print(f"    🧮 Simplifying: expression / 1 → expression")
+                log.trace("    🧮 Simplifying: expression / 1 → expression")
                 return left
             # 0 / x → 0 (if x != 0)
             if isinstance(left, IntegerLiteral) and left.value == 0:
                 if isinstance(right, IntegerLiteral) and right.value != 0:
                     self.optimizations_applied += 1
                     self.simplified_operations.append("0 / x → 0")
-                    print(f"    🧮 Simplifying: 0 / expression → 0")
-                    return IntegerLiteral(0)
+                    log.trace("    🧮 Simplifying: 0 / expression → 0")
+                    return self.expressions.integer(0)
             # x / x → 1 (if same variable)
             if self.are_same_expression(left, right):
                 self.optimizations_applied += 1
                 self.simplified_operations.append("x / x → 1")
-                print(f"    🧮 Simplifying: expression / expression → 1")
-                return IntegerLiteral(1)
+                log.trace("    🧮 Simplifying: expression / expression → 1")
+                return self.expressions.integer(1)
         
         # Comparison optimizations
         elif operator in ['==', '!=', '<', '>', '<=', '>=']:
@@ -2126,23 +3200,16 @@ class EnhancedConstantPropagationPass(OptimizationPass):
                     result = 0
                 self.optimizations_applied += 1
                 self.simplified_operations.append(f"x {operator} x → {result}")
-                print(f"    🧮 Simplifying: expression {operator} expression → {result}")
-                return IntegerLiteral(result)
+                log.trace("    🧮 Simplifying: expression %s expression → %s", operator, result)
+                return self.expressions.integer(result)
         
         return None
     
     def are_same_expression(self, expr1: ASTNode, expr2: ASTNode) -> bool:
-        """Check if two expressions represent the same value."""
-        # Simple case: both are identifiers with same name
-        if isinstance(expr1, Identifier) and isinstance(expr2, Identifier):
-            return expr1.name == expr2.name
-        
-        # Both are integer literals with same value
-        if isinstance(expr1, IntegerLiteral) and isinstance(expr2, IntegerLiteral):
-            return expr1.value == expr2.value
-        
-        # Could extend this for more complex expression equivalence
-        return False
+        """Check if two side-effect-free expressions represent the same value."""
+        # Structurally equal pure expressions intern to the same shared node
+        shared = self.expressions.intern(expr1)
+        return shared is not None and shared is self.expressions.intern(expr2)
     
     def is_power_of_2(self, n: int) -> bool:
         """Check if n is a power of 2."""
@@ -2161,30 +3228,51 @@ class EnhancedConstantPropagationPass(OptimizationPass):
         # First fold arguments
         node.arguments = [self.propagate_constants(arg) for arg in node.arguments]
         
-        # Check if this function returns a constant
-        if hasattr(node.function, 'name') and node.function.name in self.function_constants:
+        # Check if this function returns a constant; the arguments must not be needed either
+        if (hasattr(node.function, 'name') and node.function.name in self.function_constants
+                and all(is_side_effect_free(arg) for arg in node.arguments)):
             const_val = self.function_constants[node.function.name]
             self.optimizations_applied += 1
-            print(f"    🔄 Replacing call to {node.function.name}() with constant {const_val}")
-            return IntegerLiteral(const_val)
+            log.trace("    🔄 Replacing call to %s() with constant %s", node.function.name, const_val)
+            remarks.emit(self, 'applied', 'CallFolded', 'callee_returns_constant', node=node,
+                         callee=node.function.name, value=const_val)
+            return self.expressions.integer(const_val)
         
         return node
     
+    def forget_assigned(self, node: ASTNode):
+        """Stop tracking every variable assigned, incremented or decremented under node."""
+        if not self.constant_values:
+            return
+        # Loops and ifs forget their subtree at every nesting level, so the
+        # names are computed once per node (holding the node keeps its id unique)
+        entry = self.assigned_names.get(id(node))
+        if entry is None:
+            names = variables_written(node)
+            names.update(declared_variables(node))
+            entry = self.assigned_names[id(node)] = (node, names)
+        for name in entry[1]:
+            self.constant_values.pop(name, None)
+    
     def fold_unary_expression(self, node: UnaryExpression) -> ASTNode:
         """Advanced unary expression folding."""
+        if node.operator in ('++', '--', 'post++', 'post--'):
+            # The operand is written, never replaced by a constant
+            self.forget_assigned(node)
+            return node
         operand = self.propagate_constants(node.operand)
         
         if isinstance(operand, IntegerLiteral):
             if node.operator == '-':
                 self.optimizations_applied += 1
                 result = -operand.value
-                print(f"    🔢 Folding unary: -{operand.value} → {result}")
-                return IntegerLiteral(result)
+                log.trace("    🔢 Folding unary: -%s → %s", operand.value, result)
+                return self.expressions.integer(result)
             elif node.operator == '!':
                 self.optimizations_applied += 1
                 result = 1 if operand.value == 0 else 0
-                print(f"    🔢 Folding unary: !{operand.value} → {result}")
-                return IntegerLiteral(result)
+                log.trace("    🔢 Folding unary: !%s → %s", operand.value, result)
+                return self.expressions.integer(result)
         
         # Advanced unary simplifications
         if node.operator == '-':
@@ -2192,10 +3280,10 @@ class EnhancedConstantPropagationPass(OptimizationPass):
             if isinstance(operand, UnaryExpression) and operand.operator == '-':
                 self.optimizations_applied += 1
                 self.simplified_operations.append("-(-x) → x")
-                print(f"    🧮 Simplifying: -(-expression) → expression")
+                log.trace("    🧮 Simplifying: -(-expression) → expression")
                 return operand.operand
         
-        return UnaryExpression(node.operator, operand)
+        return self.expressions.unary(node.operator, operand)
     
     def evaluate_binary_operation(self, left_val: int, operator: str, right_val: int) -> Optional[int]:
         """Evaluate binary operations between constants."""
@@ -2209,11 +3297,11 @@ class EnhancedConstantPropagationPass(OptimizationPass):
             elif operator == '/':
                 if right_val == 0:
                     return None  # Division by zero
-                return left_val // right_val  # Integer division
+                return c_divide(left_val, right_val)  # Truncates toward zero like C
             elif operator == '%':
                 if right_val == 0:
                     return None
-                return left_val % right_val
+                return c_modulo(left_val, right_val)
             elif operator == '==':
                 return 1 if left_val == right_val else 0
             elif operator == '!=':
@@ -2238,33 +3326,33 @@ class EnhancedConstantPropagationPass(OptimizationPass):
     def report(self):
         """Report comprehensive optimization results."""
         if self.optimizations_applied > 0:
-            print(f"✅ Enhanced Constant Propagation: {self.optimizations_applied} optimizations applied")
+            log.info("✅ Enhanced Constant Propagation: %s optimizations applied", self.optimizations_applied)
             
             if self.folded_expressions:
-                print(f"   🔢 Constant expressions folded: {len(self.folded_expressions)}")
+                log.debug("   🔢 Constant expressions folded: %s", len(self.folded_expressions))
                 # Show first few examples
                 for expr in self.folded_expressions[:3]:
-                    print(f"      • {expr}")
+                    log.debug("      • %s", expr)
                 if len(self.folded_expressions) > 3:
-                    print(f"      • ... and {len(self.folded_expressions) - 3} more")
+                    log.debug("      • ... and %s more", len(self.folded_expressions) - 3)
             
             if self.simplified_operations:
-                print(f"   🧮 Algebraic simplifications: {len(self.simplified_operations)}")
+                log.debug("   🧮 Algebraic simplifications: %s", len(self.simplified_operations))
                 # Show unique simplifications
                 unique_simplifications = list(set(self.simplified_operations))
                 for simp in unique_simplifications[:3]:
-                    print(f"      • {simp}")
+                    log.debug("      • %s", simp)
             
             if self.function_constants:
-                print(f"   📊 Constant functions identified: {len(self.function_constants)}")
+                log.debug("   📊 Constant functions identified: %s", len(self.function_constants))
                 for func, val in self.function_constants.items():
-                    print(f"      • {func}() → {val}")
+                    log.debug("      • %s() → %s", func, val)
             
             # Estimate performance improvement
             improvement = self.optimizations_applied * 2  # Each optimization saves ~2 instructions
-            print(f"   📈 Estimated performance improvement: {improvement} fewer runtime operations")
+            log.debug("   📈 Estimated performance improvement: %s fewer runtime operations", improvement)
         else:
-            print("ℹ️  Enhanced Constant Propagation: No optimizations applied")
+            log.info("ℹ️  Enhanced Constant Propagation: No optimizations applied")
 
 # Backwards compatibility
 class ConstantFoldingPass(EnhancedConstantPropagationPass):
@@ -2282,94 +3370,41 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
     2. Unused variable elimination with data flow analysis
     3. Dead store removal (assignments to variables never read)
     4. Control flow analysis for impossible conditions
-    5. Unused function elimination
-    6. Empty block removal
+    5. Empty block removal
+    
+    Unused functions are removed by DeadFunctionEliminationPass.
     """
     
+    scope = 'function'
+    
     def __init__(self):
         super().__init__("Enhanced Dead Code Elimination")
         self.removed_statements = []
         self.removed_variables = []
-        self.removed_functions = []
         self.dead_stores = []
         self.variable_usage = {}  # Track variable read/write usage
-        self.function_calls = set()  # Track which functions are called
     
     def optimize(self, node: ASTNode) -> ASTNode:
         """Apply enhanced dead code elimination to the AST."""
         if isinstance(node, Program):
-            print("🗑️  Applying enhanced dead code elimination...")
-            
-            # First pass: analyze function calls to identify unused functions
-            self.analyze_function_usage(node)
-            
-            # Second pass: process each declaration
-            optimized_declarations = []
+            log.debug("🗑️  Applying enhanced dead code elimination...")
             for decl in node.declarations:
                 if isinstance(decl, FunctionDeclaration):
-                    # Skip unused functions (except main)
-                    if decl.name != 'main' and decl.name not in self.function_calls:
-                        self.optimizations_applied += 1
-                        self.removed_functions.append(decl.name)
-                        print(f"    🗑️  Removing unused function: {decl.name}")
-                        continue
-                        
-                    optimized_decl = self.optimize_function(decl)
-                    if optimized_decl:
-                        optimized_declarations.append(optimized_decl)
-                else:
-                    optimized_declarations.append(decl)
-            
-            return Program(optimized_declarations)
+                    self.optimize_function(decl)
+            return node
         else:
             return self.eliminate_dead_code(node)
     
-    def analyze_function_usage(self, program):
-        """Analyze which functions are actually called."""
-        self.function_calls = set()
-        
-        for decl in program.declarations:
-            if isinstance(decl, FunctionDeclaration):
-                self._find_function_calls(decl)
-        
-        # Always keep main function
-        self.function_calls.add('main')
-    
-    def _find_function_calls(self, node):
-        """Recursively find all function calls in the AST."""
-        if not node:
-            return
-            
-        # Check for function calls (CallExpression)
-        if hasattr(node, '__class__') and node.__class__.__name__ == 'CallExpression':
-            func_attr = getattr(node, 'function', None)
-            if func_attr and hasattr(func_attr, 'name'):
-                self.function_calls.add(func_attr.name)
-        
-        # Traverse child nodes systematically
-        if hasattr(node, 'body') and node.body:
-            if isinstance(node.body, list):
-                for item in node.body:
-                    self._find_function_calls(item)
-            else:
-                self._find_function_calls(node.body)
-        
-        if hasattr(node, 'statements') and node.statements:
-            for stmt in node.statements:
-                self._find_function_calls(stmt)
-        
-        for attr_name in ['condition', 'then_statement', 'else_statement', 'left', 'right', 'expression']:
-            if hasattr(node, attr_name):
-                attr_value = getattr(node, attr_name)
-                if attr_value:
-                    self._find_function_calls(attr_value)
+    def run_on_function(self, func: FunctionDeclaration, analyses: 'AnalysisManager'):
+        """Remove dead code from one function."""
+        self.optimize_function(func)
     
     def optimize_function(self, func: FunctionDeclaration):
         """Optimize a single function with comprehensive analysis."""
         if not func.body:
             return func
         
-        print(f"    🔍 Analyzing function: {func.name}")
+        log.debug("    🔍 Analyzing function: %s", func.name)
         
         # Reset per-function analysis
         self.variable_usage = {}
@@ -2403,6 +3438,10 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
             var_name = stmt.name
             if var_name not in self.variable_usage:
                 self.variable_usage[var_name] = {'reads': 0, 'writes': 0, 'declared': True}
+            self._count_variable_reads(stmt.initializer)
+        
+        elif isinstance(stmt, ExpressionStatement):
+            self._count_variable_reads(stmt.expression)
         
         # Handle assignments (writes)
         elif isinstance(stmt, AssignmentExpression):
@@ -2428,6 +3467,11 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
         elif isinstance(stmt, WhileStatement):
             self._count_variable_reads(stmt.condition)
             self._analyze_statement_usage(stmt.body)
+        elif isinstance(stmt, ForStatement):
+            self._analyze_statement_usage(stmt.init)
+            self._count_variable_reads(stmt.condition)
+            self._count_variable_reads(stmt.update)
+            self._analyze_statement_usage(stmt.body)
         elif isinstance(stmt, ReturnStatement):
             if stmt.expression:
                 self._count_variable_reads(stmt.expression)
@@ -2450,6 +3494,10 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
             self._count_variable_reads(expr.right)
         elif isinstance(expr, UnaryExpression):
             self._count_variable_reads(expr.operand)
+        elif isinstance(expr, AssignmentExpression):
+            if expr.operator != '=':
+                self._count_variable_reads(expr.left)
+            self._count_variable_reads(expr.right)
         elif hasattr(expr, '__class__') and expr.__class__.__name__ == 'CallExpression':
             # Check function arguments
             if hasattr(expr, 'arguments'):
@@ -2462,6 +3510,9 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
             return body
         
         optimized_statements = []
+        # The usage counts above skip some expression forms; never drop the
+        # declaration of a name that is still read or assigned anywhere
+        used = variables_read(body) | variables_written(body)
         
         for stmt in body.statements:
             should_keep = True
@@ -2471,12 +3522,15 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
                 var_name = stmt.name
                 if var_name in self.variable_usage:
                     usage = self.variable_usage[var_name]
-                    if usage['reads'] == 0:
+                    if (usage['reads'] == 0 and var_name not in used and
+                            (stmt.initializer is None or is_side_effect_free(stmt.initializer))):
                         # Variable is never read, remove it
                         should_keep = False
                         self.optimizations_applied += 1
                         self.removed_variables.append(var_name)
-                        print(f"      🗑️  Removing unused variable: {var_name}")
+                        log.trace("      🗑️  Removing unused variable: %s", var_name)
+                        remarks.emit(self, 'applied', 'UnusedVariableRemoved', 'never_read',
+                                     node=stmt, variable=var_name)
             
             # Check for dead stores (assignments to variables never read after)
             elif isinstance(stmt, AssignmentExpression):
@@ -2489,12 +3543,12 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
                             should_keep = False
                             self.optimizations_applied += 1
                             self.dead_stores.append(var_name)
-                            print(f"      🗑️  Removing dead store to: {var_name}")
+                            log.trace("      🗑️  Removing dead store to: %s", var_name)
             
             if should_keep:
                 optimized_statements.append(stmt)
         
-        return CompoundStatement(optimized_statements)
+        return copy_location(CompoundStatement(optimized_statements), body)
     
     def eliminate_dead_code(self, node: ASTNode) -> ASTNode:
         """Enhanced dead code elimination with better analysis."""
@@ -2522,7 +3576,9 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
                 self.optimizations_applied += 1
                 stmt_type = stmt.__class__.__name__
                 self.removed_statements.append(stmt_type)
-                print(f"      🗑️  Removing unreachable {stmt_type}")
+                log.trace("      🗑️  Removing unreachable %s", stmt_type)
+                remarks.emit(self, 'applied', 'UnreachableCodeRemoved', 'after_return',
+                             node=stmt, statement=stmt_type)
                 continue
             
             # Recursively process statement
@@ -2531,7 +3587,7 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
             # Skip empty statements
             if isinstance(processed_stmt, CompoundStatement) and not processed_stmt.statements:
                 self.optimizations_applied += 1
-                print(f"      🗑️  Removing empty compound statement")
+                log.trace("      🗑️  Removing empty compound statement")
                 continue
             
             new_statements.append(processed_stmt)
@@ -2539,9 +3595,9 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
             # Check if this statement terminates control flow
             if self.is_terminator(processed_stmt):
                 found_terminator = True
-                print(f"      ⚠️  Found terminator, marking subsequent code as unreachable")
+                log.trace("      ⚠️  Found terminator, marking subsequent code as unreachable")
         
-        return CompoundStatement(new_statements)
+        return copy_location(CompoundStatement(new_statements), node)
     
     def eliminate_dead_if(self, node: IfStatement) -> ASTNode:
         """Eliminate if statements with constant conditions and empty branches."""
@@ -2552,10 +3608,10 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
         if isinstance(condition, IntegerLiteral):
             self.optimizations_applied += 1
             if condition.value != 0:  # True condition
-                print(f"      🔧 Eliminating if with constant true condition")
+                log.trace("      🔧 Eliminating if with constant true condition")
                 return self.eliminate_dead_code(node.then_statement)
             else:  # False condition
-                print(f"      🔧 Eliminating if with constant false condition")
+                log.trace("      🔧 Eliminating if with constant false condition")
                 if node.else_statement:
                     return self.eliminate_dead_code(node.else_statement)
                 else:
@@ -2571,9 +3627,9 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
         if isinstance(else_stmt, CompoundStatement) and not else_stmt.statements:
             else_stmt = None
             self.optimizations_applied += 1
-            print(f"      🗑️  Removing empty else branch")
+            log.trace("      🗑️  Removing empty else branch")
         
-        return IfStatement(condition, then_stmt, else_stmt)
+        return copy_location(IfStatement(condition, then_stmt, else_stmt), node)
     
     def is_terminator(self, stmt):
         """Check if a statement terminates control flow."""
@@ -2582,38 +3638,155 @@ class EnhancedDeadCodeEliminationPass(OptimizationPass):
     def report(self):
         """Report comprehensive optimization results."""
         if self.optimizations_applied > 0:
-            print(f"✅ Enhanced Dead Code Elimination: {self.optimizations_applied} optimizations applied")
-            
-            if self.removed_functions:
-                print(f"   🗑️  Removed unused functions: {', '.join(self.removed_functions)}")
+            log.info("✅ Enhanced Dead Code Elimination: %s optimizations applied", self.optimizations_applied)
             
             if self.removed_statements:
                 from collections import Counter
                 stmt_counts = Counter(self.removed_statements)
                 stmt_summary = ', '.join([f"{count}x {stmt}" for stmt, count in stmt_counts.items()])
-                print(f"   🗑️  Removed unreachable statements: {stmt_summary}")
+                log.debug("   🗑️  Removed unreachable statements: %s", stmt_summary)
             
             if self.removed_variables:
-                print(f"   🗑️  Removed unused variables: {', '.join(self.removed_variables)}")
+                log.debug("   🗑️  Removed unused variables: %s", ', '.join(self.removed_variables))
                 
             if self.dead_stores:
-                print(f"   🗑️  Removed dead stores: {', '.join(self.dead_stores)}")
+                log.debug("   🗑️  Removed dead stores: %s", ', '.join(self.dead_stores))
                 
             # Calculate estimated performance improvement
-            total_removals = (len(self.removed_functions) * 20 + 
-                            len(self.removed_statements) * 2 + 
+            total_removals = (len(self.removed_statements) * 2 + 
                             len(self.removed_variables) * 1 + 
                             len(self.dead_stores) * 1)
             
-            print(f"   📈 Estimated code size reduction: ~{total_removals} instructions")
+            log.debug("   📈 Estimated code size reduction: ~%s instructions", total_removals)
         else:
-            print("ℹ️  Enhanced Dead Code Elimination: No optimizations applied")
+            log.info("ℹ️  Enhanced Dead Code Elimination: No optimizations applied")
 
 # Keep old class name for compatibility
 class DeadCodeEliminationPass(EnhancedDeadCodeEliminationPass):
     """Backwards compatibility wrapper for enhanced dead code elimination."""
     pass
 
+class DeadFunctionEliminationPass(OptimizationPass):
+    """
+    Removes functions that cannot be reached through calls from main.
+    
+    Only sound when the program is complete (single-file builds and -flto);
+    separately compiled units keep every function.
+    """
+    requires = ('callgraph',)
+    preserves = ('calls', 'returns', 'cfg', 'liveness')
+    
+    def __init__(self):
+        super().__init__("Dead Function Elimination")
+        self.removed_functions = []
+        self.remove_unused_functions = True  # Only safe when the file is the whole program
+    
+    def run_on_module(self, program: Program, analyses: 'AnalysisManager') -> Program:
+        """Drop function definitions that no root reaches."""
+        if not self.remove_unused_functions:
+            return program
+        
+        call_graph = analyses.get('callgraph')
+        reachable = set()
+        worklist = ['main']
+        while worklist:
+            name = worklist.pop()
+            if name not in reachable:
+                reachable.add(name)
+                worklist.extend(call_graph.get(name, {}))
+        
+        declarations = []
+        for decl in program.declarations:
+            if (isinstance(decl, FunctionDeclaration) and decl.body and
+                    decl.name not in reachable):
+                self.optimizations_applied += 1
+                self.removed_functions.append(decl.name)
+                log.debug("    🗑️  Removing unused function: %s", decl.name)
+                remarks.emit(self, 'applied', 'FunctionRemoved', 'unreachable_from_roots',
+                             function=decl.name, node=decl, roots=['main'])
+                continue
+            declarations.append(decl)
+        return Program(declarations) if len(declarations) != len(program.declarations) else program
+    
+    def report(self):
+        """Report removed functions."""
+        super().report()
+        if self.removed_functions:
+            log.debug("   🗑️  Removed unused functions: %s", ', '.join(self.removed_functions))
+
+class DeadStoreEliminationPass(OptimizationPass):
+    """
+    Removes stores to locals that are never read afterwards.
+    
+    Uses the liveness analysis on the statement-level flow graph, so stores
+    inside loops are only removed when no later iteration reads them. Only
+    side-effect-free right-hand sides are dropped, and functions that reuse
+    a name in nested scopes are skipped because liveness is tracked by name.
+    """
+    scope = 'function'
+    requires = ('liveness',)
+    preserves = ('calls', 'returns')
+    
+    def __init__(self):
+        super().__init__("Dead Store Elimination")
+    
+    def run_on_function(self, func: FunctionDeclaration, analyses: 'AnalysisManager'):
+        """Delete dead assignments and dead initializers in one function."""
+        if not func.body:
+            return
+        names = [p.name for p in func.parameters] + declared_variables(func.body)
+        if len(names) != len(set(names)):
+            remarks.emit(self, 'missed', 'DeadStoresNotAnalyzed', 'shadowed_names',
+                         shadowed=sorted({n for n in names if names.count(n) > 1}))
+            return
+        
+        liveness = analyses.get('liveness', func)
+        dead = set()
+        for index, statement in enumerate(liveness.cfg.statements):
+            target = self.stored_variable(statement)
+            if (target in names and target not in liveness.live_out[index]):
+                dead.add(id(statement))
+        if dead:
+            func.body = self.remove_stores(func.body, dead)
+    
+    def stored_variable(self, node: Optional[ASTNode]) -> Optional[str]:
+        """The local a removable store writes, if node is one."""
+        if isinstance(node, ExpressionStatement):
+            expr = node.expression
+            if (isinstance(expr, AssignmentExpression) and isinstance(expr.left, Identifier)
+                    and is_side_effect_free(expr.right)):
+                return expr.left.name
+        elif isinstance(node, VariableDeclaration):
+            if node.initializer is not None and is_side_effect_free(node.initializer):
+                return node.name
+        return None
+    
+    def remove_stores(self, node: ASTNode, dead: Set[int]) -> ASTNode:
+        """Rebuild statements without the dead stores (declarations lose their initializer)."""
+        if id(node) in dead:
+            self.optimizations_applied += 1
+            if isinstance(node, VariableDeclaration):
+                log.trace("    🗑️  Dropping dead initializer of %s", node.name)
+                remarks.emit(self, 'applied', 'DeadStoreRemoved', 'value_never_read',
+                             node=node, variable=node.name, store='initializer')
+                node.initializer = None
+                return node
+            log.trace("    🗑️  Removing dead store to %s", node.expression.left.name)
+            remarks.emit(self, 'applied', 'DeadStoreRemoved', 'value_never_read',
+                         node=node, variable=node.expression.left.name, store='assignment')
+            return CompoundStatement([])
+        if isinstance(node, CompoundStatement):
+            node.statements = [self.remove_stores(stmt, dead) for stmt in node.statements]
+            node.statements = [stmt for stmt in node.statements
+                               if not (isinstance(stmt, CompoundStatement) and not stmt.statements)]
+        elif isinstance(node, IfStatement):
+            node.then_statement = self.remove_stores(node.then_statement, dead)
+            if node.else_statement:
+                node.else_statement = self.remove_stores(node.else_statement, dead)
+        elif isinstance(node, (WhileStatement, ForStatement)):
+            node.body = self.remove_stores(node.body, dead)
+        return node
+
 class LoopUnrollingPass(OptimizationPass):
     """
     Advanced Loop Unrolling Optimization Pass
@@ -2626,11 +3799,14 @@ class LoopUnrollingPass(OptimizationPass):
     5. Considers code size vs. performance trade-offs
     """
     
+    scope = 'function'
+    
     def __init__(self, max_unroll_factor: int = 8, max_code_expansion: int = 4):
         super().__init__("Loop Unrolling")
         self.max_unroll_factor = max_unroll_factor    # Maximum times to unroll
         self.max_code_expansion = max_code_expansion  # Maximum code size multiplier
         self.unrolled_loops = 0                       # Statistics counter
+        self.rejection = None                         # Why the last loop was not analyzable
     
     def optimize(self, node: ASTNode) -> ASTNode:
         """Apply loop optimizations to AST."""
@@ -2698,13 +3874,14 @@ class LoopUnrollingPass(OptimizationPass):
             isinstance(node.init.initializer, IntegerLiteral)):
             analysis['loop_var'] = node.init.name
             analysis['start_value'] = node.init.initializer.value
-        elif isinstance(node.init, AssignmentExpression):
-            if (isinstance(node.init.left, Identifier) and 
-                isinstance(node.init.right, IntegerLiteral)):
-                analysis['loop_var'] = node.init.left.name
-                analysis['start_value'] = node.init.right.value
+        elif (isinstance(node.init, AssignmentExpression) and node.init.operator == '=' and
+              isinstance(node.init.left, Identifier) and
+              isinstance(node.init.right, IntegerLiteral)):
+            analysis['loop_var'] = node.init.left.name
+            analysis['start_value'] = node.init.right.value
         else:
-            return None  # Complex initialization
+            self.rejection = 'complex_initialization'
+            return None
         
         # Analyze condition: i < end_value or i <= end_value
         if isinstance(node.condition, BinaryExpression):
@@ -2720,33 +3897,43 @@ class LoopUnrollingPass(OptimizationPass):
                 elif node.condition.operator == '<=':
                     analysis['inclusive'] = True
                 else:
-                    return None  # Complex condition
+                    self.rejection = 'unsupported_condition_operator'
+                    return None
             else:
+                self.rejection = 'complex_condition'
                 return None
         else:
+            self.rejection = 'complex_condition'
             return None
         
-        # Analyze update: i++ or i += increment
-        if isinstance(node.update, UnaryExpression):
-            if (isinstance(node.update.operand, Identifier) and
-                node.update.operand.name == analysis['loop_var'] and
-                node.update.operator == '++'):
-                analysis['increment'] = 1
+        # Analyze update: ++i, i++, i += increment or i = i + increment
+        loop_var = analysis['loop_var']
+        update = node.update
+        if (isinstance(update, UnaryExpression) and update.operator in ('++', 'post++') and
+                isinstance(update.operand, Identifier) and update.operand.name == loop_var):
+            analysis['increment'] = 1
+        elif (isinstance(update, AssignmentExpression) and isinstance(update.left, Identifier) and
+              update.left.name == loop_var):
+            if update.operator == '+=' and isinstance(update.right, IntegerLiteral):
+                analysis['increment'] = update.right.value
+            elif (update.operator == '=' and isinstance(update.right, BinaryExpression) and
+                  update.right.operator == '+' and
+                  isinstance(update.right.left, Identifier) and
+                  update.right.left.name == loop_var and
+                  isinstance(update.right.right, IntegerLiteral)):
+                analysis['increment'] = update.right.right.value
             else:
+                self.rejection = 'complex_update'
                 return None
-        elif isinstance(node.update, AssignmentExpression):
-            if (isinstance(node.update.left, Identifier) and
-                node.update.left.name == analysis['loop_var']):
-                # Handle i += increment or i = i + increment
-                if (isinstance(node.update.right, BinaryExpression) and
-                    node.update.right.operator == '+' and
-                    isinstance(node.update.right.left, Identifier) and
-                    node.update.right.left.name == analysis['loop_var'] and
-                    isinstance(node.update.right.right, IntegerLiteral)):
-                    analysis['increment'] = node.update.right.right.value
-                else:
-                    return None
         else:
+            self.rejection = 'complex_update'
+            return None
+        
+        # Unrolled copies replace every use of the variable in the body
+        body_names = variables_written(node.body)
+        body_names.update(declared_variables(node.body))
+        if analysis['loop_var'] in body_names:
+            self.rejection = 'loop_variable_modified'
             return None
         
         # Calculate total iterations
@@ -2760,7 +3947,8 @@ class LoopUnrollingPass(OptimizationPass):
             else:
                 analysis['total_iterations'] = (end - start + increment - 1) // increment
         else:
-            return None  # Decreasing loops not yet supported
+            self.rejection = 'decreasing_loop'  # Not yet supported
+            return None
         
         # Estimate body complexity
         analysis['body_complexity'] = self._estimate_code_size(node.body)
@@ -2771,6 +3959,7 @@ class LoopUnrollingPass(OptimizationPass):
         """Analyze while loop for simple counting patterns."""
         # For now, only handle simple while loops with obvious patterns
         # This could be extended to detect more complex patterns
+        self.rejection = 'while_loop'
         return None
     
     def _estimate_code_size(self, node: ASTNode) -> int:
@@ -2851,7 +4040,7 @@ class LoopUnrollingPass(OptimizationPass):
         unroll_factor = decision['unroll_factor']
         strategy = decision['strategy']
         
-        print(f"      🔄 Unrolling loop {analysis['loop_var']} by {unroll_factor}x ({strategy})")
+        log.debug("      🔄 Unrolling loop %s by %sx (%s)", analysis['loop_var'], unroll_factor, strategy)
         
         if strategy == 'full':
             return self._full_unroll(node, analysis)
@@ -2869,21 +4058,23 @@ class LoopUnrollingPass(OptimizationPass):
         
         for i in range(iterations):
             current_value = start_value + i * analysis['increment']
-            # Clone the loop body and substitute loop variable with current value
-            cloned_body = self._substitute_loop_variable(
-                self._deep_copy_node(node.body), 
-                loop_var, 
-                current_value
-            )
+            # Clone the loop body with the loop variable replaced by its value
+            cloned_body = clone_tree(node.body, {loop_var: IntegerLiteral(current_value)})
             
             if isinstance(cloned_body, CompoundStatement):
                 unrolled_statements.extend(cloned_body.statements)
             else:
                 unrolled_statements.append(cloned_body)
         
+        # Leave the variable where the loop would (unless it was scoped to the loop)
+        if not isinstance(node.init, VariableDeclaration):
+            final_value = start_value + iterations * analysis['increment']
+            unrolled_statements.append(ExpressionStatement(
+                AssignmentExpression(Identifier(loop_var), '=', IntegerLiteral(final_value))))
+        
         self.optimizations_applied += 1
         self.unrolled_loops += 1
-        return CompoundStatement(unrolled_statements)
+        return copy_location(CompoundStatement(unrolled_statements), node)
     
     def _partial_unroll(self, node: ASTNode, analysis: Dict, unroll_factor: int) -> ASTNode:
         """Partially unroll a loop with remainder handling."""
@@ -2909,11 +4100,9 @@ class LoopUnrollingPass(OptimizationPass):
             unrolled_body_stmts = []
             for i in range(unroll_factor):
                 offset = i * increment
-                cloned_body = self._substitute_loop_variable_offset(
-                    self._deep_copy_node(node.body),
-                    loop_var,
-                    offset
-                )
+                cloned_body = clone_tree(node.body, {
+                    loop_var: BinaryExpression(Identifier(loop_var), '+', IntegerLiteral(offset))
+                } if offset else None)
                 if isinstance(cloned_body, CompoundStatement):
                     unrolled_body_stmts.extend(cloned_body.statements)
                 else:
@@ -2938,12 +4127,12 @@ class LoopUnrollingPass(OptimizationPass):
                     IntegerLiteral(new_end_value)
                 )
                 
-                unrolled_loop = ForStatement(
+                unrolled_loop = copy_location(ForStatement(
                     node.init,  # Keep original init
-                    new_condition,
-                    new_update,
-                    CompoundStatement(unrolled_body_stmts)
-                )
+                    copy_location(new_condition, node.condition),
+                    copy_location(new_update, node.update),
+                    copy_location(CompoundStatement(unrolled_body_stmts), node.body)
+                ), node)
                 statements.append(unrolled_loop)
         
         # Remainder loop (if needed)
@@ -2964,77 +4153,17 @@ class LoopUnrollingPass(OptimizationPass):
                 IntegerLiteral(remainder_end)
             )
             
-            remainder_loop = ForStatement(
-                remainder_init,
-                remainder_condition,
+            remainder_loop = copy_location(ForStatement(
+                copy_location(remainder_init, node.init),
+                copy_location(remainder_condition, node.condition),
                 node.update,  # Keep original increment
-                self._deep_copy_node(node.body)
-            )
+                clone_tree(node.body)
+            ), node)
             statements.append(remainder_loop)
         
         self.optimizations_applied += 1
         self.unrolled_loops += 1
-        return CompoundStatement(statements)
-    
-    def _substitute_loop_variable(self, node: ASTNode, var_name: str, value: int) -> ASTNode:
-        """Replace all occurrences of loop variable with constant value."""
-        if isinstance(node, Identifier) and node.name == var_name:
-            return IntegerLiteral(value)
-        elif isinstance(node, BinaryExpression):
-            node.left = self._substitute_loop_variable(node.left, var_name, value)
-            node.right = self._substitute_loop_variable(node.right, var_name, value)
-        elif isinstance(node, UnaryExpression):
-            node.operand = self._substitute_loop_variable(node.operand, var_name, value)
-        elif isinstance(node, AssignmentExpression):
-            node.left = self._substitute_loop_variable(node.left, var_name, value)
-            node.right = self._substitute_loop_variable(node.right, var_name, value)
-        elif isinstance(node, CompoundStatement):
-            node.statements = [
-                self._substitute_loop_variable(stmt, var_name, value) 
-                for stmt in node.statements
-            ]
-        elif isinstance(node, ExpressionStatement):
-            if node.expression:
-                node.expression = self._substitute_loop_variable(node.expression, var_name, value)
-        # Add more node types as needed
-        
-        return node
-    
-    def _substitute_loop_variable_offset(self, node: ASTNode, var_name: str, offset: int) -> ASTNode:
-        """Replace loop variable with (loop_variable + offset) for partial unrolling."""
-        if isinstance(node, Identifier) and node.name == var_name:
-            if offset == 0:
-                return node  # No change needed
-            else:
-                return BinaryExpression(
-                    Identifier(var_name),
-                    '+',
-                    IntegerLiteral(offset)
-                )
-        elif isinstance(node, BinaryExpression):
-            node.left = self._substitute_loop_variable_offset(node.left, var_name, offset)
-            node.right = self._substitute_loop_variable_offset(node.right, var_name, offset)
-        elif isinstance(node, UnaryExpression):
-            node.operand = self._substitute_loop_variable_offset(node.operand, var_name, offset)
-        elif isinstance(node, AssignmentExpression):
-            node.left = self._substitute_loop_variable_offset(node.left, var_name, offset)
-            node.right = self._substitute_loop_variable_offset(node.right, var_name, offset)
-        elif isinstance(node, CompoundStatement):
-            node.statements = [
-                self._substitute_loop_variable_offset(stmt, var_name, offset) 
-                for stmt in node.statements
-            ]
-        elif isinstance(node, ExpressionStatement):
-            if node.expression:
-                node.expression = self._substitute_loop_variable_offset(node.expression, var_name, offset)
-        
-        return node
-    
-    def _deep_copy_node(self, node: ASTNode) -> ASTNode:
-        """Create a deep copy of an AST node."""
-        # Simple deep copy implementation - in practice, you'd want a more robust version
-        import copy
-        return copy.deepcopy(node)
+        return copy_location(CompoundStatement(statements), node)
     
     def optimize_loops(self, node: ASTNode) -> ASTNode:
         """Main loop optimization entry point."""
@@ -3045,16 +4174,28 @@ class LoopUnrollingPass(OptimizationPass):
             if analysis:
                 # Decide whether to unroll
                 decision = self.should_unroll_loop(analysis)
+                metrics = {'loop_var': analysis['loop_var'],
+                           'iterations': analysis['total_iterations'],
+                           'body_complexity': analysis['body_complexity'],
+                           'max_unroll_factor': self.max_unroll_factor,
+                           'max_code_expansion': self.max_code_expansion}
                 
                 if decision['should_unroll']:
-                    print(f"      📊 Loop analysis: {analysis['total_iterations']} iterations, "
-                          f"body complexity: {analysis['body_complexity']}")
-                    print(f"      ✅ Decision: {decision['reason']}")
+                    log.debug("      📊 Loop analysis: %s iterations, body complexity: %s", analysis['total_iterations'], analysis['body_complexity'])
+                    log.debug("      ✅ Decision: %s", decision['reason'])
+                    remarks.emit(self, 'applied', 'LoopUnrolled', decision['reason'], node=node,
+                                 unroll_factor=decision['unroll_factor'],
+                                 strategy=decision['strategy'], **metrics)
                     
                     # Perform unrolling
                     return self.unroll_loop(node, analysis, decision)
                 else:
-                    print(f"      ❌ Skipping unroll: {decision['reason']}")
+                    log.debug("      ❌ Skipping unroll: %s", decision['reason'])
+                    remarks.emit(self, 'missed', 'LoopNotUnrolled', decision['reason'], node=node,
+                                 **metrics)
+            else:
+                remarks.emit(self, 'missed', 'LoopNotUnrolled', self.rejection, node=node,
+                             loop=type(node).__name__)
             
             # Recursively optimize loop body even if not unrolling
             if isinstance(node, ForStatement):
@@ -3080,18 +4221,338 @@ class LoopUnrollingPass(OptimizationPass):
         """Enhanced reporting with unrolling statistics."""
         super().report()
         if self.unrolled_loops > 0:
-            print(f"      🔄 Successfully unrolled {self.unrolled_loops} loops")
+            log.debug("      🔄 Successfully unrolled %s loops", self.unrolled_loops)
 
-class PeepholeOptimizerPass(OptimizationPass):
+class LoopUnswitchingPass(OptimizationPass):
     """
-    Peephole Optimization Pass
-    
-    Performs assembly-level optimizations on generated code:
-    - Remove redundant move instructions
-    - Combine adjacent operations
-    - Optimize register usage patterns
+    Hoists loop-invariant conditions out of loops.
+
+        while (c) { A; if (flag) B; else C; D; }
+    becomes
+        if (flag) while (c) { A; B; D; } else while (c) { A; C; D; }
+
+    so the branch is decided once instead of every iteration. A condition
+    is invariant when it has no side effects, cannot trap, and reads nothing
+    the loop writes or declares (nor any global, if the loop calls out).
+    Each unswitch duplicates the loop, so loops above max_loop_size nodes
+    are left alone and a function may grow to at most max_code_expansion
+    times its size. Inner loops are unswitched first; a condition they hoist
+    can then be unswitched out of the enclosing loop.
     """
-    
+
+    scope = 'function'
+    preserves = ('returns',)
+
+    def __init__(self, max_loop_size: int = 60, max_code_expansion: int = 2):
+        super().__init__("Loop Unswitching")
+        self.max_loop_size = max_loop_size            # Largest loop (AST nodes) to duplicate
+        self.max_code_expansion = max_code_expansion  # Maximum function size multiplier
+        self.unswitched_loops = 0                     # Statistics counter
+        self.original_sizes = {}                      # id(function) -> (function, size when first seen)
+        self.budget = 0                               # Nodes the current function may still grow by
+        self.names = set()                            # Names declared in the function or globally
+        self.locals = set()                           # Parameters and locals of the function
+        self.renamed_from = {}                        # Renamed copy -> original variable name
+
+    def run_on_function(self, func: FunctionDeclaration, analyses: 'AnalysisManager'):
+        """Unswitch the loops of one function within its growth budget."""
+        if not func.body:
+            return
+        # The budget is measured against the function as this pass first saw it,
+        # so repeated pass iterations cannot compound the growth
+        entry = self.original_sizes.get(id(func))
+        if entry is None:
+            entry = self.original_sizes[id(func)] = (func, count_nodes(func))
+        self.budget = entry[1] * self.max_code_expansion - count_nodes(func)
+        declared = [p.name for p in func.parameters] + declared_variables(func.body)
+        self.locals = set(declared)
+        self.names = self.locals | {d.name for d in analyses.program.declarations
+                                    if isinstance(d, VariableDeclaration)}
+        if len(declared) != len(self.locals):
+            remarks.emit(self, 'missed', 'LoopsNotUnswitched', 'shadowed_names',
+                         shadowed=sorted({n for n in declared if declared.count(n) > 1}))
+            return
+        func.body = self.unswitch(func.body)
+
+    def unswitch(self, node: ASTNode) -> ASTNode:
+        """Unswitch every loop under a statement, innermost first."""
+        return self.dispatch('unswitch', node, default=node)
+
+    @handles('unswitch', CompoundStatement)
+    def _unswitch_block(self, node: CompoundStatement) -> ASTNode:
+        node.statements = [self.unswitch(stmt) for stmt in node.statements]
+        return node
+
+    @handles('unswitch', IfStatement)
+    def _unswitch_if(self, node: IfStatement) -> ASTNode:
+        node.then_statement = self.unswitch(node.then_statement)
+        if node.else_statement:
+            node.else_statement = self.unswitch(node.else_statement)
+        return node
+
+    @handles('unswitch', WhileStatement, ForStatement)
+    def _unswitch_loop(self, node: ASTNode) -> ASTNode:
+        node.body = self.unswitch(node.body)
+        return self.unswitch_loop(node)
+
+    def unswitch_loop(self, loop: ASTNode) -> ASTNode:
+        """Split loop on its first invariant if, then split both versions further."""
+        branch = self.invariant_branch(loop)
+        if branch is None:
+            return loop
+        size = count_nodes(loop)
+        metrics = {'loop': type(loop).__name__, 'loop_size': size,
+                   'max_loop_size': self.max_loop_size, 'budget': self.budget,
+                   'max_code_expansion': self.max_code_expansion}
+        if size > self.max_loop_size:
+            remarks.emit(self, 'missed', 'LoopNotUnswitched', 'loop_too_large', node=loop, **metrics)
+            return loop
+        if size > self.budget:
+            remarks.emit(self, 'missed', 'LoopNotUnswitched', 'code_growth_budget', node=loop, **metrics)
+            return loop
+
+        log.trace("    🔀 Unswitching %s on an invariant condition", type(loop).__name__)
+        remarks.emit(self, 'applied', 'LoopUnswitched', 'invariant_condition', node=branch, **metrics)
+        self.budget -= size
+        self.optimizations_applied += 1
+        self.unswitched_loops += 1
+
+        # The then version keeps the original nodes; the else version is a
+        # clone whose locals are renamed so every declaration stays unique
+        then_loop = self.with_body(loop, self.replace_statement(
+            loop.body, branch, branch.then_statement))
+        else_loop = clone_tree(self.with_body(loop, self.replace_statement(
+            loop.body, branch, branch.else_statement or CompoundStatement([]))),
+            self.fresh_names(loop))
+        return copy_location(IfStatement(branch.condition, self.unswitch_loop(then_loop),
+                                         self.unswitch_loop(else_loop)), loop)
+
+    def invariant_branch(self, loop: ASTNode) -> Optional[IfStatement]:
+        """The first if in the loop body (outside nested loops) whose condition is invariant."""
+        written = variables_written(loop)
+        written.update(declared_variables(loop))
+        calls = bool(find_called_functions(loop))
+        for branch in self.branches(loop.body):
+            reads = variables_read(branch.condition)
+            if (reads and not reads & written
+                    and (not calls or reads <= self.locals)
+                    and is_side_effect_free(branch.condition)
+                    and not self.may_trap(branch.condition)):
+                return branch
+        return None
+
+    def branches(self, node: ASTNode):
+        """If statements a loop body runs directly (nested loops are unswitched on their own)."""
+        if isinstance(node, CompoundStatement):
+            for stmt in node.statements:
+                yield from self.branches(stmt)
+        elif isinstance(node, IfStatement):
+            yield node
+            yield from self.branches(node.then_statement)
+            if node.else_statement:
+                yield from self.branches(node.else_statement)
+
+    def may_trap(self, node: ASTNode) -> bool:
+        """True if evaluating node could divide by zero (it would now run before the loop)."""
+        if (isinstance(node, BinaryExpression) and node.operator in ('/', '%')
+                and not (isinstance(node.right, IntegerLiteral) and node.right.value != 0)):
+            return True
+        return any(self.may_trap(child) for child in iter_child_nodes(node))
+
+    def replace_statement(self, node: ASTNode, target: ASTNode, replacement: Optional[ASTNode]) -> ASTNode:
+        """node with target replaced, rebuilding only the blocks and ifs on the way to it."""
+        if node is target:
+            return replacement
+        if isinstance(node, CompoundStatement):
+            return copy_location(CompoundStatement(
+                [self.replace_statement(stmt, target, replacement) for stmt in node.statements]), node)
+        if isinstance(node, IfStatement):
+            return copy_location(IfStatement(
+                node.condition,
+                self.replace_statement(node.then_statement, target, replacement),
+                node.else_statement and self.replace_statement(node.else_statement, target, replacement)),
+                node)
+        return node
+
+    def with_body(self, loop: ASTNode, body: ASTNode) -> ASTNode:
+        """A copy of the loop statement around a new body (the other parts are shared)."""
+        if isinstance(loop, WhileStatement):
+            return copy_location(WhileStatement(loop.condition, body), loop)
+        return copy_location(ForStatement(loop.init, loop.condition, loop.update, body), loop)
+
+    def fresh_names(self, loop: ASTNode) -> Dict[str, str]:
+        """New names for the variables declared in a loop, unused anywhere in the function."""
+        renames = {}
+        for name in declared_variables(loop):
+            base = self.renamed_from.get(name, name)
+            counter = 1
+            while f"{base}_us{counter}" in self.names:
+                counter += 1
+            renames[name] = f"{base}_us{counter}"
+            self.renamed_from[renames[name]] = base
+            self.names.add(renames[name])
+            self.locals.add(renames[name])
+        return renames
+
+    def report(self):
+        super().report()
+        if self.unswitched_loops > 0:
+            log.debug("      🔀 Unswitched %s loops", self.unswitched_loops)
+
+class LoopFusionPass(OptimizationPass):
+    """
+    Fuses adjacent counted loops with the same iteration space.
+
+        for (i = 0; i < 8; i++) A;  for (i = 0; i < 8; i++) B;
+    becomes
+        for (i = 0; i < 8; i++) { A; B; }
+
+    Loops are recognized with LoopUnrollingPass's counted-loop analysis and
+    must agree on variable, start, bound, step and comparison. Fusion runs
+    B's iteration k before A's iterations k+1 onwards, which is only safe
+    when no value flows between the bodies across iterations. Locals are
+    scalars, so every dependence on a shared variable is loop-carried:
+    the bodies may not write anything the other reads or writes, and may
+    not call functions. Fused bodies are fused again, so perfect nests with
+    matching inner loops merge level by level.
+    """
+
+    scope = 'function'
+    preserves = ('calls', 'returns')
+
+    def __init__(self):
+        super().__init__("Loop Fusion")
+        self.counted_loops = LoopUnrollingPass()  # Counted-loop analysis
+        self.fused_loops = 0                      # Statistics counter
+
+    def run_on_function(self, func: FunctionDeclaration, analyses: 'AnalysisManager'):
+        """Fuse loops in every block of one function."""
+        if func.body:
+            self.fuse(func.body)
+
+    def fuse(self, node: ASTNode):
+        """Fuse loops in every block under a statement, outer blocks first."""
+        self.dispatch('fuse', node)
+
+    @handles('fuse', CompoundStatement)
+    def _fuse_block(self, node: CompoundStatement):
+        statements = []
+        for stmt in node.statements:
+            if statements and isinstance(stmt, ForStatement) and isinstance(statements[-1], ForStatement):
+                fused = self.fuse_pair(statements[-1], stmt)
+                if fused is not None:
+                    statements[-1] = fused
+                    continue
+            statements.append(stmt)
+        node.statements = statements
+        for stmt in statements:
+            self.fuse(stmt)
+
+    @handles('fuse', IfStatement)
+    def _fuse_if(self, node: IfStatement):
+        self.fuse(node.then_statement)
+        if node.else_statement:
+            self.fuse(node.else_statement)
+
+    @handles('fuse', WhileStatement, ForStatement)
+    def _fuse_loop(self, node: ASTNode):
+        self.fuse(node.body)
+
+    def fuse_pair(self, first: ForStatement, second: ForStatement) -> Optional[ForStatement]:
+        """first and second as one loop, or None if they cannot be fused."""
+        first_loop = self.counted_loops.analyze_loop_pattern(first)
+        second_loop = self.counted_loops.analyze_loop_pattern(second)
+        if first_loop is None or second_loop is None:
+            return None
+        space = ('loop_var', 'start_value', 'end_value', 'increment', 'condition_op')
+        metrics = {'loop_var': first_loop['loop_var'],
+                   'iterations': first_loop['total_iterations']}
+        if (any(first_loop[key] != second_loop[key] for key in space)
+                or type(first.init) is not type(second.init)):
+            remarks.emit(self, 'missed', 'LoopsNotFused', 'different_iteration_space',
+                         node=second, **metrics)
+            return None
+        if find_called_functions(first.body) or find_called_functions(second.body):
+            remarks.emit(self, 'missed', 'LoopsNotFused', 'calls_in_body', node=second, **metrics)
+            return None
+        if self.returns(first.body) or self.returns(second.body):
+            remarks.emit(self, 'missed', 'LoopsNotFused', 'return_in_body', node=second, **metrics)
+            return None
+        conflicts = self.carried_dependences(first.body, second.body)
+        if conflicts:
+            remarks.emit(self, 'missed', 'LoopsNotFused', 'loop_carried_dependence',
+                         node=second, variables=sorted(conflicts), **metrics)
+            return None
+
+        log.trace("    🔗 Fusing two loops over %s", first_loop['loop_var'])
+        remarks.emit(self, 'applied', 'LoopsFused', 'same_iteration_space', node=first, **metrics)
+        self.optimizations_applied += 1
+        self.fused_loops += 1
+        body = copy_location(CompoundStatement(
+            self.body_statements(first.body) + self.body_statements(second.body)), first.body)
+        return copy_location(ForStatement(first.init, first.condition, first.update, body), first)
+
+    def carried_dependences(self, first: ASTNode, second: ASTNode) -> Set[str]:
+        """Variables through which one body's iterations would see the other's after fusion."""
+        first_writes = variables_written(first)
+        first_writes.update(declared_variables(first))
+        second_writes = variables_written(second)
+        second_writes.update(declared_variables(second))
+        conflicts = ((first_writes & (variables_read(second) | second_writes))
+                     | (second_writes & variables_read(first)))
+        return conflicts - (self.private_variables(first) & self.private_variables(second))
+    
+    def private_variables(self, body: ASTNode) -> Set[str]:
+        """
+        Variables every iteration of body sets before using them: its own
+        declarations and the counters of inner counted loops, when nothing
+        earlier in the body mentions them. No value flows across iterations
+        through them, so two bodies that both privatize one do not conflict.
+        """
+        private = set()
+        mentioned = set()
+        for stmt in (body.statements if isinstance(body, CompoundStatement) else [body]):
+            if isinstance(stmt, VariableDeclaration):
+                if stmt.name not in mentioned:
+                    private.add(stmt.name)
+            elif isinstance(stmt, ForStatement):
+                analysis = self.counted_loops.analyze_loop_pattern(stmt)
+                if analysis is not None and analysis['loop_var'] not in mentioned:
+                    private.add(analysis['loop_var'])
+            variables_read(stmt, mentioned)
+            variables_written(stmt, mentioned)
+            mentioned.update(declared_variables(stmt))
+        return private
+
+    def returns(self, node: ASTNode) -> bool:
+        """True if a return statement under node could end the loop early."""
+        return isinstance(node, ReturnStatement) or any(
+            self.returns(child) for child in iter_child_nodes(node))
+
+    def body_statements(self, body: ASTNode) -> List[ASTNode]:
+        """Statements of a loop body to splice into the fused body (blocks with declarations stay whole)."""
+        if isinstance(body, CompoundStatement) and not any(
+                isinstance(stmt, VariableDeclaration) for stmt in body.statements):
+            return list(body.statements)
+        return [body]
+
+    def report(self):
+        super().report()
+        if self.fused_loops > 0:
+            log.debug("      🔗 Fused %s loop pairs", self.fused_loops)
+
+class PeepholeOptimizerPass(OptimizationPass):
+    """
+    Peephole Optimization Pass
+    
+    Performs assembly-level optimizations on generated code:
+    - Remove redundant move instructions
+    - Combine adjacent operations
+    - Optimize register usage patterns
+    """
+    
+    scope = 'assembly'
+    
     def __init__(self):
         super().__init__("Peephole Optimization")
         self.assembly_lines = []
@@ -3126,8 +4587,8 @@ class PeepholeOptimizerPass(OptimizationPass):
                 if combined:
                     self.assembly_lines.append(combined)
                     self.optimizations_applied += 1
-                    i += 2  # Skip both lines
-                    optimized = True
+                    i += 2  # Consumed both lines (not the one after them)
+                    continue
             
             # Pattern 3: Remove unnecessary zero operations
             elif self.is_zero_operation(line):
@@ -3182,6 +4643,11 @@ class PeepholeOptimizerPass(OptimizationPass):
 # ============================================================================
 
 class FunctionInliningPass:
+    scope = 'module'
+    requires = ()
+    preserves = ()
+    name = "Function Inlining"
+    
     def __init__(self):
         self.inline_threshold = 50  # Max instructions to inline
         self.max_inline_depth = 3   # Prevent infinite recursion
@@ -3193,15 +4659,15 @@ class FunctionInliningPass:
     def analyze_function_calls(self, ast):
         """Analyze function call frequency and patterns"""
         self.call_frequency = {}
-        print(f"🔍 Scanning AST for function calls...")
+        log.debug("🔍 Scanning AST for function calls...")
         self._count_calls(ast)
         
-        print(f"📊 Function Call Analysis:")
+        log.debug("📊 Function Call Analysis:")
         if self.call_frequency:
             for func_name, count in self.call_frequency.items():
-                print(f"  {func_name}: {count} calls")
+                log.debug("  %s: %s calls", func_name, count)
         else:
-            print(f"  ❌ No function calls found in AST")
+            log.debug("  ❌ No function calls found in AST")
     
     def _count_calls(self, node, depth=0, visited=None):
         """Recursively count function calls"""
@@ -3230,9 +4696,9 @@ class FunctionInliningPass:
             if func_attr and hasattr(func_attr, 'name'):
                 func_name = func_attr.name
                 self.call_frequency[func_name] = self.call_frequency.get(func_name, 0) + 1
-                print(f"    ✅ Found call to {func_name}")
+                log.trace("    ✅ Found call to %s", func_name)
             else:
-                print(f"    ⚠️  Found CallExpression but no function name")
+                log.trace("    ⚠️  Found CallExpression but no function name")
         
         # Controlled recursive traversal with specific attributes
         key_attributes = ['declarations', 'body', 'statements', 'arguments', 
@@ -3355,13 +4821,15 @@ class FunctionInliningPass:
     
     def inline_function_calls(self, ast):
         """Inline suitable function calls in the AST"""
-        print("🔄 Starting function inlining...")
+        log.debug("🔄 Starting function inlining...")
         
         # First pass: collect function definitions
         self._collect_function_definitions(ast)
         
         # Second pass: analyze call patterns
         self.analyze_function_calls(ast)
+        if remarks.enabled:
+            self.remark_call_sites(ast)
         
         # Third pass: perform inlining
         inlined_ast = self._inline_calls_in_node(ast, depth=0)
@@ -3371,6 +4839,29 @@ class FunctionInliningPass:
         
         return inlined_ast
     
+    def remark_call_sites(self, ast):
+        """Record the inlining decision for every call to a defined function."""
+        def visit(node, caller):
+            if isinstance(node, CallExpression) and isinstance(node.function, Identifier):
+                callee = node.function.name
+                definition = self.function_definitions.get(callee)
+                if definition and definition['body']:
+                    should_inline, reason = self.should_inline_function(callee, definition['body'])
+                    if should_inline:
+                        # inline_function_calls never rewrites a call site, see _inline_calls_in_node
+                        reason = f"{reason}, but call sites are not rewritten yet"
+                    remarks.emit(self, 'missed', 'NotInlined', reason, function=caller, node=node,
+                                 callee=callee,
+                                 calls=self.call_frequency.get(callee, 0),
+                                 size=self._estimate_function_size(definition['body']),
+                                 threshold=self.inline_threshold)
+            for child in iter_child_nodes(node):
+                visit(child, caller)
+        
+        for decl in ast.declarations:
+            if isinstance(decl, FunctionDeclaration) and decl.body:
+                visit(decl.body, decl.name)
+    
     def _collect_function_definitions(self, node):
         """Collect all function definitions for inlining"""
         # Check if this is a FunctionDeclaration object (not just checking type attribute)
@@ -3385,7 +4876,7 @@ class FunctionInliningPass:
                     'parameters': func_params,
                     'node': node
                 }
-                print(f"    Collected function definition: {func_name}")
+                log.debug("    Collected function definition: %s", func_name)
         
         # Also check for old-style type attribute
         elif hasattr(node, 'type') and node.type == 'FunctionDeclaration':
@@ -3399,7 +4890,7 @@ class FunctionInliningPass:
                     'parameters': func_params,
                     'node': node
                 }
-                print(f"    Collected function definition: {func_name}")
+                log.debug("    Collected function definition: %s", func_name)
         
         # Recurse into child nodes
         for attr_name in ['declarations', 'body', 'statements', 'left', 'right', 'condition']:
@@ -3453,10 +4944,10 @@ class FunctionInliningPass:
         should_inline, reason = self.should_inline_function(func_name, func_def['body'])
         
         if not should_inline:
-            print(f"  ❌ Skipping {func_name}: {reason}")
+            log.debug("  ❌ Skipping %s: %s", func_name, reason)
             return call_node
         
-        print(f"  ✅ Inlining {func_name}: {reason}")
+        log.debug("  ✅ Inlining %s: %s", func_name, reason)
         
         # Track inlining statistics
         if func_name not in self.inline_stats:
@@ -3495,90 +4986,646 @@ class FunctionInliningPass:
     def _report_inlining_stats(self):
         """Report function inlining statistics"""
         if not self.inline_stats:
-            print("  No functions were inlined")
+            log.debug("  No functions were inlined")
             return
         
-        print(f"📈 Function Inlining Results:")
+        log.debug("📈 Function Inlining Results:")
         total_inlines = sum(self.inline_stats.values())
         for func_name, count in self.inline_stats.items():
             savings = count * 5  # Estimated instruction savings per inline
-            print(f"  {func_name}: {count} inlines, ~{savings} instructions saved")
+            log.debug("  %s: %s inlines, ~%s instructions saved", func_name, count, savings)
         
-        print(f"  Total: {total_inlines} function calls inlined")
-        print(f"  Estimated performance improvement: {total_inlines * 15}% faster execution")
+        log.debug("  Total: %s function calls inlined", total_inlines)
+        log.debug("  Estimated performance improvement: %s%% faster execution", total_inlines * 15)
     
     def optimize(self, ast):
         """Main optimization entry point"""
         return self.inline_function_calls(ast)
     
+    def run_on_module(self, program, analyses):
+        """PassManager entry point: inline across the whole program."""
+        return self.inline_function_calls(program)
+    
     def report(self):
         """Report optimization statistics"""
         if self.optimizations_applied > 0:
-            print(f"✅ Function Inlining: {self.optimizations_applied} optimizations applied")
+            log.info("✅ Function Inlining: %s optimizations applied", self.optimizations_applied)
         else:
-            print("ℹ️  Function Inlining: No optimizations applied")
+            log.info("ℹ️  Function Inlining: No optimizations applied")
 
-class OptimizationManager:
+# ============================================================================
+# PROGRAM ANALYSES AND PASS MANAGER
+# ============================================================================
+
+def variables_read(node: Optional[ASTNode], names: Optional[Set[str]] = None) -> Set[str]:
+    """Variables whose value an expression or statement reads (callee names excluded)."""
+    if names is None:
+        names = set()
+    if node is None:
+        return names
+    if isinstance(node, Identifier):
+        names.add(node.name)
+    elif isinstance(node, AssignmentExpression):
+        if node.operator != '=' or not isinstance(node.left, Identifier):
+            variables_read(node.left, names)
+        variables_read(node.right, names)
+    elif isinstance(node, CallExpression):
+        for argument in node.arguments:
+            variables_read(argument, names)
+    else:
+        for child in iter_child_nodes(node):
+            variables_read(child, names)
+    return names
+
+def variables_written(node: Optional[ASTNode], names: Optional[Set[str]] = None) -> Set[str]:
+    """Variables an expression or statement assigns, increments or decrements."""
+    if names is None:
+        names = set()
+    if node is None:
+        return names
+    if isinstance(node, AssignmentExpression) and isinstance(node.left, Identifier):
+        names.add(node.left.name)
+    elif (isinstance(node, UnaryExpression) and node.operator in ('++', '--', 'post++', 'post--')
+          and isinstance(node.operand, Identifier)):
+        names.add(node.operand.name)
+    for child in iter_child_nodes(node):
+        variables_written(child, names)
+    return names
+
+def is_side_effect_free(node: ASTNode) -> bool:
+    """True if evaluating node cannot call, assign or increment anything."""
+    if isinstance(node, (CallExpression, AssignmentExpression)):
+        return False
+    if isinstance(node, UnaryExpression) and node.operator in ('++', '--', 'post++', 'post--'):
+        return False
+    return all(is_side_effect_free(child) for child in iter_child_nodes(node))
+
+def declared_variables(node: ASTNode, names: Optional[List[str]] = None) -> List[str]:
+    """Names of all local declarations under node, with repeats for shadowing."""
+    if names is None:
+        names = []
+    if isinstance(node, VariableDeclaration):
+        names.append(node.name)
+    for child in iter_child_nodes(node):
+        declared_variables(child, names)
+    return names
+
+class ControlFlowGraph:
     """
-    Manages and orchestrates multiple optimization passes.
+    Statement-level control flow graph of one function.
     
-    Applies optimizations in the correct order:
-    1. Constant Folding (enables other optimizations)
-    2. Dead Code Elimination (removes unnecessary code)
-    3. Loop Optimization (optimizes control flow)
-    4. Peephole Optimization (assembly-level optimizations)
+    Nodes are simple statements, branch conditions (if, while and for), for
+    init/update expressions and returns; node 0 is the entry and the last
+    node the exit. statements[i] is the AST node evaluated at node i
+    (a statement, or the loop/if whose condition is evaluated).
     """
     
-    def __init__(self):
-        self.passes = [
-            FunctionInliningPass(),     # Phase 1: Function inlining (early)
-            ConstantFoldingPass(),      # Phase 2: Constant folding
-            DeadCodeEliminationPass(),  # Phase 3: Dead code elimination
-            LoopUnrollingPass(),        # Phase 4: Loop unrolling
-            PeepholeOptimizerPass()     # Phase 5: Assembly peephole
-        ]
-        self.total_optimizations = 0
+    def __init__(self, func: FunctionDeclaration):
+        self.statements = []   # AST node per graph node (None for entry/exit)
+        self.kinds = []        # 'entry', 'stmt', 'branch', 'init', 'update', 'return', 'exit'
+        self.successors = []
+        self.returns = []
+        entry = self.add('entry', None, [])
+        exits = self.build(func.body, [entry]) if func.body else [entry]
+        self.exit = self.add('exit', None, exits + self.returns)
+        self.predecessors = [[] for _ in self.statements]
+        for node, successors in enumerate(self.successors):
+            for successor in successors:
+                self.predecessors[successor].append(node)
+    
+    def add(self, kind: str, statement: Optional[ASTNode], predecessors: List[int]) -> int:
+        """Append a node reached from predecessors."""
+        index = len(self.statements)
+        self.statements.append(statement)
+        self.kinds.append(kind)
+        self.successors.append([])
+        for predecessor in predecessors:
+            self.successors[predecessor].append(index)
+        return index
+    
+    def build(self, node: ASTNode, predecessors: List[int]) -> List[int]:
+        """Add the nodes for a statement; returns the nodes that fall through."""
+        if isinstance(node, CompoundStatement):
+            for statement in node.statements:
+                predecessors = self.build(statement, predecessors)
+            return predecessors
+        if isinstance(node, IfStatement):
+            branch = self.add('branch', node, predecessors)
+            exits = self.build(node.then_statement, [branch])
+            if node.else_statement:
+                return exits + self.build(node.else_statement, [branch])
+            return exits + [branch]
+        if isinstance(node, WhileStatement):
+            branch = self.add('branch', node, predecessors)
+            for end in self.build(node.body, [branch]):
+                self.successors[end].append(branch)
+            return [branch]
+        if isinstance(node, ForStatement):
+            if node.init:
+                predecessors = [self.add('init', node, predecessors)]
+            branch = self.add('branch', node, predecessors)
+            ends = self.build(node.body, [branch])
+            if node.update:
+                ends = [self.add('update', node, ends)]
+            for end in ends:
+                self.successors[end].append(branch)
+            return [branch]
+        if isinstance(node, ReturnStatement):
+            self.returns.append(self.add('return', node, predecessors))
+            return []
+        return [self.add('stmt', node, predecessors)]
+    
+    def evaluated(self, index: int) -> Optional[ASTNode]:
+        """The expression or statement node i evaluates."""
+        kind, node = self.kinds[index], self.statements[index]
+        if kind == 'branch':
+            return node.condition
+        if kind == 'init':
+            return node.init
+        if kind == 'update':
+            return node.update
+        return node
+
+class Analysis:
+    """
+    A fact about one function (scope 'function') or the whole program
+    (scope 'module'), computed on demand and cached by AnalysisManager.
+    requires names the analyses compute() reads, so dropping one also
+    drops everything built on it.
+    """
+    name = ''
+    scope = 'function'
+    requires = ()
     
-    def optimize_ast(self, ast: Program) -> Program:
-        """Apply AST-level optimizations."""
-        print("🔧 Applying AST-level optimizations...")
-        
-        optimized_ast = ast
+    def compute(self, node: ASTNode, analyses: 'AnalysisManager') -> Any:
+        raise NotImplementedError
+
+class CallsAnalysis(Analysis):
+    """Call-site count per callee for one function."""
+    name = 'calls'
+    
+    def compute(self, func, analyses):
+        counts = {}
+        self.count(func.body, counts)
+        return counts
+    
+    def count(self, node: ASTNode, counts: Dict[str, int]):
+        if isinstance(node, CallExpression) and isinstance(node.function, Identifier):
+            counts[node.function.name] = counts.get(node.function.name, 0) + 1
+        for child in iter_child_nodes(node):
+            self.count(child, counts)
+
+class CallGraphAnalysis(Analysis):
+    """Call graph of all defined functions: name -> {callee: call sites}."""
+    name = 'callgraph'
+    scope = 'module'
+    requires = ('calls',)
+    
+    def compute(self, program, analyses):
+        return {name: analyses.get('calls', func) for name, func in analyses.functions.items()}
+
+class ConstantReturnAnalysis(Analysis):
+    """The integer a side-effect-free function always returns, or None (calls to it fold)."""
+    name = 'returns'
+    
+    def compute(self, func, analyses):
+        folder = EnhancedConstantPropagationPass()
+        return folder.get_constant_return_value(func) if folder.returns_constant(func) else None
+
+class CFGAnalysis(Analysis):
+    """Statement-level ControlFlowGraph."""
+    name = 'cfg'
+    
+    def compute(self, func, analyses):
+        return ControlFlowGraph(func)
+
+class Liveness:
+    """Variables live before and after each CFG node."""
+    
+    def __init__(self, cfg: ControlFlowGraph, live_in: List[Set[str]], live_out: List[Set[str]]):
+        self.cfg = cfg
+        self.live_in = live_in
+        self.live_out = live_out
+
+class LivenessAnalysis(Analysis):
+    """
+    Backward live-variable data flow over the statement-level CFG.
+    
+    Variables are tracked by name; declarations only kill a name when they
+    initialize it. Globals may be read by any call, so they are never dead.
+    """
+    name = 'liveness'
+    requires = ('cfg',)
+    
+    def compute(self, func, analyses):
+        cfg = analyses.get('cfg', func)
+        count = len(cfg.statements)
+        uses, defs = [], []
+        for index in range(count):
+            node = cfg.evaluated(index)
+            uses.append(variables_read(node))
+            if isinstance(node, VariableDeclaration):
+                defs.append({node.name} if node.initializer is not None else set())
+            else:
+                defs.append(variables_written(node) if cfg.kinds[index] != 'branch' else set())
         
-        # Apply multiple passes until no more optimizations
-        for pass_num in range(3):  # Maximum 3 iterations
-            initial_count = sum(p.optimizations_applied for p in self.passes[:3])
-            
-            for opt_pass in self.passes[:4]:  # Skip peephole pass for AST (now 4 AST passes)
-                optimized_ast = opt_pass.optimize(optimized_ast)
+        live_in = [set() for _ in range(count)]
+        live_out = [set() for _ in range(count)]
+        changed = True
+        while changed:
+            changed = False
+            for index in range(count - 1, -1, -1):
+                out = set()
+                for successor in cfg.successors[index]:
+                    out |= live_in[successor]
+                new_in = uses[index] | (out - defs[index])
+                if out != live_out[index] or new_in != live_in[index]:
+                    live_out[index], live_in[index] = out, new_in
+                    changed = True
+        return Liveness(cfg, live_in, live_out)
+
+ANALYSES = {analysis.name: analysis for analysis in
+            (CallsAnalysis(), CallGraphAnalysis(), ConstantReturnAnalysis(),
+             CFGAnalysis(), LivenessAnalysis())}
+
+class AnalysisManager:
+    """
+    Caches analysis results per function (or for the whole program) until a
+    pass changes the code they describe.
+    """
+    
+    def __init__(self, program: Program):
+        self.results = {}   # (analysis name, function name or None) -> result
+        self.sizes = {}     # Function name (None: program) -> AST node count
+        self.computed = 0
+        self.reused = 0
+        self.set_program(program)
+    
+    def set_program(self, program: Program):
+        """Point at a (possibly rebuilt) program after a module pass."""
+        self.program = program
+        self.functions = {d.name: d for d in program.declarations
+                          if isinstance(d, FunctionDeclaration) and d.body}
+    
+    def get(self, name: str, func: Optional[FunctionDeclaration] = None) -> Any:
+        """Return a cached result, computing it first if needed."""
+        analysis = ANALYSES[name]
+        key = (name, func.name if analysis.scope == 'function' else None)
+        if key in self.results:
+            self.reused += 1
+            return self.results[key]
+        
+        node = func if analysis.scope == 'function' else self.program
+        span_args = {}
+        if tracer.active:
+            span_args['nodes'] = self.size(node)
+            if analysis.scope == 'function':
+                span_args['function'] = func.name
+        with tracer.span(f"analysis {name}", "optimizer", **span_args):
+            result = analysis.compute(node, self)
+        self.results[key] = result
+        self.computed += 1
+        return result
+    
+    def size(self, node: Union[Program, FunctionDeclaration]) -> int:
+        """AST node count of a function or the program (span statistics)."""
+        key = node.name if isinstance(node, FunctionDeclaration) else None
+        if key not in self.sizes:
+            self.sizes[key] = count_nodes(node)
+        return self.sizes[key]
+    
+    def invalidate(self, func: Optional[FunctionDeclaration], preserved=()):
+        """
+        Drop results a change may have made stale: func's own analyses and
+        every module analysis (func None means any function may have changed),
+        except the preserved ones and anything they do not depend on.
+        """
+        preserved = set(preserved)
+        shrinking = True
+        while shrinking:  # An analysis is only preserved if what it is built on is
+            kept = {name for name in preserved if set(ANALYSES[name].requires) <= preserved}
+            shrinking = kept != preserved
+            preserved = kept
+        for key in list(self.results):
+            name, owner = key
+            if name not in preserved and (func is None or owner is None or owner == func.name):
+                del self.results[key]
+        for owner in list(self.sizes):
+            if func is None or owner is None or owner == func.name:
+                del self.sizes[owner]
+    
+    def callee_first_order(self) -> List[FunctionDeclaration]:
+        """Defined functions in post-order over the call graph (callees before callers)."""
+        call_graph = self.get('callgraph')
+        order, visited = [], set()
+        
+        def visit(name):
+            visited.add(name)
+            for callee in call_graph.get(name, {}):
+                if callee not in visited and callee in self.functions:
+                    visit(callee)
+            order.append(self.functions[name])
+        
+        for name in self.functions:
+            if name not in visited:
+                visit(name)
+        return order
+    
+    def acyclic_functions(self) -> Set[str]:
+        """Defined functions that neither recurse nor call anything that does."""
+        call_graph = self.get('callgraph')
+        state = {}  # Name -> True (acyclic), False (reaches a cycle) or None (on the stack)
+        
+        def visit(name):
+            if name in state:
+                return bool(state[name])
+            state[name] = None
+            acyclic = True
+            for callee in call_graph.get(name, {}):
+                if callee in self.functions and not visit(callee):
+                    acyclic = False
+            state[name] = acyclic
+            return acyclic
+        
+        return {name for name in self.functions if visit(name)}
+
+class PassManager:
+    """
+    Runs an optimization pipeline over a program.
+    
+    Module passes see the whole program. Consecutive function passes form
+    a group that is applied to one function at a time from a worklist,
+    callees first, and reapplied to that function only while it keeps
+    changing. When a function's constant return value changes, callers
+    already processed are queued again. Before a pass runs, the analyses
+    it requires are computed (or taken from the cache); after every change
+    the analyses the pass does not preserve are invalidated.
+    
+    With a function_cache (IncrementalCompiler), a function outside any
+    call cycle is visited exactly once, after its callees have settled, so
+    the group's result is looked up by what the function can see instead
+    of being recomputed.
+    """
+    
+    def __init__(self, passes: List[OptimizationPass], max_iterations: int = 3,
+                 function_cache: Optional['IncrementalCompiler'] = None):
+        for opt_pass in passes:
+            unknown = [name for name in opt_pass.requires if name not in ANALYSES]
+            if unknown:
+                raise ValueError(f"{type(opt_pass).__name__} requires unknown analyses: "
+                                 f"{', '.join(unknown)}")
+        self.passes = passes
+        self.max_iterations = max_iterations
+        self.function_cache = function_cache
+        self.analyses = None
+    
+    def groups(self):
+        """Yield ('module', pass) and ('function', [passes]) in pipeline order."""
+        group = []
+        for opt_pass in self.passes:
+            if opt_pass.scope == 'function':
+                group.append(opt_pass)
+                continue
+            if group:
+                yield 'function', group
+                group = []
+            if opt_pass.scope == 'module':
+                yield 'module', opt_pass
+        if group:
+            yield 'function', group
+    
+    def run(self, program: Program) -> Program:
+        """Optimize program and return the result."""
+        self.analyses = AnalysisManager(program)
+        group = 0
+        for scope, item in self.groups():
+            if scope == 'module':
+                program = self.run_module_pass(item, program)
+            else:
+                self.run_function_passes(item, group)
+                group += 1
+        log.debug("   📐 Analyses: %s computed, %s reused from cache",
+                  self.analyses.computed, self.analyses.reused)
+        return program
+    
+    def prepare(self, opt_pass, func: Optional[FunctionDeclaration] = None):
+        """Compute the analyses opt_pass requires (module analyses, and func's own)."""
+        for name in opt_pass.requires:
+            if ANALYSES[name].scope == 'module':
+                self.analyses.get(name)
+            elif func is not None:
+                self.analyses.get(name, func)
+            else:
+                for each in self.analyses.functions.values():
+                    self.analyses.get(name, each)
+    
+    def run_module_pass(self, opt_pass, program: Program) -> Program:
+        """Run one module pass and invalidate what it changed."""
+        self.prepare(opt_pass)
+        before = opt_pass.optimizations_applied
+        span_args = {'nodes': self.analyses.size(program)} if tracer.active else {}
+        with tracer.span(type(opt_pass).__name__, "optimizer", **span_args) as span:
+            program = opt_pass.run_on_module(program, self.analyses)
+            span.set(optimizations=opt_pass.optimizations_applied - before)
+        if opt_pass.optimizations_applied != before:
+            self.analyses.set_program(program)
+            self.analyses.invalidate(None, opt_pass.preserves)
+        return program
+    
+    def run_function_passes(self, passes: List[OptimizationPass], group: int = 0):
+        """Apply a group of function passes to every function until each settles."""
+        from collections import deque
+        
+        analyses = self.analyses
+        cacheable = analyses.acyclic_functions() if self.function_cache else set()
+        worklist = deque(analyses.callee_first_order())
+        queued = {func.name for func in worklist}
+        done = set()
+        rounds = {}
+        while worklist:
+            func = worklist.popleft()
+            queued.discard(func.name)
+            remarks.function = func.name
+            old_return = analyses.get('returns', func)
             
-            final_count = sum(p.optimizations_applied for p in self.passes[:4])
+            key = cached = None
+            if func.name in cacheable:
+                key, cached = self.function_cache.lookup_optimized(func, group, analyses)
+            if cached is not None:
+                func.body = cached.body
+                analyses.invalidate(func)
+            else:
+                self.optimize_function(func, passes)
+                if key is not None:
+                    self.function_cache.store_optimized(key, func)
+            done.add(func.name)
             
-            if final_count == initial_count:
-                break  # No more optimizations possible
+            # Callers folded the old constant return value; revisit them
+            rounds[func.name] = rounds.get(func.name, 0) + 1
+            if analyses.get('returns', func) != old_return:
+                call_graph = analyses.get('callgraph')
+                for caller, callees in call_graph.items():
+                    if (func.name in callees and caller in done and caller not in queued
+                            and rounds.get(caller, 0) < self.max_iterations):
+                        worklist.append(analyses.functions[caller])
+                        queued.add(caller)
+        remarks.function = None
+    
+    def optimize_function(self, func: FunctionDeclaration, passes: List[OptimizationPass]):
+        """Reapply a group of function passes to func while any of them changes it."""
+        analyses = self.analyses
+        for _ in range(self.max_iterations):
+            changed = False
+            for opt_pass in passes:
+                self.prepare(opt_pass, func)
+                before = opt_pass.optimizations_applied
+                span_args = {'nodes': analyses.size(func)} if tracer.active else {}
+                with tracer.span(type(opt_pass).__name__, "optimizer",
+                                 function=func.name, **span_args) as span:
+                    opt_pass.run_on_function(func, analyses)
+                    span.set(optimizations=opt_pass.optimizations_applied - before)
+                if opt_pass.optimizations_applied != before:
+                    changed = True
+                    analyses.invalidate(func, opt_pass.preserves)
+            if not changed:
+                break
+
+# Pass name -> (class, {option name: pass attribute}) for pipelines and --passes
+OPTIMIZATION_PASSES = {
+    'inline':    (FunctionInliningPass, {'threshold': 'inline_threshold'}),
+    'constprop': (ConstantFoldingPass, {}),
+    'dce':       (DeadCodeEliminationPass, {}),
+    'dse':       (DeadStoreEliminationPass, {}),
+    'unswitch':  (LoopUnswitchingPass, {'size': 'max_loop_size',
+                                        'expansion': 'max_code_expansion'}),
+    'fuse':      (LoopFusionPass, {}),
+    'unroll':    (LoopUnrollingPass, {'factor': 'max_unroll_factor',
+                                      'expansion': 'max_code_expansion'}),
+    'globaldce': (DeadFunctionEliminationPass, {}),
+    'peephole':  (PeepholeOptimizerPass, {}),
+}
+
+OPTIMIZATION_PIPELINES = {
+    'O0': "",
+    'O1': "constprop,dce,globaldce,peephole",
+    'O2': "constprop,dce,dse,unswitch,fuse,unroll,globaldce,peephole",
+    'O3': "constprop,dce,dse,unswitch(size=120),fuse,unroll(factor=16),constprop,dce,globaldce,peephole",
+    'Os': "constprop,dce,dse,fuse,globaldce,peephole",
+}
+
+def parse_pipeline(text: str) -> List[Tuple[str, Dict[str, int]]]:
+    """Parse 'name,name(option=N,...),...' into (pass name, options) pairs."""
+    import re
+    
+    pipeline = []
+    for match in re.finditer(r'\s*([\w-]+)\s*(?:\(([^)]*)\))?\s*(?:,|$)', text.strip()):
+        if not match.group(1):
+            continue
+        name, option_text = match.group(1), match.group(2)
+        if name not in OPTIMIZATION_PASSES:
+            raise ValueError(f"unknown pass '{name}' (known: {', '.join(OPTIMIZATION_PASSES)})")
+        options = {}
+        for item in filter(None, (option_text or "").split(',')):
+            key, _, value = item.partition('=')
+            key = key.strip()
+            if key not in OPTIMIZATION_PASSES[name][1]:
+                raise ValueError(f"pass '{name}' has no option '{key}'")
+            options[key] = int(value)
+        pipeline.append((name, options))
+    return pipeline
+
+class OptimizationManager:
+    """
+    Builds the optimization pipeline for an -O level (or --passes) and runs it.
+    
+    AST passes run through a PassManager; the peephole pass runs on the
+    generated assembly if the pipeline includes it. Pass instances persist
+    across programs, so statistics accumulate per compiler.
+    """
+    
+    def __init__(self, level: int = 1):
+        self.pipeline = []         # (pass name, options) pairs
+        self.passes = []           # Pass instances in pipeline order
+        self.peephole = None       # PeepholeOptimizerPass when enabled
+        self.whole_program = True
+        self.total_optimizations = 0
+        self.set_optimization_level(level)
+    
+    def set_optimization_level(self, level: Union[int, str]):
+        """Select the standard pipeline for -O0..-O3 or -Os ('s')."""
+        self.set_pipeline(OPTIMIZATION_PIPELINES[f"O{level}"])
+    
+    def set_pipeline(self, text: str):
+        """Use an explicit pass list such as 'constprop,dce,unroll(factor=4)'."""
+        self.pipeline = parse_pipeline(text)
+        self.passes = []
+        for name, options in self.pipeline:
+            pass_class, attributes = OPTIMIZATION_PASSES[name]
+            opt_pass = pass_class()
+            opt_pass.pipeline_name = name  # Pass id in remarks
+            for key, value in options.items():
+                setattr(opt_pass, attributes[key], value)
+            self.passes.append(opt_pass)
+        self.peephole = next((p for p in self.passes if p.scope == 'assembly'), None)
+        self.set_whole_program(self.whole_program)
+    
+    def pipeline_text(self) -> str:
+        """Canonical pipeline description (part of cache keys)."""
+        return ",".join(name + (f"({','.join(f'{k}={v}' for k, v in sorted(options.items()))})"
+                                if options else "")
+                        for name, options in self.pipeline)
+    
+    def has_ast_passes(self) -> bool:
+        """True if the pipeline does anything before code generation."""
+        return any(p.scope != 'assembly' for p in self.passes)
+    
+    def set_whole_program(self, enabled: bool):
+        """Allow removal of functions no other code in this unit calls."""
+        self.whole_program = enabled
+        for opt_pass in self.passes:
+            if isinstance(opt_pass, DeadFunctionEliminationPass):
+                opt_pass.remove_unused_functions = enabled
+    
+    def optimize_ast(self, ast: Program,
+                     function_cache: Optional['IncrementalCompiler'] = None) -> Program:
+        """Apply AST-level optimizations (reusing cached functions if given a function_cache)."""
+        log.info("🔧 Applying AST-level optimizations...")
+        
+        ast_passes = [p for p in self.passes if p.scope != 'assembly']
+        manager = PassManager(ast_passes, function_cache=function_cache)
+        with tracer.span("optimize"):
+            optimized_ast = manager.run(ast)
+        if tracer.enabled:
+            tracer.counter("optimizations applied",
+                           total=sum(p.optimizations_applied for p in ast_passes))
         
         # Report results
-        for opt_pass in self.passes[:4]:
+        for opt_pass in ast_passes:
             opt_pass.report()
         
-        self.total_optimizations = sum(p.optimizations_applied for p in self.passes[:4])
-        print(f"   Total AST optimizations: {self.total_optimizations}")
+        self.total_optimizations = sum(p.optimizations_applied for p in ast_passes)
+        log.info("   Total AST optimizations: %s", self.total_optimizations)
         
         return optimized_ast
     
     def optimize_assembly(self, assembly_code: str) -> str:
         """Apply assembly-level optimizations."""
-        print("🔧 Applying assembly-level optimizations...")
+        if not self.peephole:
+            return assembly_code
+        log.info("🔧 Applying assembly-level optimizations...")
         
         # Apply peephole optimizations
-        peephole_pass = self.passes[4]  # PeepholeOptimizerPass (now at index 4)
-        optimized_assembly = peephole_pass.optimize_assembly(assembly_code)
+        peephole_pass = self.peephole
+        before = peephole_pass.optimizations_applied
+        with tracer.span("peephole", "optimizer", lines=assembly_code.count('\n') + 1) as span:
+            optimized_assembly = peephole_pass.optimize_assembly(assembly_code)
+            span.set(optimizations=peephole_pass.optimizations_applied - before)
         
         peephole_pass.report()
         assembly_optimizations = peephole_pass.optimizations_applied
         
-        print(f"   Total assembly optimizations: {assembly_optimizations}")
-        print(f"   Overall optimizations applied: {self.total_optimizations + assembly_optimizations}")
+        log.info("   Total assembly optimizations: %s", assembly_optimizations)
+        log.info("   Overall optimizations applied: %s", self.total_optimizations + assembly_optimizations)
         
         return optimized_assembly
 
@@ -3603,7 +5650,7 @@ class LiveInterval:
         """Check if this interval overlaps with another."""
         return not (self.end < other.start or other.end < self.start)
 
-class LiveVariableAnalysis:
+class LiveVariableAnalysis(NodeVisitor):
     """
     Performs live variable analysis to determine variable lifetimes.
     
@@ -3625,7 +5672,7 @@ class LiveVariableAnalysis:
     
     def analyze_function(self, function_ast: FunctionDeclaration) -> Dict[str, LiveInterval]:
         """Analyze live variables for a function and compute intervals."""
-        print(f"   🔍 Analyzing live variables for: {function_ast.name}")
+        log.debug("   🔍 Analyzing live variables for: %s", function_ast.name)
         
         # Step 1: Extract instructions and build CFG
         self.extract_instructions(function_ast.body)
@@ -3639,9 +5686,10 @@ class LiveVariableAnalysis:
         # Step 4: Compute live intervals
         self.compute_live_intervals()
         
-        print(f"      Found {len(self.variable_intervals)} variables with live intervals")
-        for var, interval in self.variable_intervals.items():
-            print(f"      {interval}")
+        log.debug("      Found %s variables with live intervals", len(self.variable_intervals))
+        if log.enabled(LogLevel.TRACE):
+            for var, interval in self.variable_intervals.items():
+                log.trace("      %s", interval)
         
         return self.variable_intervals
     
@@ -3652,60 +5700,72 @@ class LiveVariableAnalysis:
     
     def _extract_recursive(self, node: ASTNode, inst_id: int) -> int:
         """Recursively extract instructions from AST nodes."""
-        if isinstance(node, CompoundStatement):
-            for stmt in node.statements:
-                inst_id = self._extract_recursive(stmt, inst_id)
-        
-        elif isinstance(node, VariableDeclaration):
-            # Variable definition
-            self.instructions.append(('def', inst_id, node.name, node.initializer))
-            inst_id += 1
-        
-        elif isinstance(node, AssignmentExpression):
-            # Assignment: use RHS, then def LHS
-            if isinstance(node.left, Identifier):
-                self.instructions.append(('assign', inst_id, node.left.name, node.right))
-                inst_id += 1
-        
-        elif isinstance(node, BinaryExpression):
-            # Binary operation: use both operands
-            self.instructions.append(('binop', inst_id, node.operator, node.left, node.right))
-            inst_id += 1
-        
-        elif isinstance(node, CallExpression):
-            # Function call: use all arguments
-            if isinstance(node.function, Identifier):
-                self.instructions.append(('call', inst_id, node.function.name, node.arguments))
-                inst_id += 1
-        
-        elif isinstance(node, ReturnStatement):
-            # Return: use return value
-            self.instructions.append(('return', inst_id, node.expression))
+        handler = self.dispatch_tables['instructions'].get(node.__class__)
+        return handler(self, node, inst_id) if handler else inst_id
+    
+    @handles('instructions', CompoundStatement)
+    def _extract_compound(self, node: CompoundStatement, inst_id: int) -> int:
+        for stmt in node.statements:
+            inst_id = self._extract_recursive(stmt, inst_id)
+        return inst_id
+    
+    @handles('instructions', VariableDeclaration)
+    def _extract_declaration(self, node: VariableDeclaration, inst_id: int) -> int:
+        # Variable definition
+        self.instructions.append(('def', inst_id, node.name, node.initializer))
+        return inst_id + 1
+    
+    @handles('instructions', AssignmentExpression)
+    def _extract_assignment(self, node: AssignmentExpression, inst_id: int) -> int:
+        # Assignment: use RHS, then def LHS
+        if isinstance(node.left, Identifier):
+            self.instructions.append(('assign', inst_id, node.left.name, node.right))
             inst_id += 1
-        
-        elif isinstance(node, IfStatement):
-            # Conditional: use condition, then branches
-            self.instructions.append(('cond', inst_id, node.condition))
-            cond_id = inst_id
+        return inst_id
+    
+    @handles('instructions', BinaryExpression)
+    def _extract_binary(self, node: BinaryExpression, inst_id: int) -> int:
+        # Binary operation: use both operands
+        self.instructions.append(('binop', inst_id, node.operator, node.left, node.right))
+        return inst_id + 1
+    
+    @handles('instructions', CallExpression)
+    def _extract_call(self, node: CallExpression, inst_id: int) -> int:
+        # Function call: use all arguments
+        if isinstance(node.function, Identifier):
+            self.instructions.append(('call', inst_id, node.function.name, node.arguments))
             inst_id += 1
-            
-            then_start = inst_id
-            inst_id = self._extract_recursive(node.then_statement, inst_id)
-            then_end = inst_id - 1
-            
-            if node.else_statement:
-                else_start = inst_id
-                inst_id = self._extract_recursive(node.else_statement, inst_id)
-                else_end = inst_id - 1
-                # Set up control flow
-                self.successors[cond_id] = [then_start, else_start]
-            else:
-                self.successors[cond_id] = [then_start, inst_id]
+        return inst_id
+    
+    @handles('instructions', ReturnStatement)
+    def _extract_return(self, node: ReturnStatement, inst_id: int) -> int:
+        # Return: use return value
+        self.instructions.append(('return', inst_id, node.expression))
+        return inst_id + 1
+    
+    @handles('instructions', IfStatement)
+    def _extract_if(self, node: IfStatement, inst_id: int) -> int:
+        # Conditional: use condition, then branches
+        self.instructions.append(('cond', inst_id, node.condition))
+        cond_id = inst_id
+        inst_id += 1
         
-        elif isinstance(node, ExpressionStatement):
-            if node.expression:
-                inst_id = self._extract_recursive(node.expression, inst_id)
+        then_start = inst_id
+        inst_id = self._extract_recursive(node.then_statement, inst_id)
         
+        if node.else_statement:
+            else_start = inst_id
+            inst_id = self._extract_recursive(node.else_statement, inst_id)
+            # Set up control flow
+            self.successors[cond_id] = [then_start, else_start]
+        else:
+            self.successors[cond_id] = [then_start, inst_id]
+        return inst_id
+    
+    @handles('instructions', ExpressionStatement)
+    def _extract_expression_statement(self, node: ExpressionStatement, inst_id: int) -> int:
+        if node.expression:
+            inst_id = self._extract_recursive(node.expression, inst_id)
         return inst_id
     
     def compute_def_use_sets(self):
@@ -3758,23 +5818,32 @@ class LiveVariableAnalysis:
     def _get_variables_used(self, expr: ASTNode) -> Set[str]:
         """Extract all variable names used in an expression."""
         variables = set()
-        
-        if isinstance(expr, Identifier):
-            variables.add(expr.name)
-        elif isinstance(expr, BinaryExpression):
-            variables.update(self._get_variables_used(expr.left))
-            variables.update(self._get_variables_used(expr.right))
-        elif isinstance(expr, UnaryExpression):
-            variables.update(self._get_variables_used(expr.operand))
-        elif isinstance(expr, CallExpression):
-            for arg in expr.arguments:
-                variables.update(self._get_variables_used(arg))
-        elif isinstance(expr, AssignmentExpression):
-            variables.update(self._get_variables_used(expr.left))
-            variables.update(self._get_variables_used(expr.right))
-        
+        self._collect_uses(expr, variables)
         return variables
     
+    def _collect_uses(self, expr: ASTNode, variables: Set[str]):
+        handler = self.dispatch_tables['uses'].get(expr.__class__)
+        if handler:
+            handler(self, expr, variables)
+    
+    @handles('uses', Identifier)
+    def _use_identifier(self, expr: Identifier, variables: Set[str]):
+        variables.add(expr.name)
+    
+    @handles('uses', BinaryExpression, AssignmentExpression)
+    def _use_operands(self, expr: ASTNode, variables: Set[str]):
+        self._collect_uses(expr.left, variables)
+        self._collect_uses(expr.right, variables)
+    
+    @handles('uses', UnaryExpression)
+    def _use_operand(self, expr: UnaryExpression, variables: Set[str]):
+        self._collect_uses(expr.operand, variables)
+    
+    @handles('uses', CallExpression)
+    def _use_arguments(self, expr: CallExpression, variables: Set[str]):
+        for arg in expr.arguments:
+            self._collect_uses(arg, variables)
+    
     def compute_liveness(self):
         """Compute live_in and live_out sets using backward dataflow analysis."""
         # Initialize all sets to empty
@@ -3815,7 +5884,7 @@ class LiveVariableAnalysis:
                     old_live_out != self.live_out[i]):
                     changed = True
         
-        print(f"      Liveness analysis converged in {iterations} iterations")
+        log.debug("      Liveness analysis converged in %s iterations", iterations)
     
     def compute_live_intervals(self):
         """Compute live intervals for each variable."""
@@ -3823,15 +5892,17 @@ class LiveVariableAnalysis:
         first_use = {}
         last_use = {}
         
+        # Sets are visited in name order so equal start points tie-break the same
+        # way in every process (string hashes are salted per interpreter)
         for i in range(len(self.instructions)):
             # Variables in live_in are live at this point
-            for var in self.live_in[i]:
+            for var in sorted(self.live_in[i]):
                 if var not in first_use:
                     first_use[var] = i
                 last_use[var] = i
             
             # Variables in live_out are live after this point
-            for var in self.live_out[i]:
+            for var in sorted(self.live_out[i]):
                 if var not in first_use:
                     first_use[var] = i
                 last_use[var] = i
@@ -3887,14 +5958,14 @@ class AdvancedRegisterAllocator:
         
         Returns mapping from variable names to register names or stack locations.
         """
-        print(f"   🎯 Performing register allocation for: {function_ast.name}")
+        log.debug("   🎯 Performing register allocation for: %s", function_ast.name)
         
         # Step 1: Perform live variable analysis
         liveness_analyzer = LiveVariableAnalysis()
         live_intervals = liveness_analyzer.analyze_function(function_ast)
         
         if not live_intervals:
-            print("      No variables to allocate")
+            log.debug("      No variables to allocate")
             return {}
         
         # Step 2: Sort intervals by start point (linear scan requirement)
@@ -3914,15 +5985,16 @@ class AdvancedRegisterAllocator:
         self.registers_used = len(set(allocation_map.values()) - {'spilled'})
         self.variables_spilled = sum(1 for v in allocation_map.values() if v == 'spilled')
         
-        print(f"      ✅ Allocated {self.total_variables} variables:")
-        print(f"         📊 {self.registers_used} in registers, {self.variables_spilled} spilled")
+        log.debug("      ✅ Allocated %s variables:", self.total_variables)
+        log.debug("         📊 %s in registers, %s spilled", self.registers_used, self.variables_spilled)
         
-        for var, location in allocation_map.items():
-            if location != 'spilled':
-                print(f"         {var} → %{location}")
-            else:
-                offset = self.spilled_variables[var]
-                print(f"         {var} → {offset}(%rbp) [spilled]")
+        if log.enabled(LogLevel.TRACE):
+            for var, location in allocation_map.items():
+                if location != 'spilled':
+                    log.trace("         %s → %%%s", var, location)
+                else:
+                    offset = self.spilled_variables[var]
+                    log.trace("         %s → %s(%%rbp) [spilled]", var, offset)
         
         return allocation_map
     
@@ -3932,7 +6004,7 @@ class AdvancedRegisterAllocator:
             if i < len(self.param_registers):
                 reg = self.param_registers[i]
                 self.register_assignments[param.name] = reg
-                print(f"         Parameter {param.name} → %{reg}")
+                log.trace("         Parameter %s → %%%s", param.name, reg)
     
     def _linear_scan_allocation(self, intervals: List[LiveInterval]):
         """
@@ -4280,194 +6352,4612 @@ class Lexer:
         return self.tokens
 
 # ============================================================================
-# MAIN COMPILER CLASS
+# BYTECODE VIRTUAL MACHINE
 # ============================================================================
 
-class CCompiler:
-    """Main C Compiler class coordinating all compilation phases."""
+# Register-based bytecode opcodes. Every instruction is a 4-tuple
+# (opcode, a, b, c) so the dispatch loop can unpack it without branching.
+OP_MOV = 0          # r[a] = r[b]
+OP_LOADK = 1        # r[a] = constant b
+OP_LOADG = 2        # r[a] = globals[b]
+OP_STOREG = 3       # globals[a] = r[b]
+OP_ADD = 4          # r[a] = r[b] + r[c]
+OP_SUB = 5          # r[a] = r[b] - r[c]
+OP_MUL = 6          # r[a] = r[b] * r[c]
+OP_DIV = 7          # r[a] = r[b] / r[c] (C semantics)
+OP_MOD = 8          # r[a] = r[b] % r[c] (C semantics)
+OP_ADDK = 9         # r[a] = r[b] + constant c
+OP_LT = 10          # r[a] = r[b] < r[c]
+OP_GT = 11
+OP_LE = 12
+OP_EQ = 13
+OP_NE = 14
+OP_GE = 15
+OP_NEG = 16         # r[a] = -r[b]
+OP_NOT = 17         # r[a] = !r[b]
+OP_JMP = 18         # pc = a
+OP_JZ = 19          # if !r[a]: pc = b
+OP_JNZ = 20         # if r[a]: pc = b
+OP_CALL = 21        # r[a] = functions[b](r[c] .. r[c + nparams - 1])
+OP_PRINTF = 22      # r[a] = printf(r[b] .. r[b + c - 1])
+OP_RET = 23         # return r[a]
+OP_RETK = 24        # return constant a
+
+# Superinstructions
+OP_INCL = 25        # r[a] += constant b            (i++, i += k, i = i + k)
+OP_JNLT = 26        # if not r[a] <  r[b]: pc = c   (compare-and-branch)
+OP_JNGT = 27
+OP_JNLE = 28
+OP_JNEQ = 29
+OP_JNNE = 30
+OP_JNGE = 31
+OP_JNLTK = 32       # if not r[a] <  constant b: pc = c
+OP_JNGTK = 33
+OP_JNLEK = 34
+OP_JNEQK = 35
+OP_JNNEK = 36
+OP_JNGEK = 37
+
+OPCODE_NAMES = {value: name[3:] for name, value in list(globals().items())
+                if name.startswith('OP_') and isinstance(value, int)}
+
+# Comparison operator -> (value opcode, compare-and-branch opcode, immediate variant)
+COMPARISON_OPCODES = {
+    '<': (OP_LT, OP_JNLT, OP_JNLTK),
+    '>': (OP_GT, OP_JNGT, OP_JNGTK),
+    '<=': (OP_LE, OP_JNLE, OP_JNLEK),
+    '==': (OP_EQ, OP_JNEQ, OP_JNEQK),
+    '!=': (OP_NE, OP_JNNE, OP_JNNEK),
+    '>=': (OP_GE, OP_JNGE, OP_JNGEK),
+}
+
+# Swapped form used when the constant is on the left (3 < i  ->  i > 3)
+SWAPPED_COMPARISONS = {'<': '>', '>': '<', '<=': '>=', '>=': '<=', '==': '==', '!=': '!='}
+
+ARITHMETIC_OPCODES = {'+': OP_ADD, '-': OP_SUB, '*': OP_MUL, '/': OP_DIV, '%': OP_MOD}
+
+INT_MIN = -2147483648
+INT_MAX = 2147483647
+
+def wrap_int32(value: int) -> int:
+    """Wrap an integer to 32-bit two's complement, like C int arithmetic."""
+    return ((value + 2147483648) & 0xFFFFFFFF) - 2147483648
+
+def c_divide(left, right):
+    """Divide with C semantics (truncation toward zero for integers)."""
+    if type(left) is int and type(right) is int:
+        if right == 0:
+            raise VMError("division by zero")
+        quotient = abs(left) // abs(right)
+        return wrap_int32(-quotient if (left < 0) != (right < 0) else quotient)
+    return left / right
+
+def c_modulo(left, right):
+    """Remainder with C semantics (sign follows the dividend)."""
+    if type(left) is int and type(right) is int:
+        if right == 0:
+            raise VMError("division by zero")
+        remainder = abs(left) % abs(right)
+        return -remainder if left < 0 else remainder
+    import math
+    return math.fmod(left, right)
+
+def c_printf(format_string, arguments: List) -> str:
+    """Format a C printf call using Python %-formatting."""
+    # Strip length modifiers Python does not understand (%ld, %lld, %hd, %zu)
+    converted = re.sub(r'%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z)?([diouxXcsfeEgG%])',
+                       lambda m: '%' + m.group(1) + ('d' if m.group(2) == 'u' else m.group(2)),
+                       format_string)
+    values = []
+    for spec, value in zip(re.findall(r'%[-+ #0]*\d*(?:\.\d+)?([diouxXcsfeEgG])', converted), arguments):
+        if spec in 'dioxX' and isinstance(value, float):
+            value = int(value)
+        values.append(value)
+    try:
+        return converted % tuple(values)
+    except (TypeError, ValueError) as e:
+        raise VMError(f"printf format error: {e}")
+
+class VMError(Exception):
+    """Exception raised when bytecode lowering or execution fails."""
+    pass
+
+class BytecodeFunction:
+    """A lowered function: flat instruction list plus its register frame size."""
+    def __init__(self, name: str, num_params: int):
+        self.name = name
+        self.num_params = num_params
+        self.num_registers = num_params
+        self.code = []              # List of (opcode, a, b, c) tuples
+        self.register_names = {}    # Register index -> variable name (for disassembly)
+    
+    def disassemble(self) -> str:
+        """Return a human readable listing of the function's bytecode."""
+        lines = [f"{self.name}: {self.num_params} params, {self.num_registers} registers"]
+        for pc, (op, a, b, c) in enumerate(self.code):
+            lines.append(f"  {pc:4d}  {OPCODE_NAMES[op]:<8} {a!r:>6} {b!r:>6} {c!r:>6}")
+        return "\n".join(lines)
+
+class BytecodeCompiler:
+    """
+    Lowers an (optimized) AST into register-based bytecode.
+    
+    Each local variable and parameter owns a fixed register in its function's
+    frame; expression temporaries are allocated above the locals with a simple
+    stack discipline and released after every statement. Common patterns are
+    fused into superinstructions:
+    - Compare-and-branch for loop and if conditions (JNLT, JNLTK, ...)
+    - Increment-local for i++, i += k and i = i + k (INCL)
+    - Add-immediate for x + k (ADDK)
+    """
     
     def __init__(self):
-        self.lexer = None
-        self.parser = None
-        self.semantic_analyzer = None
-        self.code_generator = CodeGenerator()
-        self.optimizer = OptimizationManager()
-        self.optimization_level = 1  # Default optimization level
+        self.functions = []         # BytecodeFunction list (index = call target)
+        self.function_index = {}    # Function name -> index in self.functions
+        self.global_index = {}      # Global variable name -> slot
+        self.global_initializers = []  # (slot, initializer AST)
+        
+        # Per-function lowering state
+        self.current = None
+        self.scopes = []
+        self.next_register = 0
+        self.superinstructions = 0
+    
+    def compile_program(self, program: Program) -> 'BytecodeModule':
+        """Lower every function and global of the program into a module."""
+        for decl in program.declarations:
+            if isinstance(decl, VariableDeclaration) and decl.name not in self.global_index:
+                self.global_index[decl.name] = len(self.global_index)
+                self.global_initializers.append((self.global_index[decl.name], decl.initializer))
+            elif isinstance(decl, FunctionDeclaration) and decl.body:
+                if decl.name not in self.function_index:
+                    self.function_index[decl.name] = len(self.functions)
+                    self.functions.append(BytecodeFunction(decl.name, len(decl.parameters)))
+        
+        for decl in program.declarations:
+            if isinstance(decl, FunctionDeclaration) and decl.body:
+                self.compile_function(decl)
+        
+        # Global initializers run in a synthetic function before main
+        init_function = BytecodeFunction("__init_globals", 0)
+        self._begin_function(init_function, [])
+        for slot, initializer in self.global_initializers:
+            if initializer is not None:
+                reg = self.compile_expression(initializer)
+                self.emit(OP_STOREG, slot, reg)
+                self._release_temporaries(0)
+        self.emit(OP_RETK, 0)
+        self._finish_function()
+        
+        return BytecodeModule(self.functions, self.function_index, len(self.global_index),
+                              init_function, self.superinstructions)
     
-    def set_optimization_level(self, level: int):
-        """Set optimization level (0=none, 1=basic, 2=aggressive)."""
-        self.optimization_level = level
+    # ========================================================================
+    # FUNCTION AND SCOPE MANAGEMENT
+    # ========================================================================
     
-    def _format_ast_node(self, node: ASTNode, max_length: int = 80) -> str:
-        """Format AST node for readable debugging output."""
-        if isinstance(node, FunctionDeclaration):
-            param_str = f"({len(node.parameters)} params)" if node.parameters else "()"
-            body_str = "with body" if node.body else "declaration only"
-            return f"{node.return_type} {node.name}{param_str} {body_str}"
-        elif isinstance(node, VariableDeclaration):
-            init_str = "with initializer" if node.initializer else "no initializer"
-            return f"{node.type} {node.name} ({init_str})"
-        elif isinstance(node, BinaryExpression):
-            return f"({self._format_ast_node(node.left, 20)} {node.operator} {self._format_ast_node(node.right, 20)})"
-        elif isinstance(node, Identifier):
-            return node.name
-        elif isinstance(node, IntegerLiteral):
-            return str(node.value)
-        elif isinstance(node, StringLiteral):
-            return f'"{node.value}"'
+    def _begin_function(self, function: BytecodeFunction, parameters: List[Parameter]):
+        self.current = function
+        self.scopes = [{}]
+        self.next_register = 0
+        for param in parameters:
+            self._declare_local(param.name)
+    
+    def _finish_function(self):
+        self.current.num_registers = max(self.current.num_registers, self.next_register, 1)
+        self.current = None
+    
+    def compile_function(self, node: FunctionDeclaration):
+        """Lower a single function definition."""
+        function = self.functions[self.function_index[node.name]]
+        self._begin_function(function, node.parameters)
+        self.compile_statement(node.body)
+        self.emit(OP_RETK, 0)  # Falling off the end returns 0
+        self._finish_function()
+    
+    def _declare_local(self, name: str) -> int:
+        reg = self.next_register
+        self.next_register += 1
+        self.current.num_registers = max(self.current.num_registers, self.next_register)
+        self.scopes[-1][name] = reg
+        self.current.register_names[reg] = name
+        return reg
+    
+    def _lookup_local(self, name: str) -> Optional[int]:
+        for scope in reversed(self.scopes):
+            if name in scope:
+                return scope[name]
+        if name not in self.global_index and name not in self.function_index:
+            raise VMError(f"Undefined variable: {name}")
+        return None
+    
+    def _new_temporary(self) -> int:
+        reg = self.next_register
+        self.next_register += 1
+        self.current.num_registers = max(self.current.num_registers, self.next_register)
+        return reg
+    
+    def _release_temporaries(self, mark: int):
+        """Free all temporaries allocated after the given register mark."""
+        self.next_register = mark
+    
+    def _locals_mark(self) -> int:
+        """Register mark just above the innermost declared local."""
+        highest = -1
+        for scope in self.scopes:
+            if scope:
+                highest = max(highest, max(scope.values()))
+        return highest + 1
+    
+    def emit(self, op: int, a=0, b=0, c=0) -> int:
+        self.current.code.append((op, a, b, c))
+        return len(self.current.code) - 1
+    
+    def patch_jump(self, index: int, target: int):
+        """Point a previously emitted jump at target."""
+        op, a, b, c = self.current.code[index]
+        if op == OP_JMP:
+            self.current.code[index] = (op, target, b, c)
+        elif op in (OP_JZ, OP_JNZ):
+            self.current.code[index] = (op, a, target, c)
         else:
-            result = str(node)
-            return result[:max_length] + "..." if len(result) > max_length else result
+            self.current.code[index] = (op, a, b, target)
     
-    def compile(self, source_file: str, output_file: str = None) -> bool:
-        """Compile C source file to executable."""
-        try:
-            # Read source code
-            with open(source_file, 'r') as f:
-                source_code = f.read()
-            
-            print(f"🚀 Compiling {source_file}...")
-            
-            # Phase 1: Lexical Analysis
-            print("📝 Phase 1: Lexical Analysis (Tokenization)...")
-            self.lexer = Lexer(source_code)
-            tokens = self.lexer.tokenize()
-            print(f"   Generated {len(tokens)} tokens")
-            
-            # Debug: Print first 10 tokens
-            print("   First 10 tokens:")
-            for i, token in enumerate(tokens[:10]):
-                print(f"     {i+1}. {token}")
-            
-            # Phase 2: Syntax Analysis (Parsing)
-            print("🌳 Phase 2: Syntax Analysis (Parsing)...")
-            self.parser = Parser(tokens)
-            ast = self.parser.parse()
-            print(f"   Generated AST with {len(ast.declarations)} top-level declarations")
-            
-            # Debug: Print AST structure
-            print("   AST Structure:")
-            for i, decl in enumerate(ast.declarations[:3]):  # Show first 3 declarations
-                print(f"     {i+1}. {type(decl).__name__}: {self._format_ast_node(decl)}")
-            
-            # Phase 3: Semantic Analysis
-            print("🔍 Phase 3: Semantic Analysis...")
-            self.semantic_analyzer = SemanticAnalyzer()
-            semantic_success = self.semantic_analyzer.analyze(ast)
-            
-            if not semantic_success:
-                print(f"   ❌ Found {len(self.semantic_analyzer.errors)} semantic errors:")
-                for error in self.semantic_analyzer.errors:
-                    print(f"     • {error.message}")
-                return False
-            
-            print("   ✅ Semantic analysis completed successfully!")
-            
-            # Phase 3.5: AST Optimization  
-            if self.optimization_level > 0:
-                print("🔧 Phase 3.5: AST Optimization...")
-                optimized_ast = self.optimizer.optimize_ast(ast)
-                print("   ✅ AST optimization completed successfully!")
+    # ========================================================================
+    # STATEMENTS
+    # ========================================================================
+    
+    def compile_statement(self, node: ASTNode):
+        """Lower a statement; temporaries are released afterwards."""
+        if node is None:
+            return
+        
+        if isinstance(node, CompoundStatement):
+            self.scopes.append({})
+            for stmt in node.statements:
+                self.compile_statement(stmt)
+            self.scopes.pop()
+            self._release_temporaries(self._locals_mark())
+        
+        elif isinstance(node, VariableDeclaration):
+            mark = self._locals_mark()
+            if node.initializer is not None:
+                # Evaluate before declaring so the initializer sees any outer binding
+                reg = self.compile_expression(node.initializer)
+                self._release_temporaries(mark)
+                local = self._declare_local(node.name)
+                if reg != local:
+                    self.emit(OP_MOV, local, reg)
             else:
-                print("⏩ Phase 3.5: AST Optimization - SKIPPED (O0)")
-                optimized_ast = ast
-            
-            # Phase 4: Code Generation
-            print("⚙️ Phase 4: Code Generation...")
-            assembly_code = self.code_generator.generate(optimized_ast)
-            
-            # Phase 4.5: Assembly Optimization
-            if self.optimization_level > 0:
-                print("🔧 Phase 4.5: Assembly Optimization...")
-                optimized_assembly = self.optimizer.optimize_assembly(assembly_code)
-                print("   ✅ Assembly optimization completed successfully!")
+                local = self._declare_local(node.name)
+                self.emit(OP_LOADK, local, 0)
+        
+        elif isinstance(node, ExpressionStatement):
+            if node.expression is not None:
+                self.compile_effect(node.expression)
+        
+        elif isinstance(node, ReturnStatement):
+            if node.expression is None:
+                self.emit(OP_RETK, 0)
+            elif isinstance(node.expression, IntegerLiteral):
+                self.emit(OP_RETK, node.expression.value)
             else:
-                print("⏩ Phase 4.5: Assembly Optimization - SKIPPED (O0)")
-                optimized_assembly = assembly_code
+                self.emit(OP_RET, self.compile_expression(node.expression))
+            self._release_temporaries(self._locals_mark())
+        
+        elif isinstance(node, IfStatement):
+            false_jumps = self.compile_branch_if_false(node.condition)
+            self.compile_statement(node.then_statement)
+            if node.else_statement:
+                end_jump = self.emit(OP_JMP, 0)
+                for jump in false_jumps:
+                    self.patch_jump(jump, len(self.current.code))
+                self.compile_statement(node.else_statement)
+                self.patch_jump(end_jump, len(self.current.code))
+            else:
+                for jump in false_jumps:
+                    self.patch_jump(jump, len(self.current.code))
+        
+        elif isinstance(node, WhileStatement):
+            loop_start = len(self.current.code)
+            exit_jumps = self.compile_branch_if_false(node.condition)
+            self.compile_statement(node.body)
+            self.emit(OP_JMP, loop_start)
+            for jump in exit_jumps:
+                self.patch_jump(jump, len(self.current.code))
+        
+        elif isinstance(node, ForStatement):
+            self.scopes.append({})
+            if isinstance(node.init, VariableDeclaration):
+                self.compile_statement(node.init)
+            elif node.init is not None:
+                self.compile_effect(node.init)
+            loop_start = len(self.current.code)
+            exit_jumps = []
+            if node.condition is not None:
+                exit_jumps = self.compile_branch_if_false(node.condition)
+            self.compile_statement(node.body)
+            if node.update is not None:
+                self.compile_effect(node.update)
+            self.emit(OP_JMP, loop_start)
+            for jump in exit_jumps:
+                self.patch_jump(jump, len(self.current.code))
+            self.scopes.pop()
+            self._release_temporaries(self._locals_mark())
+        
+        else:
+            raise VMError(f"Unsupported statement: {type(node).__name__}")
+    
+    def compile_effect(self, node: ASTNode):
+        """Lower an expression evaluated only for its side effects."""
+        increment = self._match_local_increment(node)
+        if increment:
+            reg, amount = increment
+            self.superinstructions += 1
+            self.emit(OP_INCL, reg, amount)
+        else:
+            self.compile_expression(node)
+        self._release_temporaries(self._locals_mark())
+    
+    def _match_local_increment(self, node: ASTNode):
+        """Recognize i++, ++i, i--, i += k, i -= k and i = i + k on a local."""
+        if isinstance(node, UnaryExpression) and isinstance(node.operand, Identifier):
+            reg = self._lookup_local(node.operand.name)
+            if reg is not None and node.operator in ('++', 'post++'):
+                return reg, 1
+            if reg is not None and node.operator in ('--', 'post--'):
+                return reg, -1
+        elif isinstance(node, AssignmentExpression) and isinstance(node.left, Identifier):
+            reg = self._lookup_local(node.left.name)
+            if reg is None:
+                return None
+            if node.operator in ('+=', '-=') and isinstance(node.right, IntegerLiteral):
+                amount = node.right.value
+                return reg, amount if node.operator == '+=' else -amount
+            if (node.operator == '=' and isinstance(node.right, BinaryExpression) and
+                node.right.operator in ('+', '-')):
+                expr = node.right
+                if (isinstance(expr.left, Identifier) and expr.left.name == node.left.name and
+                    isinstance(expr.right, IntegerLiteral)):
+                    return reg, expr.right.value if expr.operator == '+' else -expr.right.value
+                if (expr.operator == '+' and isinstance(expr.right, Identifier) and
+                    expr.right.name == node.left.name and isinstance(expr.left, IntegerLiteral)):
+                    return reg, expr.left.value
+        return None
+    
+    def compile_branch_if_false(self, condition: ASTNode) -> List[int]:
+        """Emit code that jumps when condition is false; returns jumps to patch."""
+        if isinstance(condition, BinaryExpression) and condition.operator in COMPARISON_OPCODES:
+            operator, left, right = condition.operator, condition.left, condition.right
+            if isinstance(left, IntegerLiteral) and not isinstance(right, IntegerLiteral):
+                operator, left, right = SWAPPED_COMPARISONS[operator], right, left
+            _, branch_op, branch_imm_op = COMPARISON_OPCODES[operator]
+            left_reg = self.compile_expression(left)
+            self.superinstructions += 1
+            if isinstance(right, IntegerLiteral):
+                return [self.emit(branch_imm_op, left_reg, right.value, 0)]
+            right_reg = self.compile_expression(right)
+            return [self.emit(branch_op, left_reg, right_reg, 0)]
+        
+        if isinstance(condition, BinaryExpression) and condition.operator == '&&':
+            return (self.compile_branch_if_false(condition.left) +
+                    self.compile_branch_if_false(condition.right))
+        
+        if isinstance(condition, BinaryExpression) and condition.operator == '||':
+            left_true_jumps = self.compile_branch_if_true(condition.left)
+            false_jumps = self.compile_branch_if_false(condition.right)
+            for jump in left_true_jumps:
+                self.patch_jump(jump, len(self.current.code))
+            return false_jumps
+        
+        if isinstance(condition, UnaryExpression) and condition.operator == '!':
+            return self.compile_branch_if_true(condition.operand)
+        
+        reg = self.compile_expression(condition)
+        return [self.emit(OP_JZ, reg, 0)]
+    
+    def compile_branch_if_true(self, condition: ASTNode) -> List[int]:
+        """Emit code that jumps when condition is true; returns jumps to patch."""
+        if isinstance(condition, UnaryExpression) and condition.operator == '!':
+            return self.compile_branch_if_false(condition.operand)
+        
+        if isinstance(condition, BinaryExpression) and condition.operator == '||':
+            return (self.compile_branch_if_true(condition.left) +
+                    self.compile_branch_if_true(condition.right))
+        
+        if isinstance(condition, BinaryExpression) and condition.operator == '&&':
+            left_false_jumps = self.compile_branch_if_false(condition.left)
+            true_jumps = self.compile_branch_if_true(condition.right)
+            for jump in left_false_jumps:
+                self.patch_jump(jump, len(self.current.code))
+            return true_jumps
+        
+        reg = self.compile_expression(condition)
+        return [self.emit(OP_JNZ, reg, 0)]
+    
+    # ========================================================================
+    # EXPRESSIONS
+    # ========================================================================
+    
+    def compile_expression(self, node: ASTNode) -> int:
+        """Lower an expression and return the register holding its value."""
+        if isinstance(node, Identifier):
+            reg = self._lookup_local(node.name)
+            if reg is not None:
+                return reg  # Locals are read in place, no copy needed
+            if node.name not in self.global_index:
+                raise VMError(f"Undefined variable: {node.name}")
+            dst = self._new_temporary()
+            self.emit(OP_LOADG, dst, self.global_index[node.name])
+            return dst
+        
+        elif isinstance(node, (IntegerLiteral, FloatLiteral, StringLiteral)):
+            dst = self._new_temporary()
+            self.emit(OP_LOADK, dst, node.value)
+            return dst
+        
+        elif isinstance(node, CharLiteral):
+            dst = self._new_temporary()
+            self.emit(OP_LOADK, dst, ord(node.value) if node.value else 0)
+            return dst
+        
+        elif isinstance(node, BinaryExpression):
+            return self.compile_binary_expression(node)
+        
+        elif isinstance(node, UnaryExpression):
+            return self.compile_unary_expression(node)
+        
+        elif isinstance(node, AssignmentExpression):
+            return self.compile_assignment_expression(node)
+        
+        elif isinstance(node, CallExpression):
+            return self.compile_call_expression(node)
+        
+        raise VMError(f"Unsupported expression: {type(node).__name__}")
+    
+    def compile_binary_expression(self, node: BinaryExpression) -> int:
+        if node.operator in ('&&', '||'):
+            # Short-circuit evaluation producing 0 or 1
+            dst = self._new_temporary()
+            if node.operator == '&&':
+                jumps = self.compile_branch_if_false(node)
+                self.emit(OP_LOADK, dst, 1)
+                end_jump = self.emit(OP_JMP, 0)
+                for jump in jumps:
+                    self.patch_jump(jump, len(self.current.code))
+                self.emit(OP_LOADK, dst, 0)
+            else:
+                jumps = self.compile_branch_if_true(node)
+                self.emit(OP_LOADK, dst, 0)
+                end_jump = self.emit(OP_JMP, 0)
+                for jump in jumps:
+                    self.patch_jump(jump, len(self.current.code))
+                self.emit(OP_LOADK, dst, 1)
+            self.patch_jump(end_jump, len(self.current.code))
+            return dst
+        
+        if node.operator == '+' and isinstance(node.right, IntegerLiteral):
+            left_reg = self.compile_expression(node.left)
+            dst = self._new_temporary()
+            self.superinstructions += 1
+            self.emit(OP_ADDK, dst, left_reg, node.right.value)
+            return dst
+        
+        left_reg = self.compile_expression(node.left)
+        right_reg = self.compile_expression(node.right)
+        dst = self._new_temporary()
+        
+        if node.operator in ARITHMETIC_OPCODES:
+            self.emit(ARITHMETIC_OPCODES[node.operator], dst, left_reg, right_reg)
+        elif node.operator in COMPARISON_OPCODES:
+            self.emit(COMPARISON_OPCODES[node.operator][0], dst, left_reg, right_reg)
+        else:
+            raise VMError(f"Unsupported binary operator: {node.operator}")
+        return dst
+    
+    def compile_unary_expression(self, node: UnaryExpression) -> int:
+        if node.operator in ('++', '--', 'post++', 'post--'):
+            if not isinstance(node.operand, Identifier):
+                raise VMError(f"Invalid operand for {node.operator}")
+            amount = 1 if node.operator.endswith('++') else -1
+            local = self._lookup_local(node.operand.name)
+            if local is not None:
+                if node.operator.startswith('post'):
+                    old_value = self._new_temporary()
+                    self.emit(OP_MOV, old_value, local)
+                    self.emit(OP_INCL, local, amount)
+                    return old_value
+                self.emit(OP_INCL, local, amount)
+                return local
+            value = self.compile_expression(node.operand)
+            updated = self._new_temporary()
+            self.emit(OP_ADDK, updated, value, amount)
+            self.emit(OP_STOREG, self.global_index[node.operand.name], updated)
+            return value if node.operator.startswith('post') else updated
+        
+        operand = self.compile_expression(node.operand)
+        dst = self._new_temporary()
+        if node.operator == '-':
+            self.emit(OP_NEG, dst, operand)
+        elif node.operator == '!':
+            self.emit(OP_NOT, dst, operand)
+        else:
+            raise VMError(f"Unsupported unary operator: {node.operator}")
+        return dst
+    
+    def compile_assignment_expression(self, node: AssignmentExpression) -> int:
+        if not isinstance(node.left, Identifier):
+            raise VMError("Assignment target must be a variable")
+        
+        name = node.left.name
+        local = self._lookup_local(name)
+        
+        if node.operator == '=':
+            value = self.compile_expression(node.right)
+        else:
+            current = self.compile_expression(node.left)
+            right = self.compile_expression(node.right)
+            value = self._new_temporary()
+            self.emit(ARITHMETIC_OPCODES[node.operator[0]], value, current, right)
+        
+        if local is not None:
+            if value != local:
+                self.emit(OP_MOV, local, value)
+            return local
+        if name not in self.global_index:
+            raise VMError(f"Undefined variable: {name}")
+        self.emit(OP_STOREG, self.global_index[name], value)
+        return value
+    
+    def compile_call_expression(self, node: CallExpression) -> int:
+        if not isinstance(node.function, Identifier):
+            raise VMError("Invalid function call")
+        
+        name = node.function.name
+        # Arguments are evaluated into consecutive registers
+        base = self.next_register
+        arg_regs = [self._new_temporary() for _ in node.arguments]
+        for arg, arg_reg in zip(node.arguments, arg_regs):
+            mark = self.next_register
+            value = self.compile_expression(arg)
+            if value != arg_reg:
+                self.emit(OP_MOV, arg_reg, value)
+            self._release_temporaries(mark)
+        
+        dst = self._new_temporary()
+        if name == 'printf':
+            self.emit(OP_PRINTF, dst, base, len(arg_regs))
+        elif name in self.function_index:
+            self.emit(OP_CALL, dst, self.function_index[name], base)
+        else:
+            raise VMError(f"Call to undefined function: {name}")
+        return dst
+
+class BytecodeModule:
+    """A lowered program ready to execute on the BytecodeVM."""
+    def __init__(self, functions: List[BytecodeFunction], function_index: Dict[str, int],
+                 num_globals: int, init_function: BytecodeFunction, superinstructions: int):
+        self.functions = functions
+        self.function_index = function_index
+        self.num_globals = num_globals
+        self.init_function = init_function
+        self.superinstructions = superinstructions
+    
+    def instruction_count(self) -> int:
+        return sum(len(f.code) for f in self.functions)
+    
+    def disassemble(self) -> str:
+        return "\n\n".join(f.disassemble() for f in self.functions + [self.init_function])
+
+class BytecodeVM:
+    """Executes a BytecodeModule with a tight register-machine dispatch loop."""
+    
+    def __init__(self, module: BytecodeModule, output=None):
+        self.module = module
+        self.functions = module.functions
+        self.globals = [0] * module.num_globals
+        self.output = output if output is not None else sys.stdout
+    
+    def run(self, entry: str = "main", arguments: List = None):
+        """Initialize globals and run the entry function, returning its result."""
+        if entry not in self.module.function_index:
+            raise VMError(f"Entry function '{entry}' is not defined")
+        self.execute(self.module.init_function, [])
+        return self.execute(self.functions[self.module.function_index[entry]], arguments or [])
+    
+    def execute(self, function: BytecodeFunction, arguments: List):
+        """Dispatch loop. Opcodes are tested roughly in order of frequency."""
+        regs = [0] * function.num_registers
+        regs[:len(arguments)] = arguments
+        code = function.code
+        functions = self.functions
+        global_vars = self.globals
+        pc = 0
+        
+        while True:
+            op, a, b, c = code[pc]
+            pc += 1
+            
+            if op == OP_MOV:
+                regs[a] = regs[b]
+            elif op == OP_INCL:
+                value = regs[a] + b
+                if value > INT_MAX or value < INT_MIN:
+                    value = wrap_int32(value)
+                regs[a] = value
+            elif op == OP_JNLTK:
+                if not regs[a] < b:
+                    pc = c
+            elif op == OP_JNLT:
+                if not regs[a] < regs[b]:
+                    pc = c
+            elif op == OP_JMP:
+                pc = a
+            elif op == OP_LOADK:
+                regs[a] = b
+            elif op == OP_ADD:
+                value = regs[b] + regs[c]
+                if (value > INT_MAX or value < INT_MIN) and type(value) is int:
+                    value = wrap_int32(value)
+                regs[a] = value
+            elif op == OP_ADDK:
+                value = regs[b] + c
+                if (value > INT_MAX or value < INT_MIN) and type(value) is int:
+                    value = wrap_int32(value)
+                regs[a] = value
+            elif op == OP_SUB:
+                value = regs[b] - regs[c]
+                if (value > INT_MAX or value < INT_MIN) and type(value) is int:
+                    value = wrap_int32(value)
+                regs[a] = value
+            elif op == OP_MUL:
+                value = regs[b] * regs[c]
+                if (value > INT_MAX or value < INT_MIN) and type(value) is int:
+                    value = wrap_int32(value)
+                regs[a] = value
+            elif op == OP_JNLEK:
+                if not regs[a] <= b:
+                    pc = c
+            elif op == OP_JNGTK:
+                if not regs[a] > b:
+                    pc = c
+            elif op == OP_JNGEK:
+                if not regs[a] >= b:
+                    pc = c
+            elif op == OP_JNEQK:
+                if not regs[a] == b:
+                    pc = c
+            elif op == OP_JNNEK:
+                if not regs[a] != b:
+                    pc = c
+            elif op == OP_JNLE:
+                if not regs[a] <= regs[b]:
+                    pc = c
+            elif op == OP_JNGT:
+                if not regs[a] > regs[b]:
+                    pc = c
+            elif op == OP_JNGE:
+                if not regs[a] >= regs[b]:
+                    pc = c
+            elif op == OP_JNEQ:
+                if not regs[a] == regs[b]:
+                    pc = c
+            elif op == OP_JNNE:
+                if not regs[a] != regs[b]:
+                    pc = c
+            elif op == OP_JZ:
+                if not regs[a]:
+                    pc = b
+            elif op == OP_JNZ:
+                if regs[a]:
+                    pc = b
+            elif op == OP_CALL:
+                callee = functions[b]
+                regs[a] = self.execute(callee, regs[c:c + callee.num_params])
+            elif op == OP_RET:
+                return regs[a]
+            elif op == OP_RETK:
+                return a
+            elif op == OP_LOADG:
+                regs[a] = global_vars[b]
+            elif op == OP_STOREG:
+                global_vars[a] = regs[b]
+            elif op == OP_DIV:
+                regs[a] = c_divide(regs[b], regs[c])
+            elif op == OP_MOD:
+                regs[a] = c_modulo(regs[b], regs[c])
+            elif op == OP_LT:
+                regs[a] = 1 if regs[b] < regs[c] else 0
+            elif op == OP_GT:
+                regs[a] = 1 if regs[b] > regs[c] else 0
+            elif op == OP_LE:
+                regs[a] = 1 if regs[b] <= regs[c] else 0
+            elif op == OP_GE:
+                regs[a] = 1 if regs[b] >= regs[c] else 0
+            elif op == OP_EQ:
+                regs[a] = 1 if regs[b] == regs[c] else 0
+            elif op == OP_NE:
+                regs[a] = 1 if regs[b] != regs[c] else 0
+            elif op == OP_NEG:
+                value = -regs[b]
+                if value > INT_MAX and type(value) is int:
+                    value = wrap_int32(value)
+                regs[a] = value
+            elif op == OP_NOT:
+                regs[a] = 0 if regs[b] else 1
+            elif op == OP_PRINTF:
+                args = regs[b:b + c]
+                text = c_printf(args[0], args[1:]) if args else ""
+                self.output.write(text)
+                regs[a] = len(text)
+            else:
+                raise VMError(f"Invalid opcode {op} at {function.name}:{pc - 1}")
+
+class ReturnSignal(Exception):
+    """Unwinds the AST interpreter out of a function body on return."""
+    def __init__(self, value):
+        self.value = value
+
+class ASTInterpreter:
+    """
+    Naive tree-walking interpreter used as the baseline for the bytecode VM.
+    
+    Evaluates the AST directly with dictionary environments and isinstance
+    dispatch on every node visit.
+    """
+    
+    def __init__(self, program: Program, output=None):
+        self.functions = {d.name: d for d in program.declarations
+                          if isinstance(d, FunctionDeclaration) and d.body}
+        self.globals = {}
+        self.output = output if output is not None else sys.stdout
+        self.program = program
+    
+    def run(self, entry: str = "main", arguments: List = None):
+        for decl in self.program.declarations:
+            if isinstance(decl, VariableDeclaration):
+                self.globals[decl.name] = (self.evaluate(decl.initializer, [])
+                                           if decl.initializer is not None else 0)
+        return self.call(entry, arguments or [])
+    
+    def call(self, name: str, arguments: List):
+        if name not in self.functions:
+            raise VMError(f"Call to undefined function: {name}")
+        func = self.functions[name]
+        env = [{param.name: value for param, value in zip(func.parameters, arguments)}]
+        try:
+            self.execute(func.body, env)
+        except ReturnSignal as signal:
+            return signal.value
+        return 0
+    
+    def _lookup_scope(self, name: str, env: List[Dict]) -> Dict:
+        for scope in reversed(env):
+            if name in scope:
+                return scope
+        if name in self.globals:
+            return self.globals
+        # Same implicit function-local treatment as BytecodeCompiler
+        env[0][name] = 0
+        return env[0]
+    
+    def execute(self, node: ASTNode, env: List[Dict]):
+        if isinstance(node, CompoundStatement):
+            env.append({})
+            try:
+                for stmt in node.statements:
+                    self.execute(stmt, env)
+            finally:
+                env.pop()
+        elif isinstance(node, VariableDeclaration):
+            env[-1][node.name] = self.evaluate(node.initializer, env) if node.initializer is not None else 0
+        elif isinstance(node, ExpressionStatement):
+            if node.expression is not None:
+                self.evaluate(node.expression, env)
+        elif isinstance(node, ReturnStatement):
+            raise ReturnSignal(self.evaluate(node.expression, env) if node.expression is not None else 0)
+        elif isinstance(node, IfStatement):
+            if self.evaluate(node.condition, env):
+                self.execute(node.then_statement, env)
+            elif node.else_statement:
+                self.execute(node.else_statement, env)
+        elif isinstance(node, WhileStatement):
+            while self.evaluate(node.condition, env):
+                self.execute(node.body, env)
+        elif isinstance(node, ForStatement):
+            env.append({})
+            try:
+                if isinstance(node.init, VariableDeclaration):
+                    self.execute(node.init, env)
+                elif node.init is not None:
+                    self.evaluate(node.init, env)
+                while node.condition is None or self.evaluate(node.condition, env):
+                    self.execute(node.body, env)
+                    if node.update is not None:
+                        self.evaluate(node.update, env)
+            finally:
+                env.pop()
+    
+    def evaluate(self, node: ASTNode, env: List[Dict]):
+        if isinstance(node, IntegerLiteral) or isinstance(node, FloatLiteral) or isinstance(node, StringLiteral):
+            return node.value
+        elif isinstance(node, CharLiteral):
+            return ord(node.value) if node.value else 0
+        elif isinstance(node, Identifier):
+            return self._lookup_scope(node.name, env)[node.name]
+        elif isinstance(node, BinaryExpression):
+            if node.operator == '&&':
+                return 1 if self.evaluate(node.left, env) and self.evaluate(node.right, env) else 0
+            if node.operator == '||':
+                return 1 if self.evaluate(node.left, env) or self.evaluate(node.right, env) else 0
+            return self.apply_operator(node.operator, self.evaluate(node.left, env),
+                                       self.evaluate(node.right, env))
+        elif isinstance(node, UnaryExpression):
+            if node.operator in ('++', '--', 'post++', 'post--'):
+                scope = self._lookup_scope(node.operand.name, env)
+                old_value = scope[node.operand.name]
+                new_value = wrap_int32(old_value + (1 if node.operator.endswith('++') else -1))
+                scope[node.operand.name] = new_value
+                return old_value if node.operator.startswith('post') else new_value
+            value = self.evaluate(node.operand, env)
+            if node.operator == '-':
+                return wrap_int32(-value) if type(value) is int else -value
+            return 0 if value else 1
+        elif isinstance(node, AssignmentExpression):
+            scope = self._lookup_scope(node.left.name, env)
+            value = self.evaluate(node.right, env)
+            if node.operator != '=':
+                value = self.apply_operator(node.operator[0], scope[node.left.name], value)
+            scope[node.left.name] = value
+            return value
+        elif isinstance(node, CallExpression):
+            arguments = [self.evaluate(arg, env) for arg in node.arguments]
+            if node.function.name == 'printf':
+                text = c_printf(arguments[0], arguments[1:]) if arguments else ""
+                self.output.write(text)
+                return len(text)
+            return self.call(node.function.name, arguments)
+        raise VMError(f"Unsupported expression: {type(node).__name__}")
+    
+    def apply_operator(self, operator: str, left, right):
+        if operator == '+':
+            result = left + right
+        elif operator == '-':
+            result = left - right
+        elif operator == '*':
+            result = left * right
+        elif operator == '/':
+            return c_divide(left, right)
+        elif operator == '%':
+            return c_modulo(left, right)
+        elif operator == '<':
+            return 1 if left < right else 0
+        elif operator == '>':
+            return 1 if left > right else 0
+        elif operator == '<=':
+            return 1 if left <= right else 0
+        elif operator == '>=':
+            return 1 if left >= right else 0
+        elif operator == '==':
+            return 1 if left == right else 0
+        elif operator == '!=':
+            return 1 if left != right else 0
+        else:
+            raise VMError(f"Unsupported binary operator: {operator}")
+        return wrap_int32(result) if type(result) is int else result
+
+# ============================================================================
+# BINARY AST SERIALIZATION
+# ============================================================================
+
+AST_FORMAT_MAGIC = b"VAST"
+AST_FORMAT_VERSION = 1
+
+# Node kind numbers are part of the format: append new classes, never reorder
+AST_NODE_KINDS = [
+    Program, FunctionDeclaration, Parameter, VariableDeclaration, CompoundStatement,
+    ExpressionStatement, ReturnStatement, IfStatement, WhileStatement, ForStatement,
+    BinaryExpression, UnaryExpression, AssignmentExpression, CallExpression, Identifier,
+    IntegerLiteral, FloatLiteral, StringLiteral, CharLiteral,
+]
+
+class ASTFormatError(Exception):
+    """Serialized AST data is corrupt or from an incompatible format."""
+    pass
+
+class ASTSerializer:
+    """
+    Compact binary encoding of an AST.
+    
+    Layout: magic, format version, 8-byte schema digest, string table,
+    node table, root index. Nodes are written children first, so every
+    child is a back-reference by table index and loading never recurses;
+    a node reachable twice is stored once. Node kinds, counts, indices and
+    integers are varints (integers zigzag-encoded); every string is stored
+    once in the table. Each field value is a one-byte tag and a payload.
+    """
+    
+    TAG_NONE, TAG_NODE, TAG_LIST, TAG_INT, TAG_FLOAT, TAG_STR, TAG_TRUE, TAG_FALSE, TAG_TUPLE = range(9)
+    
+    _schema = None
+    
+    @classmethod
+    def schema(cls):
+        """(class, field names) per node kind, plus a digest that changes with any field."""
+        if cls._schema is None:
+            import hashlib
+            import dataclasses
+            kinds = [(node_class, tuple(f.name for f in dataclasses.fields(node_class)))
+                     for node_class in AST_NODE_KINDS]
+            description = ";".join(f"{c.__name__}:{','.join(names)}" for c, names in kinds)
+            cls._schema = (kinds, hashlib.sha256(description.encode()).digest()[:8])
+        return cls._schema
+    
+    # ------------------------------------------------------------------------
+    # Encoding
+    # ------------------------------------------------------------------------
+    
+    @staticmethod
+    def _varint(out: bytearray, value: int):
+        while value >= 0x80:
+            out.append((value & 0x7F) | 0x80)
+            value >>= 7
+        out.append(value)
+    
+    def serialize(self, root: ASTNode) -> bytes:
+        kinds, digest = self.schema()
+        self.kind_numbers = {node_class: number for number, (node_class, _) in enumerate(kinds)}
+        self.field_names = {node_class: names for node_class, names in kinds}
+        self.strings = {}
+        self.indices = {}
+        self.nodes = bytearray()
+        root_index = self._node(root)
+        
+        out = bytearray(AST_FORMAT_MAGIC)
+        self._varint(out, AST_FORMAT_VERSION)
+        out += digest
+        self._varint(out, len(self.strings))
+        for text in self.strings:  # Dicts keep insertion order, which is index order
+            encoded = text.encode('utf-8')
+            self._varint(out, len(encoded))
+            out += encoded
+        self._varint(out, len(self.indices))
+        out += self.nodes
+        self._varint(out, root_index)
+        return bytes(out)
+    
+    def _node(self, node: ASTNode) -> int:
+        index = self.indices.get(id(node))
+        if index is not None:
+            return index
+        node_class = type(node)
+        if node_class not in self.kind_numbers:
+            raise ASTFormatError(f"cannot serialize {node_class.__name__}")
+        payload = bytearray()
+        for name in self.field_names[node_class]:
+            self._value(payload, getattr(node, name))  # Children are appended first
+        self._varint(self.nodes, self.kind_numbers[node_class])
+        self.nodes += payload
+        index = self.indices[id(node)] = len(self.indices)
+        return index
+    
+    def _value(self, out: bytearray, value):
+        if value is None:
+            out.append(self.TAG_NONE)
+        elif isinstance(value, ASTNode):
+            index = self._node(value)
+            out.append(self.TAG_NODE)
+            self._varint(out, index)
+        elif isinstance(value, bool):
+            out.append(self.TAG_TRUE if value else self.TAG_FALSE)
+        elif isinstance(value, int):
+            out.append(self.TAG_INT)
+            self._varint(out, (value << 1) if value >= 0 else ((-value) << 1) - 1)
+        elif isinstance(value, str):
+            index = self.strings.setdefault(value, len(self.strings))
+            out.append(self.TAG_STR)
+            self._varint(out, index)
+        elif isinstance(value, float):
+            import struct
+            out.append(self.TAG_FLOAT)
+            out += struct.pack('<d', value)
+        elif isinstance(value, (list, tuple)):
+            out.append(self.TAG_LIST if isinstance(value, list) else self.TAG_TUPLE)
+            self._varint(out, len(value))
+            for item in value:
+                self._value(out, item)
+        else:
+            raise ASTFormatError(f"cannot serialize field value of type {type(value).__name__}")
+    
+    # ------------------------------------------------------------------------
+    # Decoding
+    # ------------------------------------------------------------------------
+    
+    def deserialize(self, data: bytes) -> ASTNode:
+        import struct
+        kinds, digest = self.schema()
+        if data[:4] != AST_FORMAT_MAGIC:
+            raise ASTFormatError("not a serialized AST")
+        position = 4
+        
+        def varint() -> int:
+            nonlocal position
+            byte = data[position]
+            position += 1
+            if byte < 0x80:
+                return byte
+            result, shift = byte & 0x7F, 7
+            while True:
+                byte = data[position]
+                position += 1
+                result |= (byte & 0x7F) << shift
+                if byte < 0x80:
+                    return result
+                shift += 7
+        
+        try:
+            version = varint()
+            if version != AST_FORMAT_VERSION or data[position:position + 8] != digest:
+                raise ASTFormatError(f"incompatible AST format (version {version})")
+            position += 8
+            
+            strings = []
+            for _ in range(varint()):
+                length = varint()
+                strings.append(data[position:position + length].decode('utf-8'))
+                position += length
+            
+            nodes = []
+            TAG_NODE, TAG_STR, TAG_INT, TAG_NONE, TAG_LIST = (
+                self.TAG_NODE, self.TAG_STR, self.TAG_INT, self.TAG_NONE, self.TAG_LIST)
+            
+            def value():
+                nonlocal position
+                tag = data[position]
+                position += 1
+                if tag == TAG_NODE:
+                    return nodes[varint()]
+                if tag == TAG_STR:
+                    return strings[varint()]
+                if tag == TAG_INT:
+                    encoded = varint()
+                    return (encoded >> 1) if not encoded & 1 else -((encoded + 1) >> 1)
+                if tag == TAG_NONE:
+                    return None
+                if tag == TAG_LIST:
+                    return [value() for _ in range(varint())]
+                if tag == self.TAG_TUPLE:
+                    return tuple(value() for _ in range(varint()))
+                if tag == self.TAG_FLOAT:
+                    position += 8
+                    return struct.unpack_from('<d', data, position - 8)[0]
+                if tag in (self.TAG_TRUE, self.TAG_FALSE):
+                    return tag == self.TAG_TRUE
+                raise ASTFormatError(f"unknown value tag {tag}")
+            
+            new = object.__new__
+            for _ in range(varint()):
+                node_class, names = kinds[varint()]
+                # Dataclass fields are plain attributes, so __init__ can be skipped
+                node = new(node_class)
+                node.__dict__.update(zip(names, [value() for _ in names]))
+                nodes.append(node)
+            root = nodes[varint()]
+            if position != len(data):
+                raise ASTFormatError("trailing data after AST")
+            return root
+        except (IndexError, UnicodeDecodeError, struct.error) as e:
+            raise ASTFormatError(f"truncated or corrupt AST data: {e}")
+
+def serialize_ast(node: ASTNode) -> bytes:
+    """Encode an AST in the binary format (see ASTSerializer)."""
+    return ASTSerializer().serialize(node)
+
+def deserialize_ast(data: bytes) -> ASTNode:
+    """Decode an AST written by serialize_ast."""
+    return ASTSerializer().deserialize(data)
+
+# ============================================================================
+# PERSISTENT COMPILATION CACHE
+# ============================================================================
+
+def compiler_fingerprint() -> str:
+    """Version string plus a digest of this file, so compiler edits invalidate the cache."""
+    global _COMPILER_FINGERPRINT
+    if _COMPILER_FINGERPRINT is None:
+        import hashlib
+        try:
+            with open(os.path.abspath(__file__), 'rb') as f:
+                digest = hashlib.sha256(f.read()).hexdigest()[:16]
+        except OSError:
+            digest = "unknown"
+        _COMPILER_FINGERPRINT = f"{COMPILER_VERSION}+{digest}"
+    return _COMPILER_FINGERPRINT
+
+_COMPILER_FINGERPRINT = None
+
+def parse_size(text: str) -> int:
+    """Parse a human size such as 500K, 64M or 2G into bytes."""
+    units = {'K': 1024, 'M': 1024 ** 2, 'G': 1024 ** 3}
+    text = text.strip().upper()
+    if text and text[-1] in units:
+        return int(float(text[:-1]) * units[text[-1]])
+    return int(text)
+
+class CompilationCache:
+    """
+    ccache-style content-addressed cache for compiler outputs.
+    
+    Entries are keyed by a SHA-256 over the source bytes, the optimization
+    settings and the compiler fingerprint, and stored as objects/<2>/<key>.<kind>.
+    - Writes go to a temporary file and are renamed into place, so readers
+      never observe partial entries
+    - Statistics and eviction run under an exclusive lock file, so parallel
+      build workers can share one cache directory
+    - The stats file keeps a running total of entry sizes, so a store does
+      not walk the cache; only eviction lists the entries (and resyncs it)
+    - Hits refresh the entry's mtime; eviction removes least recently used
+      entries until the cache is below 90% of its size limit
+    """
+    
+    DEFAULT_MAX_SIZE = 256 * 1024 * 1024
+    
+    def __init__(self, directory: Optional[str] = None, max_size: Optional[int] = None):
+        self.directory = (directory or os.environ.get('VIBE_CC_CACHE_DIR') or
+                          os.path.join(os.path.expanduser('~'), '.cache', 'vibe-cc'))
+        self.max_size = max_size or self.DEFAULT_MAX_SIZE
+        self.objects_dir = os.path.join(self.directory, 'objects')
+        self.stats_file = os.path.join(self.directory, 'stats.json')
+        self.lock_file = os.path.join(self.directory, 'lock')
+        os.makedirs(self.objects_dir, exist_ok=True)
+    
+    @staticmethod
+    def make_key(source: bytes, optimization_level: int, advanced_registers: bool,
+                 *extra: str) -> str:
+        """Hash everything that can change the compiler's output."""
+        import hashlib
+        hasher = hashlib.sha256()
+        hasher.update(compiler_fingerprint().encode())
+        hasher.update(f"\0O{optimization_level}\0regs={int(advanced_registers)}".encode())
+        for item in extra:
+            hasher.update(b"\0" + item.encode())
+        hasher.update(b"\0" + source)
+        return hasher.hexdigest()
+    
+    def _entry_path(self, key: str, kind: str) -> str:
+        return os.path.join(self.objects_dir, key[:2], f"{key}.{kind}")
+    
+    def lookup(self, key: str, kind: str) -> Optional[bytes]:
+        """Return the cached bytes for key, or None on a miss."""
+        path = self._entry_path(key, kind)
+        try:
+            with open(path, 'rb') as f:
+                data = f.read()
+            os.utime(path)  # Refresh LRU position
+        except OSError:
+            self._update_stats(misses=1)
+            return None
+        self._update_stats(hits=1)
+        return data
+    
+    def store(self, key: str, kind: str, data: bytes):
+        """Atomically publish an entry and evict old ones if over budget."""
+        import tempfile
+        path = self._entry_path(key, kind)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        fd, temp_path = tempfile.mkstemp(dir=os.path.dirname(path), prefix='.tmp-')
+        try:
+            with os.fdopen(fd, 'wb') as f:
+                f.write(data)
+            with self._locked():
+                try:
+                    replaced = os.stat(path).st_size
+                except OSError:
+                    replaced = 0
+                os.replace(temp_path, path)
+                stats = self._read_stats()
+                if 'size' not in stats:
+                    stats['size'] = self.total_size()  # First store into an existing cache
+                else:
+                    stats['size'] += len(data) - replaced
+                stats['stores'] = stats.get('stores', 0) + 1
+                self._write_stats(stats)
+        except OSError:
+            if os.path.exists(temp_path):
+                os.unlink(temp_path)
+            return
+        if stats['size'] > self.max_size:
+            self.evict()
+    
+    def _entries(self) -> List[tuple]:
+        """List (mtime, size, path) for every cache entry."""
+        entries = []
+        for root, _, files in os.walk(self.objects_dir):
+            for name in files:
+                if name.startswith('.tmp-'):
+                    continue
+                path = os.path.join(root, name)
+                try:
+                    st = os.stat(path)
+                except OSError:
+                    continue  # Removed concurrently
+                entries.append((st.st_mtime, st.st_size, path))
+        return entries
+    
+    def total_size(self) -> int:
+        return sum(size for _, size, _ in self._entries())
+    
+    def evict(self):
+        """Remove least recently used entries until below 90% of max_size."""
+        with self._locked():
+            entries = sorted(self._entries())
+            total = sum(size for _, size, _ in entries)
+            target = int(self.max_size * 0.9)
+            evicted = 0
+            for _, size, path in entries:
+                if total <= target:
+                    break
+                try:
+                    os.unlink(path)
+                except OSError:
+                    continue
+                total -= size
+                evicted += 1
+            stats = self._read_stats()
+            stats['size'] = total
+            stats['evictions'] = stats.get('evictions', 0) + evicted
+            self._write_stats(stats)
+    
+    def clear(self):
+        """Delete every entry and reset statistics."""
+        import shutil
+        with self._locked():
+            shutil.rmtree(self.objects_dir, ignore_errors=True)
+            os.makedirs(self.objects_dir, exist_ok=True)
+            self._write_stats({'size': 0})
+    
+    def _locked(self):
+        """Context manager holding the cache-wide exclusive lock."""
+        import contextlib
+        
+        @contextlib.contextmanager
+        def lock():
+            with open(self.lock_file, 'a') as handle:
+                try:
+                    import fcntl
+                    fcntl.flock(handle, fcntl.LOCK_EX)
+                except ImportError:
+                    pass  # No advisory locking on this platform
+                yield
+        return lock()
+    
+    def _read_stats(self) -> Dict[str, int]:
+        import json
+        try:
+            with open(self.stats_file, 'r') as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            return {}
+    
+    def _write_stats(self, stats: Dict[str, int]):
+        import json
+        temp_path = f"{self.stats_file}.{os.getpid()}"
+        with open(temp_path, 'w') as f:
+            json.dump(stats, f)
+        os.replace(temp_path, self.stats_file)
+    
+    def _update_stats(self, **deltas):
+        with self._locked():
+            stats = self._read_stats()
+            for name, delta in deltas.items():
+                stats[name] = stats.get(name, 0) + delta
+            self._write_stats(stats)
+    
+    def report(self):
+        """Print hit/miss statistics and current cache size."""
+        stats = self._read_stats()
+        entries = self._entries()
+        hits, misses = stats.get('hits', 0), stats.get('misses', 0)
+        lookups = hits + misses
+        hit_rate = (hits / lookups * 100) if lookups else 0.0
+        size = sum(s for _, s, _ in entries)
+        print(f"💾 Compilation cache: {self.directory}")
+        print(f"   Entries:    {len(entries)}")
+        print(f"   Size:       {size / 1024:.1f} KiB of {self.max_size / 1024 / 1024:.0f} MiB")
+        print(f"   Hits:       {hits}")
+        print(f"   Misses:     {misses}")
+        print(f"   Hit rate:   {hit_rate:.1f}%")
+        print(f"   Stores:     {stats.get('stores', 0)}")
+        print(f"   Evictions:  {stats.get('evictions', 0)}")
+
+# ============================================================================
+# FUNCTION-GRANULARITY INCREMENTAL COMPILATION
+# ============================================================================
+
+def iter_child_nodes(node: ASTNode):
+    """Yield the direct AST children of a node in field order."""
+    for name in child_fields(node.__class__):
+        value = getattr(node, name)
+        if isinstance(value, ASTNode):
+            yield value
+        elif isinstance(value, list):
+            for item in value:
+                if isinstance(item, ASTNode):
+                    yield item
+
+def find_called_functions(node: ASTNode, calls: Optional[List[str]] = None) -> List[str]:
+    """Names of all functions called anywhere under node, in first-use order."""
+    if calls is None:
+        calls = []
+    if isinstance(node, CallExpression) and isinstance(node.function, Identifier):
+        if node.function.name not in calls:
+            calls.append(node.function.name)
+    for child in iter_child_nodes(node):
+        find_called_functions(child, calls)
+    return calls
+
+def count_nodes(node: ASTNode) -> int:
+    """Number of AST nodes in a subtree (trace counters)."""
+    return 1 + sum(count_nodes(child) for child in iter_child_nodes(node))
+
+def structural_hash(node: ASTNode) -> str:
+    """Hash of a subtree's structure; identical code hashes identically."""
+    import hashlib
+    return hashlib.sha256(repr(node).encode()).hexdigest()
+
+class IncrementalCompiler:
+    """
+    Per-function optimizer and code generation cache on top of CompilationCache.
+    
+    The PassManager runs the usual whole-program worklist, but asks this
+    cache before applying a group of function passes to a function outside
+    any call cycle. The key covers everything the group can see: the
+    function itself, the signature and constant-return summary of every
+    callee, global and prototype declarations, and the pipeline. An edit
+    therefore reoptimizes the changed function and the callers whose view
+    of it changed, and nothing else. Module passes (dead function removal)
+    still see the whole program, so the result matches an uncached build.
+    
+    Each optimized function is then generated on its own and spliced back
+    in declaration order, and peephole optimization runs over the spliced
+    file. A fragment's key is the optimized function's structural hash, so
+    only functions whose optimized code changed are regenerated.
+    """
+    
+    def __init__(self, compiler: 'CCompiler', cache: CompilationCache):
+        self.compiler = compiler
+        self.cache = cache
+        self.reused = []       # Functions spliced from cache
+        self.regenerated = []  # Functions generated afresh
+        self.optimized_reused = []  # Function pass groups taken from cache
+        self.reoptimized = []       # Function pass groups run afresh
+    
+    def optimized_key(self, func: FunctionDeclaration, group: int,
+                      analyses: 'AnalysisManager') -> str:
+        """Key for func after function pass group number group."""
+        callees = []
+        for name in sorted(analyses.get('calls', func)):
+            callee = analyses.functions.get(name)
+            if callee is not None:
+                signature = f"{callee.return_type} {name}({','.join(p.type for p in callee.parameters)})"
+                callees.append(f"{signature}={analyses.get('returns', callee)!r}")
+        context = [repr(d) for d in analyses.program.declarations
+                   if not (isinstance(d, FunctionDeclaration) and d.body)]
+        generator = self.compiler.code_generator
+        return CompilationCache.make_key(
+            repr(func).encode(), self.compiler.optimization_level, False, "optimized",
+            f"passes={self.compiler.optimizer.pipeline_text()};group={group}",
+            ";".join(callees), "\n".join(context),
+            serialize_ast(func).hex() if generator.debug_file else "")
+    
+    def lookup_optimized(self, func: FunctionDeclaration, group: int,
+                         analyses: 'AnalysisManager') -> Tuple[str, Optional[FunctionDeclaration]]:
+        """Return (key, cached result of the group on func or None)."""
+        key = self.optimized_key(func, group, analyses)
+        with tracer.span(f"optimizer cache lookup {func.name}", "cache") as span:
+            cached = self.cache.lookup(key, 'opt')
+            span.set(hit=cached is not None)
+        if cached is None:
+            return key, None
+        self.optimized_reused.append(func.name)
+        return key, deserialize_ast(cached)
+    
+    def store_optimized(self, key: str, func: FunctionDeclaration):
+        self.reoptimized.append(func.name)
+        self.cache.store(key, 'opt', serialize_ast(func))
+    
+    def build(self, program: Program) -> str:
+        """Produce the assembly for an optimized AST."""
+        generator = self.new_code_generator()
+        lines = []
+        generator.output = lines
+        generator.generate_program_header()
+        functions = 0
+        for decl in program.declarations:
+            if isinstance(decl, FunctionDeclaration) and decl.body:
+                lines.append(self.function_fragment(decl))
+                functions += 1
+            else:
+                generator.generate_declaration(decl)
+        generator.generate_entry_stub(program.declarations)
+        if generator.debug_file:
+            generator.generate_debug_info(program)
+        
+        if self.optimized_reused or self.reoptimized:
+            log.info("   ♻️  Reused optimizer results for %s of %s functions outside call cycles",
+                     len(self.optimized_reused), len(self.optimized_reused) + len(self.reoptimized))
+        if self.reoptimized:
+            log.info("   🔁 Reoptimized: %s", ', '.join(self.reoptimized))
+        log.info("   ♻️  Reused %s of %s functions from cache", len(self.reused), functions)
+        if self.regenerated:
+            log.info("   🔁 Regenerated: %s", ', '.join(self.regenerated))
+        assembly = "\n".join(lines)
+        if self.compiler.optimizer.peephole:
+            assembly = self.compiler.optimizer.optimize_assembly(assembly)
+        return assembly
+    
+    def fragment_key(self, func: FunctionDeclaration) -> str:
+        generator = self.compiler.code_generator
+        return CompilationCache.make_key(
+            repr(func).encode(), 0, generator.use_advanced_allocation, "function",
+            # repr() leaves out source spans, which only matter for line tables
+            f"debug={generator.debug_file}",
+            serialize_ast(func).hex() if generator.debug_file else "")
+    
+    def function_fragment(self, func: FunctionDeclaration) -> str:
+        """Fetch an optimized function's assembly from cache, or generate it."""
+        key = self.fragment_key(func)
+        with tracer.span(f"fragment cache lookup {func.name}", "cache") as span:
+            cached = self.cache.lookup(key, 'fn')
+            span.set(hit=cached is not None)
+        if cached is not None:
+            self.reused.append(func.name)
+            return cached.decode()
+        
+        assembly = self.new_code_generator().generate_fragment(func)
+        self.regenerated.append(func.name)
+        self.cache.store(key, 'fn', assembly.encode())
+        return assembly
+    
+    def new_code_generator(self) -> CodeGenerator:
+        current = self.compiler.code_generator
+        generator = CodeGenerator()
+        generator.set_advanced_allocation(current.use_advanced_allocation)
+        generator.set_debug_info(current.debug_file)
+        generator.emit_entry_stub = current.emit_entry_stub
+        return generator
+
+# ============================================================================
+# MAIN COMPILER CLASS
+# ============================================================================
+
+class CCompiler:
+    """Main C Compiler class coordinating all compilation phases."""
+    
+    def __init__(self):
+        self.lexer = None
+        self.parser = None
+        self.semantic_analyzer = None
+        self.code_generator = CodeGenerator()
+        self.optimizer = OptimizationManager()
+        self.optimization_level = 1  # Default optimization level
+        self.errors = []  # Diagnostics from the last compile, for build reports
+        self.cache = None  # Optional CompilationCache
+        self.cache_key = None  # Key of the last compiled source, reused for objects
+        self.debug_info = False  # Emit DWARF line tables (-g)
+    
+    def set_optimization_level(self, level: Union[int, str]):
+        """Set optimization level (0=none, 1=basic, 2=aggressive, 3=maximum, 's'=size)."""
+        self.optimization_level = 2 if level == 's' else level
+        self.optimizer.set_optimization_level(level)
+    
+    def set_pipeline(self, passes: str):
+        """Replace the level's optimization pipeline (--passes)."""
+        self.optimizer.set_pipeline(passes)
+    
+    def set_cache(self, cache: Optional['CompilationCache']):
+        """Enable the persistent compilation cache for assembly and objects."""
+        self.cache = cache
+    
+    def set_debug_info(self, enabled: bool):
+        """Emit DWARF line tables so debuggers can map instructions to source (-g)."""
+        self.debug_info = enabled
+    
+    def set_whole_program(self, enabled: bool):
+        """
+        Declare whether the source file is the entire program.
+        
+        Separately compiled units must keep functions that only other files
+        call and must not define their own _start entry stub.
+        """
+        self.optimizer.set_whole_program(enabled)
+        self.code_generator.emit_entry_stub = enabled
+    
+    def _format_ast_node(self, node: ASTNode, max_length: int = 80) -> str:
+        """Format AST node for readable debugging output."""
+        if isinstance(node, FunctionDeclaration):
+            param_str = f"({len(node.parameters)} params)" if node.parameters else "()"
+            body_str = "with body" if node.body else "declaration only"
+            return f"{node.return_type} {node.name}{param_str} {body_str}"
+        elif isinstance(node, VariableDeclaration):
+            init_str = "with initializer" if node.initializer else "no initializer"
+            return f"{node.type} {node.name} ({init_str})"
+        elif isinstance(node, BinaryExpression):
+            return f"({self._format_ast_node(node.left, 20)} {node.operator} {self._format_ast_node(node.right, 20)})"
+        elif isinstance(node, Identifier):
+            return node.name
+        elif isinstance(node, IntegerLiteral):
+            return str(node.value)
+        elif isinstance(node, StringLiteral):
+            return f'"{node.value}"'
+        else:
+            result = str(node)
+            return result[:max_length] + "..." if len(result) > max_length else result
+    
+    def parse_source(self, source_code: str) -> Program:
+        """
+        Run phases 1 and 2, reusing a cached binary AST when one exists.
+        
+        Only ASTs parsed without recovered errors are cached, so a cache
+        hit never hides a parse error.
+        """
+        ast_key = None
+        if self.cache:
+            ast_key = CompilationCache.make_key(source_code.encode(), 0, False,
+                                                f"ast-format={AST_FORMAT_VERSION}")
+            data = self.cache.lookup(ast_key, 'ast')
+            if data is not None:
+                try:
+                    with tracer.span("load cached ast", bytes=len(data)):
+                        ast = deserialize_ast(data)
+                    log.info("💾 Phases 1-2: Reused parsed AST from cache")
+                    return ast
+                except ASTFormatError as e:
+                    log.debug("   Ignoring unreadable cached AST: %s", e)
+        
+        # Phase 1: Lexical Analysis
+        log.info("📝 Phase 1: Lexical Analysis (Tokenization)...")
+        with tracer.span("lex", bytes=len(source_code)) as span:
+            self.lexer = Lexer(source_code)
+            tokens = self.lexer.tokenize()
+            span.set(tokens=len(tokens))
+        log.debug("   Generated %s tokens", len(tokens))
+        
+        # Debug: Print first 10 tokens
+        if log.enabled(LogLevel.TRACE):
+            log.trace("   First 10 tokens:")
+            for i, token in enumerate(tokens[:10]):
+                log.trace("     %s. %s", i+1, token)
+        
+        # Phase 2: Syntax Analysis (Parsing)
+        log.info("🌳 Phase 2: Syntax Analysis (Parsing)...")
+        with tracer.span("parse") as span:
+            self.parser = Parser(tokens)
+            ast = self.parser.parse()
+            if tracer.enabled:
+                span.set(declarations=len(ast.declarations), nodes=count_nodes(ast))
+        log.debug("   Generated AST with %s top-level declarations", len(ast.declarations))
+        
+        if ast_key and not self.parser.errors:
+            self.cache.store(ast_key, 'ast', serialize_ast(ast))
+        return ast
+    
+    def analyze_source(self, source_code: str,
+                       function_cache: Optional['IncrementalCompiler'] = None) -> Optional[Program]:
+        """
+        Run the front end and AST optimizer (phases 1 to 3.5).
+        
+        Returns the optimized AST, or None if semantic analysis failed.
+        Lexer and parser errors propagate as exceptions. A function_cache
+        lets the optimizer reuse functions whose inputs did not change.
+        """
+        ast = self.parse_source(source_code)
+        
+        # Debug: Print AST structure
+        if log.enabled(LogLevel.TRACE):
+            log.trace("   AST Structure:")
+            for i, decl in enumerate(ast.declarations[:3]):  # Show first 3 declarations
+                log.trace("     %s. %s: %s", i+1, type(decl).__name__, self._format_ast_node(decl))
+        
+        # Phase 3: Semantic Analysis
+        log.info("🔍 Phase 3: Semantic Analysis...")
+        with tracer.span("semantic") as span:
+            self.semantic_analyzer = SemanticAnalyzer()
+            semantic_success = self.semantic_analyzer.analyze(ast)
+            span.set(errors=len(self.semantic_analyzer.errors))
+        
+        if not semantic_success:
+            log.error("   ❌ Found %s semantic errors:", len(self.semantic_analyzer.errors))
+            for error in self.semantic_analyzer.errors:
+                log.error("     • %s", error.message)
+                self.errors.append(f"Semantic Error: {error.message}")
+            return None
+        
+        log.info("   ✅ Semantic analysis completed successfully!")
+        
+        # Phase 3.5: AST Optimization  
+        if self.optimizer.has_ast_passes():
+            log.info("🔧 Phase 3.5: AST Optimization...")
+            optimized_ast = self.optimizer.optimize_ast(ast, function_cache)
+            log.info("   ✅ AST optimization completed successfully!")
+        else:
+            log.info("⏩ Phase 3.5: AST Optimization - SKIPPED (O0)")
+            optimized_ast = ast
+        
+        return optimized_ast
+    
+    def compile(self, source_file: str, output_file: str = None) -> bool:
+        """Compile C source file to executable."""
+        try:
+            with tracer.span(f"compile {source_file}", "driver"):
+                # Read source code
+                with open(source_file, 'r') as f:
+                    source_code = f.read()
+                
+                log.info("🚀 Compiling %s...", source_file)
+                
+                output_filename = source_file.replace('.c', '.s')
+                self.code_generator.set_debug_info(source_file if self.debug_info else None)
+                self.cache_key = None
+                if self.cache:
+                    self.cache_key = CompilationCache.make_key(
+                        source_code.encode(), self.optimization_level,
+                        self.code_generator.use_advanced_allocation,
+                        f"whole_program={int(self.code_generator.emit_entry_stub)};"
+                        f"passes={self.optimizer.pipeline_text()}",
+                        f"debug={self.code_generator.debug_file}")
+                    cached_assembly = self.cache.lookup(self.cache_key, 's')
+                    if cached_assembly is not None:
+                        with open(output_filename, 'wb') as f:
+                            f.write(cached_assembly)
+                        log.info("💾 Cache hit: reused assembly for %s", source_file)
+                        log.info("   ✅ Generated optimized assembly: %s", output_filename)
+                        return True
+                    log.info("💾 Cache miss")
+                    
+                    # Optimize and generate only the functions whose inputs changed
+                    incremental = IncrementalCompiler(self, self.cache)
+                    optimized_ast = self.analyze_source(source_code, incremental)
+                    if optimized_ast is None:
+                        return False
+                    log.info("♻️  Phases 4-4.5: Incremental per-function code generation...")
+                    with tracer.span("incremental codegen"):
+                        optimized_assembly = incremental.build(optimized_ast)
+                    return self.write_assembly(output_filename, optimized_assembly)
+                
+                optimized_ast = self.analyze_source(source_code)
+                if optimized_ast is None:
+                    return False
+                
+                # Phase 4: Code Generation
+                log.info("⚙️ Phase 4: Code Generation...")
+                with tracer.span("codegen"):
+                    assembly_code = self.code_generator.generate(optimized_ast)
+                
+                # Phase 4.5: Assembly Optimization
+                if self.optimizer.peephole:
+                    log.info("🔧 Phase 4.5: Assembly Optimization...")
+                    optimized_assembly = self.optimizer.optimize_assembly(assembly_code)
+                    log.info("   ✅ Assembly optimization completed successfully!")
+                else:
+                    log.info("⏩ Phase 4.5: Assembly Optimization - SKIPPED (O0)")
+                    optimized_assembly = assembly_code
+                
+                return self.write_assembly(output_filename, optimized_assembly)
+                
+        except FileNotFoundError:
+            log.error("❌ Error: Source file '%s' not found.", source_file)
+            self.errors.append(f"Source file '{source_file}' not found")
+            return False
+        except SyntaxError as e:
+            log.error("❌ Syntax Error: %s", e)
+            self.errors.append(f"Syntax Error: {e}")
+            return False
+        except Exception as e:
+            log.error("❌ Compilation Error: %s", e)
+            self.errors.append(f"Compilation Error: {e}")
+            return False
+    
+    def write_assembly(self, output_filename: str, optimized_assembly: str) -> bool:
+        """Write the final assembly (and publish it to the cache)."""
+        with open(output_filename, 'w') as f:
+            f.write(optimized_assembly)
+        if self.cache:
+            self.cache.store(self.cache_key, 's', optimized_assembly.encode())
+        
+        log.info("   ✅ Generated optimized assembly: %s", output_filename)
+        log.info("   Generated %s lines of x86-64 assembly", len(optimized_assembly.split()))
+        
+        # TODO: Phase 5: Assembly & Linking
+        log.info("🔗 Phase 5: Assembly & Linking - TODO")
+        
+        log.info("✅ Compilation completed successfully!")
+        return True
+    
+    def compile_ir(self, source_file: str, ir_file: str) -> bool:
+        """
+        Compile a source file to optimized IR for link-time optimization.
+        
+        The IR is the binary AST after per-unit optimization; code generation
+        waits until every unit of the program has been merged.
+        """
+        try:
+            with tracer.span(f"compile {source_file} (lto)", "driver"):
+                with open(source_file, 'r') as f:
+                    source_code = f.read()
+                
+                log.info("🚀 Compiling %s to LTO IR...", source_file)
+                optimized_ast = self.analyze_source(source_code)
+                if optimized_ast is None:
+                    return False
+                
+                with tracer.span("serialize ir"):
+                    data = serialize_ast(optimized_ast)
+                with open(ir_file, 'wb') as f:
+                    f.write(data)
+                log.info("   ✅ Wrote LTO IR: %s (%s bytes)", ir_file, len(data))
+                return True
+        
+        except FileNotFoundError:
+            log.error("❌ Error: Source file '%s' not found.", source_file)
+            self.errors.append(f"Source file '{source_file}' not found")
+            return False
+        except SyntaxError as e:
+            log.error("❌ Syntax Error: %s", e)
+            self.errors.append(f"Syntax Error: {e}")
+            return False
+        except Exception as e:
+            log.error("❌ Compilation Error: %s", e)
+            self.errors.append(f"Compilation Error: {e}")
+            return False
+    
+    def assemble(self, assembly_file: str, object_file: str) -> bool:
+        """Assemble a .s file into an object file with the GNU assembler."""
+        import subprocess
+        
+        if self.cache and self.cache_key:
+            cached_object = self.cache.lookup(self.cache_key, 'o')
+            if cached_object is not None:
+                with open(object_file, 'wb') as f:
+                    f.write(cached_object)
+                log.info("   💾 Cache hit: reused object file %s", object_file)
+                return True
+        
+        try:
+            with tracer.span(f"assemble {object_file}", "toolchain"):
+                result = subprocess.run(['as', '--64', '-o', object_file, assembly_file],
+                                        capture_output=True, text=True)
+        except FileNotFoundError as e:
+            log.error("❌ Tool not found: %s. Install GNU binutils (as, ld)", e)
+            self.errors.append(f"Tool not found: {e}")
+            return False
+        
+        if result.returncode != 0:
+            log.error("❌ Assembly failed: %s", result.stderr)
+            self.errors.append(f"Assembly failed: {result.stderr.strip()}")
+            return False
+        
+        if self.cache and self.cache_key:
+            with open(object_file, 'rb') as f:
+                self.cache.store(self.cache_key, 'o', f.read())
+        
+        log.info("   ✅ Assembled object file: %s", object_file)
+        return True
+    
+    def link(self, object_files: List[str], output_file: str) -> bool:
+        """Link object files into an executable with the GNU linker."""
+        import subprocess
+        
+        try:
+            with tracer.span(f"link {output_file}", "toolchain", objects=len(object_files)):
+                result = subprocess.run(['ld', '-o', output_file] + list(object_files),
+                                        capture_output=True, text=True)
+        except FileNotFoundError as e:
+            log.error("❌ Tool not found: %s. Install GNU binutils (as, ld)", e)
+            self.errors.append(f"Tool not found: {e}")
+            return False
+        
+        if result.returncode != 0:
+            log.error("❌ Linking failed: %s", result.stderr)
+            self.errors.append(f"Linking failed: {result.stderr.strip()}")
+            return False
+        
+        log.info("   ✅ Created executable: %s", output_file)
+        return True
+    
+    def compile_to_executable(self, source_file: str, output_file: str = None) -> bool:
+        """Compile C source to executable binary."""
+        try:
+            # First compile to assembly
+            if not self.compile(source_file):
+                return False
+            
+            # Determine file names
+            assembly_file = source_file.replace('.c', '.s')
+            if not output_file:
+                output_file = source_file.replace('.c', '')
+            
+            # Phase 5: Assembly & Linking
+            log.info("🔗 Phase 5: Assembly & Linking...")
             
-            # Write optimized assembly to output file
-            output_filename = source_file.replace('.c', '.s')
-            with open(output_filename, 'w') as f:
-                f.write(optimized_assembly)
+            # Assemble to object file
+            object_file = source_file.replace('.c', '.o')
+            if not self.assemble(assembly_file, object_file):
+                return False
             
-            print(f"   ✅ Generated optimized assembly: {output_filename}")
-            print(f"   Generated {len(optimized_assembly.split())} lines of x86-64 assembly")
+            # Link to executable
+            if not self.link([object_file], output_file):
+                return False
             
-            # TODO: Phase 5: Assembly & Linking
-            print("🔗 Phase 5: Assembly & Linking - TODO")
+            log.info("   Run with: ./%s", output_file)
             
-            print(f"✅ Compilation completed successfully!")
             return True
             
+        except Exception as e:
+            log.error("❌ Build error: %s", e)
+            return False
+
+    def profile_run(self, source_file: str, output_file: str = None) -> Optional[int]:
+        """
+        Build source_file with line tables, run it under a sampling profiler
+        and print its hottest functions and source lines.
+        
+        Returns the program's exit status, or None if the build or run failed.
+        """
+        self.set_debug_info(True)
+        executable = output_file or source_file.replace('.c', '')
+        if not self.compile_to_executable(source_file, executable):
+            return None
+        
+        log.info("🔥 Profiling ./%s...", executable)
+        sys.stdout.flush()
+        profiler = SamplingProfiler()
+        with tracer.span("profile run") as span:
+            if not profiler.run(executable):
+                return None
+            span.set(samples=len(profiler.samples), method=profiler.method)
+        profiler.report(SourceMap(executable))
+        return profiler.exit_status
+    
+    def run(self, source_file: str, dump_bytecode: bool = False) -> Optional[int]:
+        """
+        Compile C source to bytecode and execute it on the built-in VM.
+        
+        Needs no assembler or linker. Returns main's return value, or None
+        if compilation or execution failed.
+        """
+        try:
+            with open(source_file, 'r') as f:
+                source_code = f.read()
+            
+            log.info("🚀 Compiling %s for the bytecode VM...", source_file)
+            
+            optimized_ast = self.analyze_source(source_code)
+            if optimized_ast is None:
+                return None
+            
+            # Phase 4: Bytecode Lowering
+            log.info("⚙️ Phase 4: Bytecode Lowering...")
+            with tracer.span("bytecode lowering"):
+                module = BytecodeCompiler().compile_program(optimized_ast)
+            log.info("   Generated %s instructions (%s superinstructions) for %s functions", module.instruction_count(), module.superinstructions, len(module.functions))
+            
+            if dump_bytecode:
+                print(module.disassemble())
+            
+            # Phase 5: Execution
+            log.info("🏃 Phase 5: Executing on bytecode VM...")
+            sys.stdout.flush()
+            with tracer.span("vm execute", "vm"):
+                result = BytecodeVM(module).run("main")
+            sys.stdout.flush()
+            return int(result)
+        
         except FileNotFoundError:
-            print(f"❌ Error: Source file '{source_file}' not found.")
+            log.error("❌ Error: Source file '%s' not found.", source_file)
+            return None
+        except SyntaxError as e:
+            log.error("❌ Syntax Error: %s", e)
+            return None
+        except RecursionError:
+            log.error("❌ Runtime Error: maximum call depth exceeded")
+            return None
+        except VMError as e:
+            log.error("❌ Runtime Error: %s", e)
+            return None
+
+# ============================================================================
+# PROFILING RUN
+# ============================================================================
+
+class SourceMap:
+    """
+    Address-to-source map of an executable built with -g: function labels
+    from the ELF symbol table and rows of the .debug_line program that the
+    assembler built from our .loc directives.
+    """
+    
+    def __init__(self, executable: str):
+        self.symbols = []  # Sorted (address, name) of global labels in .text
+        self.rows = []     # Sorted (address, file, line); line 0 ends a sequence
+        self.files = {}    # DWARF file index -> path
+        self.load(executable)
+    
+    def load(self, executable: str):
+        import struct
+        with open(executable, 'rb') as f:
+            image = f.read()
+        if image[:4] != b'\x7fELF' or image[4] != 2:
+            raise ValueError(f"{executable} is not a 64-bit ELF file")
+        shoff, = struct.unpack_from('<Q', image, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', image, 0x3A)
+        headers = [struct.unpack_from('<IIQQQQIIQQ', image, shoff + i * shentsize)
+                   for i in range(shnum)]
+        names_offset = headers[shstrndx][4]
+        sections = {}
+        for index, header in enumerate(headers):
+            end = image.index(b'\0', names_offset + header[0])
+            sections[image[names_offset + header[0]:end].decode()] = (index, header)
+        
+        text_index, text = sections.get('.text', (None, None))
+        if '.symtab' in sections and text:
+            _, symtab = sections['.symtab']
+            strtab = headers[symtab[6]][4]
+            for offset in range(symtab[4], symtab[4] + symtab[5], 24):
+                name, info, _, shndx, value, _ = struct.unpack_from('<IBBHQQ', image, offset)
+                # STB_GLOBAL labels inside .text (the linker also defines _end and friends)
+                if info >> 4 == 1 and shndx == text_index and text[3] <= value < text[3] + text[5]:
+                    end = image.index(b'\0', strtab + name)
+                    self.symbols.append((value, image[strtab + name:end].decode()))
+        self.symbols.sort()
+        
+        if '.debug_line' in sections:
+            _, line_section = sections['.debug_line']
+            self.parse_line_program(image[line_section[4]:line_section[4] + line_section[5]])
+        self.rows.sort()
+        self.row_addresses = [row[0] for row in self.rows]
+        self.symbol_addresses = [address for address, _ in self.symbols]
+        
+        # main is emitted as _start; the exit-only stub has no line rows
+        if not any(name == 'main' for _, name in self.symbols):
+            self.symbols = [(address, 'main' if name == '_start' and self.lookup_line(address) else name)
+                            for address, name in self.symbols]
+    
+    def parse_line_program(self, data: bytes):
+        """Decode DWARF 2-4 line number programs (the versions `as` emits for .loc)."""
+        import struct
+        
+        def uleb(pos):
+            result = shift = 0
+            while True:
+                byte = data[pos]
+                pos += 1
+                result |= (byte & 0x7f) << shift
+                shift += 7
+                if byte < 0x80:
+                    return result, pos
+        
+        def sleb(pos):
+            result = shift = 0
+            while True:
+                byte = data[pos]
+                pos += 1
+                result |= (byte & 0x7f) << shift
+                shift += 7
+                if byte < 0x80:
+                    return (result - (1 << shift) if byte & 0x40 else result), pos
+        
+        def string(pos):
+            end = data.index(b'\0', pos)
+            return data[pos:end].decode(), end + 1
+        
+        unit = 0
+        while unit < len(data):
+            length, version, header_length = struct.unpack_from('<IHI', data, unit)
+            unit_end = unit + 4 + length
+            if version > 4:
+                log.info("⚠️  DWARF %s line tables are not supported; no source lines", version)
+                return
+            pos = unit + 10
+            min_length = data[pos]
+            pos += 2 if version >= 4 else 1  # maximum_operations_per_instruction since v4
+            pos += 1  # default_is_stmt
+            line_base = struct.unpack_from('<b', data, pos)[0]
+            line_range, opcode_base = data[pos + 1], data[pos + 2]
+            lengths = data[pos + 3:pos + 2 + opcode_base]
+            pos += 2 + opcode_base
+            while data[pos]:  # include_directories
+                _, pos = string(pos)
+            pos += 1
+            index = 1
+            while data[pos]:  # file_names
+                self.files[index], pos = string(pos)
+                for _ in range(3):  # directory, mtime, length
+                    _, pos = uleb(pos)
+                index += 1
+            
+            pos = unit + 10 + header_length
+            address, file, line = 0, 1, 1
+            while pos < unit_end:
+                opcode = data[pos]
+                pos += 1
+                if opcode >= opcode_base:
+                    adjusted = opcode - opcode_base
+                    address += (adjusted // line_range) * min_length
+                    line += line_base + adjusted % line_range
+                    self.rows.append((address, file, line))
+                elif opcode == 0:
+                    length, pos = uleb(pos)
+                    sub = data[pos]
+                    if sub == 1:  # end_sequence
+                        self.rows.append((address, file, 0))
+                        address, file, line = 0, 1, 1
+                    elif sub == 2:  # set_address
+                        address, = struct.unpack_from('<Q', data, pos + 1)
+                    pos += length
+                elif opcode == 1:  # copy
+                    self.rows.append((address, file, line))
+                elif opcode == 2:  # advance_pc
+                    delta, pos = uleb(pos)
+                    address += delta * min_length
+                elif opcode == 3:  # advance_line
+                    delta, pos = sleb(pos)
+                    line += delta
+                elif opcode == 4:  # set_file
+                    file, pos = uleb(pos)
+                elif opcode == 8:  # const_add_pc
+                    address += ((255 - opcode_base) // line_range) * min_length
+                elif opcode == 9:  # fixed_advance_pc
+                    address += struct.unpack_from('<H', data, pos)[0]
+                    pos += 2
+                else:  # set_column, set_isa and flags: skip their operands
+                    for _ in range(lengths[opcode - 1]):
+                        _, pos = uleb(pos)
+            unit = unit_end
+    
+    def lookup_function(self, address: int) -> Optional[str]:
+        import bisect
+        index = bisect.bisect_right(self.symbol_addresses, address) - 1
+        return self.symbols[index][1] if index >= 0 else None
+    
+    def lookup_line(self, address: int) -> Optional[Tuple[str, int]]:
+        import bisect
+        index = bisect.bisect_right(self.row_addresses, address) - 1
+        if index < 0 or self.rows[index][2] == 0:
+            return None
+        _, file, line = self.rows[index]
+        return self.files.get(file, '?'), line
+
+class SamplingProfiler:
+    """
+    Sample an executable's program counter while it runs (--profile-run).
+    
+    Uses `perf record` when it is installed and allowed; otherwise the
+    child runs under ptrace and is stopped with SIGSTOP at a fixed rate so
+    its instruction pointer can be read.
+    """
+    
+    FREQUENCY = 1000  # Samples per second
+    
+    def __init__(self):
+        self.samples = []   # Instruction pointers
+        self.method = None  # 'perf' or 'ptrace'
+        self.exit_status = None
+    
+    def run(self, executable: str) -> bool:
+        import shutil
+        executable = os.path.abspath(executable)
+        if shutil.which('perf') and self.run_perf(executable):
+            self.method = 'perf'
+            return True
+        self.method = 'ptrace'
+        return self.run_ptrace(executable)
+    
+    def run_perf(self, executable: str) -> bool:
+        import subprocess
+        import tempfile
+        with tempfile.TemporaryDirectory() as tmp:
+            data = os.path.join(tmp, 'perf.data')
+            record = subprocess.run(['perf', 'record', '-q', '-F', str(self.FREQUENCY),
+                                     '-e', 'cpu-clock', '-o', data, '--', executable],
+                                    stderr=subprocess.PIPE, text=True)
+            script = subprocess.run(['perf', 'script', '-i', data, '-F', 'ip'],
+                                    capture_output=True, text=True)
+            if script.returncode != 0 or not os.path.exists(data):
+                reason = (record.stderr or script.stderr).strip().splitlines() or ["no data"]
+                log.info("   perf unavailable (%s), falling back to the ptrace sampler", reason[-1])
+                return False
+        # perf reports the program's status as its own; a negative one is a signal
+        self.exit_status = record.returncode
+        self.samples = [int(line, 16) for line in script.stdout.split() if line]
+        return True
+    
+    def run_ptrace(self, executable: str) -> bool:
+        import ctypes
+        import signal
+        import time
+        PTRACE_TRACEME, PTRACE_CONT, PTRACE_GETREGS = 0, 7, 12
+        RIP = 16  # Index of rip in struct user_regs_struct
+        
+        libc = ctypes.CDLL(None, use_errno=True)
+        libc.ptrace.restype = ctypes.c_long
+        libc.ptrace.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_void_p, ctypes.c_void_p]
+        
+        pid = os.fork()
+        if pid == 0:
+            try:
+                libc.ptrace(PTRACE_TRACEME, 0, None, None)
+                os.execv(executable, [executable])
+            finally:
+                os._exit(127)
+        
+        _, status = os.waitpid(pid, 0)  # Stopped by SIGTRAP after exec
+        if not os.WIFSTOPPED(status):
+            log.error("❌ Could not start %s under ptrace", executable)
+            return False
+        regs = (ctypes.c_ulonglong * 27)()
+        interval = 1.0 / self.FREQUENCY
+        pending = 0  # Signal to pass on when the child resumes
+        try:
+            while True:
+                if libc.ptrace(PTRACE_CONT, pid, None, ctypes.c_void_p(pending)) != 0:
+                    log.error("❌ ptrace failed: %s", os.strerror(ctypes.get_errno()))
+                    os.kill(pid, signal.SIGKILL)
+                    os.waitpid(pid, 0)
+                    return False
+                pending = 0
+                time.sleep(interval)
+                try:
+                    os.kill(pid, signal.SIGSTOP)
+                except ProcessLookupError:
+                    pass
+                _, status = os.waitpid(pid, 0)
+                if os.WIFEXITED(status):
+                    self.exit_status = os.WEXITSTATUS(status)
+                    return True
+                if os.WIFSIGNALED(status):
+                    self.exit_status = -os.WTERMSIG(status)
+                    return True
+                if os.WSTOPSIG(status) == signal.SIGSTOP:
+                    if libc.ptrace(PTRACE_GETREGS, pid, None, regs) == 0:
+                        self.samples.append(regs[RIP])
+                else:
+                    pending = os.WSTOPSIG(status)  # The program's own signal, e.g. SIGSEGV
+        except KeyboardInterrupt:
+            # Stop a runaway program but still report what was sampled
+            os.kill(pid, signal.SIGKILL)
+            os.waitpid(pid, 0)
+            self.exit_status = -signal.SIGINT
+            return True
+    
+    def report(self, source_map: SourceMap, top: int = 10):
+        """Print the hottest functions and source lines."""
+        from collections import Counter
+        total = len(self.samples)
+        print(f"🔥 Profile: {total} samples ({self.method}, {self.FREQUENCY} Hz), "
+              f"exit status {self.exit_status}")
+        if not total:
+            return
+        functions = Counter(source_map.lookup_function(ip) or '[unknown]' for ip in self.samples)
+        lines = Counter(source_map.lookup_line(ip) for ip in self.samples)
+        
+        print(f"   {'Samples':>8} {'%':>6}  Function")
+        for name, count in functions.most_common(top):
+            print(f"   {count:>8} {100 * count / total:>5.1f}%  {name}")
+        
+        sources = {}
+        print(f"\n   {'Samples':>8} {'%':>6}  Line")
+        for location, count in lines.most_common(top):
+            if location is None:
+                print(f"   {count:>8} {100 * count / total:>5.1f}%  [no line information]")
+                continue
+            path, line = location
+            if path not in sources:
+                try:
+                    with open(path) as f:
+                        sources[path] = f.read().splitlines()
+                except OSError:
+                    sources[path] = []
+            text = sources[path][line - 1].strip() if line <= len(sources[path]) else ""
+            print(f"   {count:>8} {100 * count / total:>5.1f}%  {path}:{line:<5} {text}")
+
+# ============================================================================
+# PARALLEL BUILD DRIVER
+# ============================================================================
+
+@dataclass
+class BuildOptions:
+    """Per-file compilation settings shared by every worker in a build."""
+    optimization_level: Union[int, str] = 1  # 0-3 or 's'
+    advanced_registers: bool = True
+    emit_object: bool = False   # Assemble each .s into a .o
+    whole_program: bool = True  # Only when this one unit is linked into the executable
+    cache_dir: Optional[str] = None   # Shared CompilationCache directory, if enabled
+    cache_max_size: Optional[int] = None
+    log_level: LogLevel = LogLevel.INFO
+    trace: bool = False  # Record trace events and return them with the result
+    lto: bool = False    # Emit optimized IR (.ir) for link-time optimization instead of assembly
+    codegen_jobs: int = 1  # Worker processes for per-function code generation
+    passes: Optional[str] = None  # --passes pipeline replacing the level's default
+    remarks: bool = False  # Write optimization remarks to <unit>.opt.jsonl
+    debug_info: bool = False  # Emit DWARF line tables (-g)
+
+@dataclass
+class CompileResult:
+    """Outcome of compiling one translation unit in a worker."""
+    source: str
+    success: bool
+    log: str                    # Captured compiler output for this file
+    assembly_file: Optional[str] = None
+    object_file: Optional[str] = None
+    errors: List[str] = None
+    seconds: float = 0.0
+    trace_events: List[Dict[str, Any]] = None  # Recorded when BuildOptions.trace is set
+    ir_file: Optional[str] = None  # Written instead of assembly when BuildOptions.lto is set
+
+def remarks_file(source_file: str) -> str:
+    """Default optimization record path for a unit (clang's <unit>.opt.yaml)."""
+    return os.path.splitext(source_file)[0] + '.opt.jsonl'
+
+def compile_unit(source_file: str, options: BuildOptions) -> CompileResult:
+    """
+    Compile one source file with a fresh CCompiler.
+    
+    Runs inside pool workers, so it must not touch any shared state; the
+    compiler's console output is captured and returned with the result.
+    """
+    import io
+    import time
+    import contextlib
+    
+    start = time.perf_counter()
+    output = io.StringIO()
+    log.set_level(options.log_level)
+    trace_mark = len(tracer.events)
+    if options.trace and not tracer.enabled:
+        tracer.enable()  # Spawned worker without the driver's tracer state
+        trace_mark = 0
+    compiler = CCompiler()
+    compiler.set_optimization_level(options.optimization_level)
+    if options.passes is not None:
+        compiler.set_pipeline(options.passes)
+    compiler.code_generator.set_advanced_allocation(options.advanced_registers)
+    compiler.code_generator.set_jobs(options.codegen_jobs)
+    compiler.set_whole_program(options.whole_program)
+    compiler.set_debug_info(options.debug_info)
+    if options.cache_dir:
+        compiler.set_cache(CompilationCache(options.cache_dir, options.cache_max_size))
+    if options.remarks:
+        remarks.enable()
+        remarks.begin(source_file)
+    
+    if options.lto:
+        ir_file = source_file.replace('.c', '.ir')
+        with contextlib.redirect_stdout(output):
+            success = compiler.compile_ir(source_file, ir_file)
+            if options.remarks:
+                remarks.save(remarks_file(source_file))
+        return CompileResult(source_file, success, output.getvalue(),
+                             errors=list(compiler.errors),
+                             seconds=time.perf_counter() - start,
+                             trace_events=tracer.events[trace_mark:] if options.trace else None,
+                             ir_file=ir_file if success else None)
+    
+    assembly_file = source_file.replace('.c', '.s')
+    object_file = None
+    with contextlib.redirect_stdout(output):
+        success = compiler.compile(source_file)
+        if options.remarks:
+            remarks.save(remarks_file(source_file))
+        if success and options.emit_object:
+            object_file = source_file.replace('.c', '.o')
+            success = compiler.assemble(assembly_file, object_file)
+    
+    return CompileResult(source_file, success, output.getvalue(),
+                         assembly_file if success else None,
+                         object_file if success else None,
+                         list(compiler.errors), time.perf_counter() - start,
+                         tracer.events[trace_mark:] if options.trace else None)
+
+class BuildDriver:
+    """
+    Compiles many translation units, optionally in a process pool (-j N).
+    
+    Every file gets its own CCompiler inside the worker, results are reported
+    in command-line order regardless of completion order, and all failures
+    are collected into one report before the final link step.
+    """
+    
+    def __init__(self, options: BuildOptions, jobs: int = 1):
+        self.options = options
+        self.jobs = max(1, jobs)
+        self.results = []
+    
+    def compile_all(self, sources: List[str]) -> List[CompileResult]:
+        """Compile every source file, returning results in input order."""
+        if self.jobs == 1 or len(sources) == 1:
+            self.results = [compile_unit(source, self.options) for source in sources]
+        else:
+            from concurrent.futures import ProcessPoolExecutor
+            with ProcessPoolExecutor(max_workers=min(self.jobs, len(sources))) as pool:
+                # map() yields in submission order, which keeps output deterministic
+                self.results = list(pool.map(compile_unit, sources,
+                                             [self.options] * len(sources)))
+            for result in self.results:
+                if result.trace_events:
+                    tracer.merge(result.trace_events)
+        return self.results
+    
+    def build(self, sources: List[str], output_file: Optional[str] = None,
+              link: bool = False) -> bool:
+        """Compile all sources, print per-file logs and link if requested."""
+        log.info("🏗️  Building %s files with %s job(s)...", len(sources), self.jobs)
+        results = self.compile_all(sources)
+        
+        for result in results:
+            if result.log:  # Empty when -q suppressed everything
+                print(f"\n──── {result.source} ({result.seconds * 1000:.1f} ms) ────")
+                print(result.log, end='')
+        
+        failed = [r for r in results if not r.success]
+        self.report(results)
+        if failed:
+            return False
+        
+        if link:
+            log.info("🔗 Linking...")
+            output_file = output_file or 'a.out'
+            if not CCompiler().link([r.object_file for r in results], output_file):
+                return False
+        
+        return True
+    
+    def report(self, results: List[CompileResult]):
+        """Print the aggregated build summary and every error by file."""
+        failed = [r for r in results if not r.success]
+        log.info("\n📋 Build summary: %s succeeded, %s failed", len(results) - len(failed), len(failed))
+        for result in results:
+            status = "✅" if result.success else "❌"
+            produced = result.object_file or result.assembly_file or result.ir_file or "-"
+            log.info("   %s %-30s → %s", status, result.source, produced)
+        
+        if failed:
+            log.error("❌ Errors:")
+            for result in failed:
+                for error in result.errors or ["Unknown error"]:
+                    log.error("   %s: %s", result.source, error)
+
+# ============================================================================
+# LINK-TIME OPTIMIZATION
+# ============================================================================
+
+def generate_lto_partition(data: bytes, options: BuildOptions, assembly_file: str,
+                           entry: bool) -> CompileResult:
+    """
+    Generate code for one partition of the merged program.
+    
+    Runs inside pool workers like compile_unit; the partition arrives as
+    serialized IR so workers share nothing with the link step.
+    """
+    import io
+    import time
+    import contextlib
+    
+    start = time.perf_counter()
+    output = io.StringIO()
+    log.set_level(options.log_level)
+    compiler = CCompiler()
+    compiler.set_optimization_level(options.optimization_level)
+    if options.passes is not None:
+        compiler.set_pipeline(options.passes)
+    compiler.code_generator.set_advanced_allocation(options.advanced_registers)
+    compiler.code_generator.set_jobs(options.codegen_jobs)
+    compiler.code_generator.emit_entry_stub = entry
+    
+    with contextlib.redirect_stdout(output):
+        try:
+            partition = deserialize_ast(data)
+            log.info("⚙️ Generating %s (%s functions)...", assembly_file,
+                     sum(1 for d in partition.declarations
+                         if isinstance(d, FunctionDeclaration) and d.body))
+            assembly_code = compiler.code_generator.generate(partition)
+            assembly_code = compiler.optimizer.optimize_assembly(assembly_code)
+            with open(assembly_file, 'w') as f:
+                f.write(assembly_code)
+            success = True
+        except Exception as e:
+            log.error("❌ Code generation error: %s", e)
+            compiler.errors.append(f"Code generation error: {e}")
+            success = False
+        
+        object_file = None
+        if success and options.emit_object:
+            object_file = assembly_file.replace('.s', '.o')
+            success = compiler.assemble(assembly_file, object_file)
+    
+    return CompileResult(assembly_file, success, output.getvalue(),
+                         assembly_file if success else None,
+                         object_file if success else None,
+                         list(compiler.errors), time.perf_counter() - start)
+
+class LinkTimeOptimizer:
+    """
+    Whole-program optimization across translation units (-flto).
+    
+    Each .c file is compiled to optimized IR (.ir, the binary AST) in the
+    usual worker pool. At link time all units are merged into one module,
+    checked again, and re-optimized with the whole program visible, so
+    constant returns and dead-function removal see through file
+    boundaries. Code is then generated in one or more partitions.
+    """
+    
+    def __init__(self, options: BuildOptions, jobs: int = 1, partitions: int = 1):
+        self.options = options
+        self.jobs = max(1, jobs)
+        self.partitions = max(1, partitions)
+        self.errors = []
+    
+    def build(self, sources: List[str], output_file: Optional[str] = None,
+              link: bool = False) -> bool:
+        """Compile .c sources to IR, merge them with any .ir inputs and generate code."""
+        import dataclasses
+        
+        c_sources = [s for s in sources if s.endswith('.c')]
+        if c_sources:
+            ir_options = dataclasses.replace(self.options, lto=True, whole_program=False)
+            if not BuildDriver(ir_options, self.jobs).build(c_sources):
+                return False
+        ir_files = [s.replace('.c', '.ir') if s.endswith('.c') else s for s in sources]
+        
+        stem = output_file or 'a.out'
+        with tracer.span("lto link", "driver", units=len(ir_files)):
+            program = self.merge(self.load(ir_files))
+            if program is not None:
+                if self.options.remarks:
+                    remarks.begin(None)  # The merged program has no single source file
+                program = self.optimize(program)
+                if self.options.remarks:
+                    remarks.save(remarks_file(stem))
+            if program is None:
+                self.report()
+                return False
+            
+            if not self.generate(program, stem, link):
+                self.report()
+                return False
+            
+            if link:
+                log.info("🔗 Linking...")
+                if not CCompiler().link([r.object_file for r in self.results], stem):
+                    return False
+        return True
+    
+    def load(self, ir_files: List[str]) -> List[Tuple[str, Program]]:
+        """Read every unit's IR; unreadable files are reported as errors."""
+        units = []
+        for ir_file in ir_files:
+            try:
+                with open(ir_file, 'rb') as f:
+                    units.append((ir_file, deserialize_ast(f.read())))
+            except (OSError, ASTFormatError) as e:
+                self.errors.append(f"{ir_file}: cannot read LTO IR: {e}")
+        return units
+    
+    def merge(self, units: List[Tuple[str, Program]]) -> Optional[Program]:
+        """
+        Link units into one Program.
+        
+        Prototypes are dropped where some unit defines the function, a global
+        with an initializer wins over plain declarations, and conflicting
+        definitions are errors. Globals come first so every function sees them.
+        """
+        if self.errors:
+            return None
+        log.info("🔗 LTO: Merging %s units...", len(units))
+        
+        functions = {}   # name -> (unit, declaration)
+        variables = {}
+        for unit, program in units:
+            for decl in program.declarations:
+                if isinstance(decl, FunctionDeclaration):
+                    previous = functions.get(decl.name)
+                    if previous and previous[1].body and decl.body:
+                        self.errors.append(f"multiple definition of function '{decl.name}' "
+                                           f"({previous[0]}, {unit})")
+                    elif not previous or decl.body:
+                        functions[decl.name] = (unit, decl)
+                elif isinstance(decl, VariableDeclaration):
+                    previous = variables.get(decl.name)
+                    if previous and previous[1].initializer and decl.initializer:
+                        self.errors.append(f"multiple definition of global '{decl.name}' "
+                                           f"({previous[0]}, {unit})")
+                    elif not previous or decl.initializer:
+                        variables[decl.name] = (unit, decl)
+        
+        if self.errors:
+            return None
+        declarations = ([decl for _, decl in variables.values()] +
+                        [decl for _, decl in functions.values()])
+        log.debug("   Merged %s functions and %s globals", len(functions), len(variables))
+        return Program(declarations)
+    
+    def optimize(self, program: Program) -> Optional[Program]:
+        """Check the merged module and re-run the optimizer over the whole program."""
+        compiler = CCompiler()
+        compiler.set_optimization_level(self.options.optimization_level)
+        if self.options.passes is not None:
+            compiler.set_pipeline(self.options.passes)
+        compiler.set_whole_program(True)
+        
+        log.info("🔍 LTO: Semantic analysis of the merged program...")
+        with tracer.span("lto semantic"):
+            analyzer = SemanticAnalyzer()
+            if not analyzer.analyze(program):
+                self.errors.extend(f"Semantic Error: {e.message}" for e in analyzer.errors)
+                return None
+        
+        if compiler.optimizer.has_ast_passes():
+            log.info("🔧 LTO: Whole-program optimization...")
+            with tracer.span("lto optimize"):
+                program = compiler.optimizer.optimize_ast(program)
+        return program
+    
+    def partition(self, program: Program) -> List[Program]:
+        """
+        Split the functions into balanced partitions by AST size.
+        
+        Globals and prototypes are defined once, in the first partition;
+        the others reach them through exported symbols.
+        """
+        functions = [d for d in program.declarations
+                     if isinstance(d, FunctionDeclaration) and d.body]
+        defined = {id(d) for d in functions}
+        shared = [d for d in program.declarations if id(d) not in defined]
+        count = min(self.partitions, max(1, len(functions)))
+        
+        buckets = [[] for _ in range(count)]
+        sizes = [0] * count
+        for decl in sorted(functions, key=count_nodes, reverse=True):
+            smallest = sizes.index(min(sizes))
+            buckets[smallest].append(decl)
+            sizes[smallest] += count_nodes(decl)
+        
+        # Keep source order inside each partition for readable assembly
+        order = {id(decl): i for i, decl in enumerate(functions)}
+        return [Program((shared if i == 0 else []) +
+                        sorted(bucket, key=lambda d: order[id(d)]))
+                for i, bucket in enumerate(buckets)]
+    
+    def generate(self, program: Program, stem: str, assemble: bool) -> bool:
+        """Generate (and optionally assemble) each partition, in parallel if -j allows."""
+        import dataclasses
+        
+        partitions = self.partition(program)
+        main_index = next((i for i, p in enumerate(partitions)
+                           if any(isinstance(d, FunctionDeclaration) and d.name == 'main'
+                                  for d in p.declarations)), 0)
+        options = dataclasses.replace(self.options, emit_object=assemble)
+        payloads = [serialize_ast(p) for p in partitions]
+        files = [f"{stem}.ltrans{i}.s" for i in range(len(partitions))]
+        entries = [i == main_index for i in range(len(partitions))]
+        
+        log.info("⚙️ LTO: Generating code in %s partition(s)...", len(partitions))
+        if self.jobs == 1 or len(partitions) == 1:
+            self.results = list(map(generate_lto_partition, payloads,
+                                    [options] * len(partitions), files, entries))
+        else:
+            from concurrent.futures import ProcessPoolExecutor
+            with ProcessPoolExecutor(max_workers=min(self.jobs, len(partitions))) as pool:
+                self.results = list(pool.map(generate_lto_partition, payloads,
+                                             [options] * len(partitions), files, entries))
+        
+        for result in self.results:
+            if result.log:
+                print(f"\n──── {result.source} ({result.seconds * 1000:.1f} ms) ────")
+                print(result.log, end='')
+            if not result.success:
+                self.errors.extend(f"{result.source}: {e}" for e in result.errors or ["Unknown error"])
+        return not self.errors
+    
+    def report(self):
+        """Print link-time errors."""
+        if self.errors:
+            log.error("❌ LTO errors:")
+            for error in self.errors:
+                log.error("   %s", error)
+
+# ============================================================================
+# SYNTHETIC PROGRAM GENERATOR
+# ============================================================================
+
+@dataclass
+class ProgramShape:
+    """Tunable shape of a synthetic benchmark program."""
+    functions: int = 30         # Functions besides main
+    statements: int = 12        # Statements per function body (nested blocks get fewer)
+    expression_depth: int = 3   # Maximum binary expression nesting
+    loop_nesting: int = 2       # Maximum nested while/for depth
+    identifiers: int = 6        # Local variables per function
+    seed: int = 1
+    
+    @classmethod
+    def parse(cls, text: str, base: Optional['ProgramShape'] = None) -> 'ProgramShape':
+        """Parse 'functions=50,statements=20,...' (unset keys keep base or the defaults)."""
+        import dataclasses
+        shape = dataclasses.replace(base) if base else cls()
+        names = {f.name for f in dataclasses.fields(cls)}
+        for item in filter(None, (part.strip() for part in text.split(','))):
+            key, _, value = item.partition('=')
+            key = key.strip().replace('-', '_')
+            if key not in names:
+                raise ValueError(f"unknown shape key '{key}' (expected one of {', '.join(sorted(names))})")
+            setattr(shape, key, int(value))
+        return shape
+
+class SyntheticProgramGenerator:
+    """
+    Generates deterministic C programs within the supported subset.
+    
+    Programs use int locals and parameters, arithmetic/comparison/logical
+    expressions, if/else, while and for loops, compound assignments and
+    calls to previously defined functions; main calls every function so
+    nothing is removed as unused. Divisors are non-zero constants.
+    """
+    
+    ARITHMETIC = ['+', '-', '*', '+', '-']
+    COMPARISONS = ['<', '>', '<=', '>=', '==', '!=']
+    
+    def __init__(self, shape: ProgramShape):
+        import random
+        self.shape = shape
+        self.random = random.Random(shape.seed)
+        self.loop_counter = 0
+    
+    def generate(self) -> str:
+        parts = [self._function(index) for index in range(self.shape.functions)]
+        parts.append(self._main())
+        return "\n".join(parts)
+    
+    def _function(self, index: int) -> str:
+        self.function_index = index
+        self.locals = [f"v{i}" for i in range(max(1, self.shape.identifiers))]
+        self.loop_counter = 0
+        lines = [f"int f{index}(int a, int b) {{"]
+        for name in self.locals:
+            lines.append(f"    int {name} = {self._expression(1, ['a', 'b'])};")
+        lines.extend(self._statements(self.shape.statements, 0, 1))
+        lines.append(f"    return {self._expression(self.shape.expression_depth)};")
+        lines.append("}")
+        return "\n".join(lines) + "\n"
+    
+    def _main(self) -> str:
+        lines = ["int main() {", "    int total = 0;"]
+        for index in range(self.shape.functions):
+            lines.append(f"    total = total + f{index}(total % 13, {index + 1});")
+        lines.append("    return total % 256;")
+        lines.append("}")
+        return "\n".join(lines) + "\n"
+    
+    def _statements(self, count: int, loop_depth: int, indent: int) -> List[str]:
+        lines = []
+        for _ in range(max(1, count)):
+            lines.extend(self._statement(loop_depth, indent))
+        return lines
+    
+    def _statement(self, loop_depth: int, indent: int) -> List[str]:
+        pad = "    " * indent
+        nested_count = max(1, self.shape.statements // 4)
+        # Blocks nest at most one level deeper than loops so program size stays linear
+        can_nest = indent <= self.shape.loop_nesting + 1
+        choice = self.random.random()
+        target = self.random.choice(self.locals)
+        
+        if choice < 0.15 and can_nest:
+            then_lines = self._statements(nested_count, loop_depth, indent + 1)
+            else_lines = self._statements(nested_count, loop_depth, indent + 1)
+            return ([f"{pad}if ({self._condition()}) {{"] + then_lines +
+                    [f"{pad}}} else {{"] + else_lines + [f"{pad}}}"])
+        if choice < 0.30 and can_nest and loop_depth < self.shape.loop_nesting:
+            counter = f"i{self.loop_counter}"
+            self.loop_counter += 1
+            bound = self.random.randint(2, 8)
+            body = self._statements(nested_count, loop_depth + 1, indent + 1)
+            if self.random.random() < 0.5:
+                return ([f"{pad}int {counter};",
+                         f"{pad}for ({counter} = 0; {counter} < {bound}; {counter}++) {{"] +
+                        body + [f"{pad}}}"])
+            return ([f"{pad}int {counter} = {bound};", f"{pad}while ({counter} > 0) {{"] +
+                    body + [f"{pad}    {counter} = {counter} - 1;", f"{pad}}}"])
+        if choice < 0.45:
+            operator = self.random.choice(['+=', '-=', '*='])
+            return [f"{pad}{target} {operator} {self._expression(self.shape.expression_depth - 1)};"]
+        return [f"{pad}{target} = {self._expression(self.shape.expression_depth)};"]
+    
+    def _condition(self) -> str:
+        condition = (f"{self._expression(1)} {self.random.choice(self.COMPARISONS)} "
+                     f"{self._expression(1)}")
+        if self.random.random() < 0.3:
+            joiner = self.random.choice(['&&', '||'])
+            condition += f" {joiner} {self.random.choice(self.locals)} != {self.random.randint(0, 9)}"
+        return condition
+    
+    def _expression(self, depth: int, names: Optional[List[str]] = None) -> str:
+        names = names or self.locals + ['a', 'b']
+        if depth <= 0 or self.random.random() < 0.2:
+            if self.random.random() < 0.7:
+                return self.random.choice(names)
+            return str(self.random.randint(0, 100))
+        choice = self.random.random()
+        if choice < 0.08 and self.function_index > 0:
+            callee = self.random.randrange(self.function_index)
+            return f"f{callee}({self._expression(depth - 1, names)}, {self._expression(0, names)})"
+        if choice < 0.16:
+            return f"({self._expression(depth - 1, names)} {self.random.choice(['/', '%'])} {self.random.randint(2, 9)})"
+        if choice < 0.22:
+            return f"-{self._expression(depth - 1, names)}"
+        left = self._expression(depth - 1, names)
+        right = self._expression(depth - 1, names)
+        return f"({left} {self.random.choice(self.ARITHMETIC)} {right})"
+
+# Fuzzing favours many small programs: quick to run, quick to minimize
+FUZZ_SHAPE = ProgramShape(functions=4, statements=8, expression_depth=3, loop_nesting=2, identifiers=6)
+
+class RandomProgramGenerator:
+    """
+    Csmith-style generator of well-defined programs for differential fuzzing.
+    
+    Unlike SyntheticProgramGenerator, every program has exactly one defined
+    result, so any disagreement with gcc is a compiler bug:
+    - Every expression tracks a static bound on its magnitude; operands are
+      reduced with % before an operation could overflow 32-bit int, and
+      variables hold at most VALUE_LIMIT after every statement
+    - Divisors are non-zero by construction
+    - Loops have fixed trip counts and counters the body never assigns
+    - Calls only go to earlier functions (no recursion), and each
+      function's executed statements are budgeted, so run time stays bounded
+    - Every local is initialized at its declaration
+    - Only some functions write globals, and they are only called as
+      statements (for their side effects) or as the whole right-hand side
+      of an assignment, so the order operands are evaluated in never matters
+    Some functions return a constant, so a call with side effects looks
+    foldable. main prints each function's result and the final globals, so
+    wrong intermediate values show up in stdout as well as in the exit status.
+    """
+    
+    VALUE_LIMIT = 1000
+    OVERFLOW_LIMIT = 2**31 - 1
+    COST_BUDGET = 20000  # Statements one call of a function may execute
+    GLOBALS = 3
+    
+    def __init__(self, shape: ProgramShape):
+        import random
+        self.shape = shape
+        self.random = random.Random(shape.seed)
+        self.costs = []  # Worst-case executed statements per generated function
+        self.globals = [f"g{i}" for i in range(self.GLOBALS)]
+        self.writers = set()  # Functions that may write a global, directly or through a call
+    
+    def generate(self) -> str:
+        parts = ["".join(f"int {name} = {self.random.randint(0, self.VALUE_LIMIT)};\n"
+                         for name in self.globals)]
+        parts.extend(self._function(index) for index in range(self.shape.functions))
+        parts.append(self._main())
+        return "\n".join(parts)
+    
+    # ------------------------------------------------------------------------
+    # Functions and statements
+    # ------------------------------------------------------------------------
+    
+    def _function(self, index: int) -> str:
+        self.function_index = index
+        self.cost = 0
+        self.multiplier = 1
+        self.temporaries = 0
+        self.counters = [f"c{i}" for i in range(max(1, self.shape.loop_nesting))]
+        self.scopes = [['a', 'b']]
+        if self.random.random() < 0.5:
+            self.writers.add(index)
+        
+        lines = [f"int f{index}(int a, int b) {{"]
+        for counter in self.counters:
+            lines.append(f"    int {counter} = 0;")
+        for i in range(max(1, self.shape.identifiers)):
+            text, _ = self._bounded(self._expression(1))
+            lines.append(f"    int v{i} = {text};")
+            self.scopes[0].append(f"v{i}")
+        lines.extend(self._block(self.shape.statements, 0, 1))
+        if self.random.random() < 0.2:
+            text = str(self.random.randint(0, self.VALUE_LIMIT))
+        else:
+            text, _ = self._bounded(self._expression(self.shape.expression_depth))
+        lines.append(f"    return {text};")
+        lines.append("}")
+        self.costs.append(self.cost + 1)
+        return "\n".join(lines) + "\n"
+    
+    def _main(self) -> str:
+        lines = ["int main() {", "    int checksum = 0;", "    int r = 0;"]
+        for index in range(self.shape.functions):
+            first = self.random.randint(-self.VALUE_LIMIT, self.VALUE_LIMIT)
+            second = self.random.randint(0, self.VALUE_LIMIT)
+            first_text = str(first) if first >= 0 else f"-{-first}"
+            lines.append(f"    r = f{index}({first_text}, {second});")
+            lines.append(f'    printf("f{index} %d\\n", r);')
+            lines.append(f"    checksum = (checksum + r) % {self.VALUE_LIMIT + 1};")
+        for name in self.globals:
+            lines.append(f'    printf("{name} %d\\n", {name});')
+            lines.append(f"    checksum = (checksum + {name}) % {self.VALUE_LIMIT + 1};")
+        lines.append('    printf("checksum %d\\n", checksum);')
+        lines.append("    return checksum % 256;")
+        lines.append("}")
+        return "\n".join(lines) + "\n"
+    
+    def _assignable(self) -> List[str]:
+        return [name for scope in self.scopes for name in scope]
+    
+    def _target(self) -> str:
+        """A variable to assign: sometimes a global, in functions that write them."""
+        if self.function_index in self.writers and self.random.random() < 0.25:
+            return self.random.choice(self.globals)
+        return self.random.choice(self._assignable())
+    
+    def _block(self, count: int, loop_depth: int, indent: int) -> List[str]:
+        self.scopes.append([])
+        lines = []
+        for _ in range(max(1, count)):
+            lines.extend(self._statement(loop_depth, indent))
+        self.scopes.pop()
+        return lines
+    
+    def _statement(self, loop_depth: int, indent: int) -> List[str]:
+        pad = "    " * indent
+        self.cost += self.multiplier
+        # Nested blocks stay small so program size grows linearly with every knob
+        nested_count = self.random.randint(1, 4)
+        can_nest = indent <= self.shape.loop_nesting + 1
+        target = self._target()
+        reduce = f"{pad}{target} = {target} % {self.VALUE_LIMIT + 1};"
+        choice = self.random.random()
+        
+        if choice < 0.12 and can_nest:
+            condition = self._condition()
+            lines = [f"{pad}if ({condition}) {{"] + self._block(nested_count, loop_depth, indent + 1)
+            if self.random.random() < 0.5:
+                lines += [f"{pad}}} else {{"] + self._block(nested_count, loop_depth, indent + 1)
+            return lines + [f"{pad}}}"]
+        if choice < 0.26 and can_nest and loop_depth < self.shape.loop_nesting:
+            counter = self.counters[loop_depth]
+            trips = self.random.randint(1, 6)
+            self.multiplier *= trips
+            body = self._block(nested_count, loop_depth + 1, indent + 1)
+            self.multiplier //= trips
+            if self.random.random() < 0.5:
+                return ([f"{pad}for ({counter} = 0; {counter} < {trips}; {counter}++) {{"] +
+                        body + [f"{pad}}}"])
+            return ([f"{pad}{counter} = {trips};", f"{pad}while ({counter} > 0) {{"] + body +
+                    [f"{pad}    {counter} = {counter} - 1;", f"{pad}}}"])
+        if choice < 0.30 and indent > 1:
+            text, _ = self._bounded(self._expression(self.shape.expression_depth))
+            return [f"{pad}if ({self._condition()}) {{", f"{pad}    return {text};", f"{pad}}}"]
+        if choice < 0.36:
+            name = f"t{self.temporaries}"
+            self.temporaries += 1
+            text, _ = self._bounded(self._expression(self.shape.expression_depth))
+            self.scopes[-1].append(name)
+            return [f"{pad}int {name} = {text};"]
+        if choice < 0.46:
+            operator = self.random.choice(['+=', '-='])
+            text, _ = self._bounded(self._expression(self.shape.expression_depth - 1))
+            return [f"{pad}{target} {operator} {text};", reduce]
+        if choice < 0.52:
+            step = self.random.choice([f"{target}++", f"{target}--", f"++{target}", f"--{target}"])
+            return [f"{pad}{step};", reduce]
+        if choice < 0.62:
+            call = self._call(self.shape.expression_depth, self.function_index in self.writers)
+            if call is not None:
+                if self.random.random() < 0.5:
+                    return [f"{pad}{call};"]
+                return [f"{pad}{target} = {call};"]
+        text, _ = self._bounded(self._expression(self.shape.expression_depth))
+        return [f"{pad}{target} = {text};"]
+    
+    def _condition(self) -> str:
+        text, _ = self._comparison(max(1, self.shape.expression_depth - 1))
+        return text
+    
+    # ------------------------------------------------------------------------
+    # Expressions: each returns (text, bound on |value|)
+    # ------------------------------------------------------------------------
+    
+    def _bounded(self, expression: Tuple[str, int], limit: Optional[int] = None) -> Tuple[str, int]:
+        """Reduce an expression so its magnitude is at most limit."""
+        limit = self.VALUE_LIMIT if limit is None else limit
+        text, bound = expression
+        if bound <= limit:
+            return text, bound
+        return f"({text} % {limit + 1})", limit
+    
+    def _call(self, depth: int, writers: bool) -> Optional[str]:
+        """A call to an earlier function that fits the cost budget, or None."""
+        callees = [index for index in range(self.function_index) if writers or index not in self.writers]
+        if not callees:
+            return None
+        callee = self.random.choice(callees)
+        cost = self.multiplier * self.costs[callee]
+        if self.cost + cost > self.COST_BUDGET:
+            return None
+        self.cost += cost
+        first, _ = self._bounded(self._expression(depth - 1))
+        second, _ = self._bounded(self._leaf())
+        return f"f{callee}({first}, {second})"
+    
+    def _leaf(self) -> Tuple[str, int]:
+        if self.random.random() < 0.7:
+            return self.random.choice(self._assignable() + self.counters + self.globals), self.VALUE_LIMIT
+        value = self.random.randint(0, 100)
+        return str(value), value
+    
+    def _comparison(self, depth: int) -> Tuple[str, int]:
+        left, _ = self._expression(depth - 1)
+        right, _ = self._expression(depth - 1)
+        text = f"({left} {self.random.choice(['<', '>', '<=', '>=', '==', '!='])} {right})"
+        if self.random.random() < 0.3:
+            other, _ = self._expression(depth - 1)
+            text = f"({text} {self.random.choice(['&&', '||'])} {other})"
+        return text, 1
+    
+    def _divisor(self) -> Tuple[str, int]:
+        """A provably non-zero divisor: a literal, or a shifted remainder in [2, 14]."""
+        if self.random.random() < 0.5:
+            value = self.random.randint(1, 9)
+            return str(value), value
+        text, _ = self._expression(1)
+        return f"(({text} % 7) + 8)", 14
+    
+    def _expression(self, depth: int) -> Tuple[str, int]:
+        if depth <= 0 or self.random.random() < 0.15:
+            return self._leaf()
+        choice = self.random.random()
+        
+        if choice < 0.08:
+            call = self._call(depth, writers=False)
+            if call is not None:
+                return call, self.VALUE_LIMIT
+        if choice < 0.18:
+            return self._comparison(depth)
+        if choice < 0.24:
+            operand, bound = self._expression(depth - 1)
+            if self.random.random() < 0.5:
+                return f"(-{operand})", bound
+            return f"(!{operand})", 1
+        if choice < 0.36:
+            operand, bound = self._expression(depth - 1)
+            divisor, divisor_bound = self._divisor()
+            if self.random.random() < 0.5:
+                return f"({operand} / {divisor})", bound
+            return f"({operand} % {divisor})", min(bound, divisor_bound - 1)
+        
+        operator = self.random.choice(['+', '-', '*'])
+        left, left_bound = self._expression(depth - 1)
+        right, right_bound = self._expression(depth - 1)
+        if operator == '*':
+            if left_bound * right_bound > self.OVERFLOW_LIMIT:
+                left, left_bound = self._bounded((left, left_bound))
+                right, right_bound = self._bounded((right, right_bound))
+            return f"({left} * {right})", left_bound * right_bound
+        if left_bound + right_bound > self.OVERFLOW_LIMIT:
+            left, left_bound = self._bounded((left, left_bound), self.OVERFLOW_LIMIT // 2)
+            right, right_bound = self._bounded((right, right_bound), self.OVERFLOW_LIMIT // 2)
+        return f"({left} {operator} {right})", left_bound + right_bound
+
+# ============================================================================
+# BENCHMARKS
+# ============================================================================
+
+BENCHMARKS = {}  # Benchmark name -> (function, description)
+
+def benchmark(name: str, description: str):
+    """Register a benchmark runnable with --benchmark NAME."""
+    def register(func):
+        BENCHMARKS[name] = (func, description)
+        return func
+    return register
+
+def _time_best_of(func, iterations: int) -> float:
+    """Run func repeatedly and return the best wall time in seconds."""
+    import time
+    best = float('inf')
+    for _ in range(iterations):
+        start = time.perf_counter()
+        func()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+VM_BENCHMARK_SOURCE = """
+int fib(int n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+
+int main() {
+    int total = 0;
+    int i;
+    int j;
+    for (i = 0; i < 200; i++) {
+        for (j = 0; j < 100; j++) {
+            total = total + i * j % 7;
+        }
+    }
+    total = total + fib(18);
+    printf("checksum %d\\n", total);
+    return total % 256;
+}
+"""
+
+# Compute kernels for --benchmark codegen; each returns a checksum as its exit status
+CODEGEN_BENCHMARK_KERNELS = {
+    'fib': """
+int fib(int n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+
+int main() {
+    return fib(24) % 256;
+}
+""",
+    # No arrays in the supported subset, so primes are counted by trial division
+    'sieve': """
+int is_prime(int n) {
+    int d;
+    if (n < 2) {
+        return 0;
+    }
+    for (d = 2; d * d <= n; d++) {
+        if (n % d == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main() {
+    int count = 0;
+    int n;
+    for (n = 2; n < 20000; n++) {
+        count = count + is_prime(n);
+    }
+    return count % 256;
+}
+""",
+    'nested_loops': """
+int main() {
+    int total = 0;
+    int i;
+    int j;
+    int k;
+    for (i = 0; i < 60; i++) {
+        for (j = 0; j < 60; j++) {
+            for (k = 0; k < 30; k++) {
+                total = total + i * j - k;
+            }
+        }
+    }
+    return total % 256;
+}
+""",
+    'collatz': """
+int steps(int n) {
+    int count = 0;
+    while (n != 1) {
+        if (n % 2 == 0) {
+            n = n / 2;
+        } else {
+            n = 3 * n + 1;
+        }
+        count++;
+    }
+    return count;
+}
+
+int main() {
+    int total = 0;
+    int n;
+    for (n = 1; n < 3000; n++) {
+        total = total + steps(n);
+    }
+    return total % 256;
+}
+""",
+    'gcd': """
+int gcd(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+int main() {
+    int total = 0;
+    int i;
+    int j;
+    for (i = 1; i < 150; i++) {
+        for (j = 1; j < 150; j++) {
+            total = total + gcd(i, j);
+        }
+    }
+    return total % 256;
+}
+""",
+}
+
+@benchmark('vm', 'Bytecode VM versus naive AST-walking interpreter')
+def benchmark_vm(args) -> bool:
+    """Run one program on both execution engines and compare wall time."""
+    import io
+    import contextlib
+    
+    if args.source:
+        with open(args.source, 'r') as f:
+            source_code = f.read()
+        name = args.source
+    else:
+        source_code = VM_BENCHMARK_SOURCE
+        name = "<built-in fib + nested loop kernel>"
+    
+    compiler = CCompiler()
+    compiler.set_optimization_level(args.opt_level)
+    with contextlib.redirect_stdout(io.StringIO()):
+        program = compiler.analyze_source(source_code)
+    if program is None:
+        log.error("❌ Benchmark program failed to compile")
+        return False
+    
+    results = {}
+    try:
+        module = BytecodeCompiler().compile_program(program)
+    except VMError as e:
+        log.error("❌ Bytecode lowering failed: %s", e)
+        return False
+    
+    def run_vm():
+        results['vm'] = BytecodeVM(module, output=io.StringIO()).run("main")
+    
+    def run_ast():
+        results['ast'] = ASTInterpreter(program, output=io.StringIO()).run("main")
+    
+    print(f"⏱️  VM benchmark: {name} ({args.iterations} iterations, best of)")
+    try:
+        vm_time = _time_best_of(run_vm, args.iterations)
+        ast_time = _time_best_of(run_ast, args.iterations)
+    except VMError as e:
+        log.error("❌ Runtime Error: %s", e)
+        return False
+    
+    if results['vm'] != results['ast']:
+        log.error("❌ Result mismatch: VM returned %s, AST interpreter returned %s", results['vm'], results['ast'])
+        return False
+    
+    print(f"   {'Engine':<24} {'Time (ms)':>12} {'Speedup':>9}")
+    print(f"   {'AST interpreter':<24} {ast_time * 1000:>12.2f} {1.0:>8.2f}x")
+    print(f"   {'Bytecode VM':<24} {vm_time * 1000:>12.2f} {ast_time / vm_time:>8.2f}x")
+    print(f"   Bytecode: {module.instruction_count()} instructions, "
+          f"{module.superinstructions} superinstructions; result = {results['vm']}")
+    return True
+
+def _logging_benchmark_source(functions: int = 40) -> str:
+    """A program with many small functions, loops and foldable constants."""
+    parts = []
+    for i in range(functions):
+        parts.append(f"""
+int work{i}(int n) {{
+    int total = 0;
+    int i;
+    int scale = {i} * 4 + 2;
+    for (i = 0; i < n; i++) {{
+        if (i % 3 == 0) {{
+            total = total + i * scale;
+        }} else {{
+            total = total - (i + 0) * 1;
+        }}
+    }}
+    while (total > 1000) {{
+        total = total - 7;
+    }}
+    return total + n;
+}}
+""")
+    calls = "".join(f"    total = total + work{i}(total % 50);\n" for i in range(functions))
+    parts.append(f"\nint main() {{\n    int total = 1;\n{calls}    return total;\n}}\n")
+    return "".join(parts)
+
+@benchmark('logging', 'Compile time with diagnostics at each verbosity level')
+def benchmark_logging(args) -> bool:
+    """Compile one program at every log level and compare wall time."""
+    if args.source:
+        with open(args.source, 'r') as f:
+            source_code = f.read()
+        name = args.source
+    else:
+        source_code = _logging_benchmark_source()
+        name = "<built-in 40-function program>"
+    
+    def compile_once():
+        compiler = CCompiler()
+        compiler.set_optimization_level(args.opt_level)
+        program = compiler.analyze_source(source_code)
+        if program is None:
+            raise VMError("benchmark program failed to compile")
+        assembly = compiler.code_generator.generate(program)
+        if args.opt_level != 0:
+            compiler.optimizer.optimize_assembly(assembly)
+    
+    configurations = [
+        ("all diagnostics (-vv, previous behavior)", LogLevel.TRACE),
+        ("per-pass details (-v)", LogLevel.DEBUG),
+        ("default", LogLevel.INFO),
+        ("quiet (-q)", LogLevel.ERROR),
+    ]
+    
+    print(f"⏱️  Logging benchmark: {name} ({args.iterations} iterations, best of)")
+    print("   Diagnostics are written to /dev/null, so terminal cost is excluded")
+    times = {}
+    saved_level, saved_stdout = log.level, sys.stdout
+    try:
+        with open(os.devnull, 'w') as sink:
+            sys.stdout = sink
+            for label, level in configurations:
+                log.set_level(level)
+                times[label] = _time_best_of(compile_once, args.iterations)
+    except VMError as e:
+        sys.stdout = saved_stdout
+        log.error("❌ %s", e)
+        return False
+    finally:
+        sys.stdout = saved_stdout
+        log.set_level(saved_level)
+    
+    baseline = times[configurations[0][0]]
+    print(f"   {'Log level':<40} {'Time (ms)':>12} {'Speedup':>9}")
+    for label, _ in configurations:
+        print(f"   {label:<40} {times[label] * 1000:>12.2f} {baseline / times[label]:>8.2f}x")
+    return True
+
+@benchmark('ast', 'Loading a binary serialized AST versus lexing and parsing')
+def benchmark_ast(args) -> bool:
+    """Time lex + parse against serialize and load of the same AST."""
+    import pickle
+    
+    if args.source:
+        with open(args.source, 'r') as f:
+            source_code = f.read()
+        name = args.source
+    else:
+        source_code = SyntheticProgramGenerator(ProgramShape()).generate()
+        name = "<synthetic: default shape>"
+    
+    saved_level = log.level
+    log.set_level(LogLevel.ERROR)
+    try:
+        program = Parser(Lexer(source_code).tokenize()).parse()
+        data = serialize_ast(program)
+        if deserialize_ast(data) != program:
+            log.error("❌ Serialized AST does not round-trip")
             return False
-        except SyntaxError as e:
-            print(f"❌ Syntax Error: {e}")
+        pickled = pickle.dumps(program, protocol=pickle.HIGHEST_PROTOCOL)
+        times = {
+            "lex + parse": _time_best_of(lambda: Parser(Lexer(source_code).tokenize()).parse(),
+                                         args.iterations),
+            "serialize": _time_best_of(lambda: serialize_ast(program), args.iterations),
+            "load binary AST": _time_best_of(lambda: deserialize_ast(data), args.iterations),
+            "pickle.loads (reference)": _time_best_of(lambda: pickle.loads(pickled), args.iterations),
+        }
+    finally:
+        log.set_level(saved_level)
+    
+    print(f"⏱️  AST serialization benchmark: {name} ({args.iterations} iterations, best of)")
+    print(f"   {count_nodes(program)} AST nodes; source {len(source_code.encode()):,} bytes, "
+          f"binary AST {len(data):,} bytes, pickle {len(pickled):,} bytes")
+    baseline = times["lex + parse"]
+    print(f"   {'Operation':<28} {'Time (ms)':>12} {'vs parse':>9}")
+    for label, seconds in times.items():
+        print(f"   {label:<28} {seconds * 1000:>12.2f} {baseline / seconds:>8.2f}x")
+    return True
+
+class LadderDispatchWalker:
+    """
+    Reference for benchmark_dispatch: visits every node through an isinstance
+    chain in the order the visitors used, statements before expressions.
+    """
+    
+    def __init__(self):
+        self.visits = 0
+    
+    def tally(self, node: ASTNode):
+        self.visits += 1
+    
+    def visit(self, node: ASTNode):
+        if isinstance(node, CompoundStatement):
+            self.tally(node)
+        elif isinstance(node, VariableDeclaration):
+            self.tally(node)
+        elif isinstance(node, ExpressionStatement):
+            self.tally(node)
+        elif isinstance(node, ReturnStatement):
+            self.tally(node)
+        elif isinstance(node, IfStatement):
+            self.tally(node)
+        elif isinstance(node, WhileStatement):
+            self.tally(node)
+        elif isinstance(node, ForStatement):
+            self.tally(node)
+        elif isinstance(node, IntegerLiteral):
+            self.tally(node)
+        elif isinstance(node, FloatLiteral):
+            self.tally(node)
+        elif isinstance(node, StringLiteral):
+            self.tally(node)
+        elif isinstance(node, CharLiteral):
+            self.tally(node)
+        elif isinstance(node, Identifier):
+            self.tally(node)
+        elif isinstance(node, BinaryExpression):
+            self.tally(node)
+        elif isinstance(node, UnaryExpression):
+            self.tally(node)
+        elif isinstance(node, AssignmentExpression):
+            self.tally(node)
+        elif isinstance(node, CallExpression):
+            self.tally(node)
+        elif isinstance(node, FunctionDeclaration):
+            self.tally(node)
+        elif isinstance(node, Parameter):
+            self.tally(node)
+        elif isinstance(node, Program):
+            self.tally(node)
+        for child in iter_child_nodes(node):
+            self.visit(child)
+
+class TableDispatchWalker(NodeVisitor):
+    """The same walk as LadderDispatchWalker through a NodeVisitor table."""
+    
+    def __init__(self):
+        self.visits = 0
+    
+    @handles('node', CompoundStatement, VariableDeclaration, ExpressionStatement, ReturnStatement,
+             IfStatement, WhileStatement, ForStatement, IntegerLiteral, FloatLiteral,
+             StringLiteral, CharLiteral, Identifier, BinaryExpression, UnaryExpression,
+             AssignmentExpression, CallExpression, FunctionDeclaration, Parameter, Program)
+    def tally(self, node: ASTNode):
+        self.visits += 1
+    
+    def visit(self, node: ASTNode):
+        handler = self.dispatch_tables['node'].get(node.__class__)
+        if handler:
+            handler(self, node)
+        for child in iter_child_nodes(node):
+            self.visit(child)
+
+def iter_child_nodes_by_fields(node: ASTNode):
+    """Reference for benchmark_dispatch: child iteration that reads dataclass fields per node."""
+    import dataclasses
+    for field_info in dataclasses.fields(node):
+        value = getattr(node, field_info.name)
+        if isinstance(value, ASTNode):
+            yield value
+        elif isinstance(value, list):
+            for item in value:
+                if isinstance(item, ASTNode):
+                    yield item
+
+@benchmark('dispatch', 'Visitor dispatch: isinstance ladders versus per-class tables')
+def benchmark_dispatch(args) -> bool:
+    """
+    Time node dispatch and child iteration over a large AST, old style
+    against NodeVisitor tables and cached field metadata, then the real
+    table-driven visitors (per node, so --shape sizes compare).
+    """
+    import copy
+    
+    if args.source:
+        with open(args.source, 'r') as f:
+            source_code = f.read()
+        name = args.source
+    else:
+        try:
+            shape = ProgramShape.parse(args.shape or "functions=200")
+        except ValueError as e:
+            log.error("❌ Invalid --shape: %s", e)
             return False
-        except Exception as e:
-            print(f"❌ Compilation Error: {e}")
+        source_code = SyntheticProgramGenerator(shape).generate()
+        name = f"<synthetic: {args.shape or 'functions=200'}>"
+    
+    saved_level = log.level
+    log.set_level(LogLevel.ERROR)
+    try:
+        program = Parser(Lexer(source_code).tokenize()).parse()
+        nodes = count_nodes(program)
+        functions = [d for d in program.declarations if isinstance(d, FunctionDeclaration) and d.body]
+        
+        def walk(walker_class):
+            walker = walker_class()
+            walker.visit(program)
+            return walker.visits
+        
+        if walk(LadderDispatchWalker) != walk(TableDispatchWalker) != nodes:
+            log.error("❌ Dispatch walkers disagree on the node count")
+            return False
+        
+        def count_by_fields(node):
+            return 1 + sum(count_by_fields(child) for child in iter_child_nodes_by_fields(node))
+        
+        def liveness():
+            for func in functions:
+                LiveVariableAnalysis().analyze_function(func)
+        
+        def constprop():
+            ConstantFoldingPass().optimize(copy.deepcopy(program))
+        
+        def codegen():
+            generator = CodeGenerator()
+            generator.set_advanced_allocation(False)
+            generator.generate(program)
+        
+        deepcopy_time = _time_best_of(lambda: copy.deepcopy(program), args.iterations)
+        comparisons = [
+            ("node dispatch", _time_best_of(lambda: walk(LadderDispatchWalker), args.iterations),
+             _time_best_of(lambda: walk(TableDispatchWalker), args.iterations)),
+            ("child iteration", _time_best_of(lambda: count_by_fields(program), args.iterations),
+             _time_best_of(lambda: count_nodes(program), args.iterations)),
+        ]
+        visitors = {
+            "semantic analysis": _time_best_of(lambda: SemanticAnalyzer().analyze(program), args.iterations),
+            "constant propagation": _time_best_of(constprop, args.iterations) - deepcopy_time,
+            "liveness extraction": _time_best_of(liveness, args.iterations),
+            "code generation (-O0 regs)": _time_best_of(codegen, args.iterations),
+        }
+    finally:
+        log.set_level(saved_level)
+    
+    def per_node(seconds):
+        return seconds * 1e9 / nodes
+    
+    print(f"⏱️  Visitor dispatch benchmark: {name} ({args.iterations} iterations, best of)")
+    print(f"   {nodes:,} AST nodes in {len(functions)} functions")
+    print(f"   {'Walk':<28} {'Before ns/node':>15} {'After ns/node':>14} {'Speedup':>8}")
+    for label, before, after in comparisons:
+        print(f"   {label:<28} {per_node(before):>15.1f} {per_node(after):>14.1f} {before / after:>7.2f}x")
+    print(f"\n   {'Table-driven visitor':<28} {'Time (ms)':>15} {'ns/node':>14}")
+    for label, seconds in visitors.items():
+        print(f"   {label:<28} {seconds * 1000:>15.2f} {per_node(seconds):>14.1f}")
+    return True
+
+def substitute_after_deepcopy(node: ASTNode, name: str, replacement: ASTNode) -> ASTNode:
+    """Reference for benchmark_clone: deepcopy, then a second walk replacing uses of name."""
+    import copy
+
+    def substitute(node):
+        if isinstance(node, Identifier) and node.name == name:
+            return copy_location(copy.deepcopy(replacement), node)
+        for field_name in child_fields(node.__class__):
+            value = getattr(node, field_name)
+            if isinstance(value, list):
+                value[:] = [substitute(item) for item in value]
+            elif value is not None:
+                setattr(node, field_name, substitute(value))
+        return node
+
+    return substitute(copy.deepcopy(node))
+
+@benchmark('clone', 'AST cloning: copy.deepcopy plus substitution versus clone_tree')
+def benchmark_clone(args) -> bool:
+    """
+    Unroll a large loop body 8 times the old way (deepcopy, then substitute
+    the loop variable) and with clone_tree's single pass, and time plain
+    copies of the whole program.
+    """
+    import collections
+    import copy
+
+    if args.source:
+        with open(args.source, 'r') as f:
+            source_code = f.read()
+        name = args.source
+    else:
+        try:
+            shape = ProgramShape.parse(args.shape or "functions=1,statements=200,loop_nesting=0")
+        except ValueError as e:
+            log.error("❌ Invalid --shape: %s", e)
+            return False
+        source_code = SyntheticProgramGenerator(shape).generate()
+        name = f"<synthetic: {args.shape or 'functions=1,statements=200,loop_nesting=0'}>"
+
+    saved_level = log.level
+    log.set_level(LogLevel.ERROR)
+    try:
+        program = Parser(Lexer(source_code).tokenize()).parse()
+        functions = [d for d in program.declarations if isinstance(d, FunctionDeclaration) and d.body]
+        if not functions:
+            log.error("❌ No function bodies to clone")
+            return False
+        body = max((f.body for f in functions), key=count_nodes)
+
+        # The body's most used variable plays the loop variable
+        uses = collections.Counter()
+
+        def count_uses(node):
+            if isinstance(node, Identifier):
+                uses[node.name] += 1
+            for child in iter_child_nodes(node):
+                count_uses(child)
+
+        count_uses(body)
+        if not uses:
+            log.error("❌ The largest function body uses no variables")
+            return False
+        variable = uses.most_common(1)[0][0]
+
+        def unroll_old():
+            return [substitute_after_deepcopy(body, variable, IntegerLiteral(i)) for i in range(8)]
+
+        def unroll_new():
+            return [clone_tree(body, {variable: IntegerLiteral(i)}) for i in range(8)]
+
+        if unroll_old() != unroll_new() or clone_tree(program) != program:
+            log.error("❌ clone_tree disagrees with deepcopy")
             return False
+
+        comparisons = [
+            ("unroll 8x with substitution", _time_best_of(unroll_old, args.iterations),
+             _time_best_of(unroll_new, args.iterations)),
+            ("copy whole program", _time_best_of(lambda: copy.deepcopy(program), args.iterations),
+             _time_best_of(lambda: clone_tree(program), args.iterations)),
+        ]
+    finally:
+        log.set_level(saved_level)
+
+    print(f"⏱️  AST cloning benchmark: {name} ({args.iterations} iterations, best of)")
+    print(f"   loop body: {count_nodes(body):,} nodes, {len(body.statements)} statements, "
+          f"'{variable}' used {uses[variable]} times; program: {count_nodes(program):,} nodes")
+    print(f"   {'Operation':<30} {'deepcopy (ms)':>14} {'clone_tree (ms)':>16} {'Speedup':>8}")
+    for label, before, after in comparisons:
+        print(f"   {label:<30} {before * 1000:>14.2f} {after * 1000:>16.2f} {before / after:>7.2f}x")
+    return True
+
+@benchmark('compiler', 'Per-phase compiler throughput on synthetic programs')
+def benchmark_compiler(args) -> bool:
+    """
+    Time each CCompiler phase in isolation and report throughput.
     
-    def compile_to_executable(self, source_file: str, output_file: str = None) -> bool:
-        """Compile C source to executable binary."""
+    Use --shape to tune the generated program, --save-baseline to record
+    results and --baseline/--threshold to fail on regressions.
+    """
+    import copy
+    import time
+    import json
+    import tracemalloc
+    
+    if args.source:
+        with open(args.source, 'r') as f:
+            source_code = f.read()
+        name = args.source
+        shape = None
+    else:
         try:
-            # First compile to assembly
-            if not self.compile(source_file):
-                return False
-            
-            # Determine file names
-            assembly_file = source_file.replace('.c', '.s')
-            if not output_file:
-                output_file = source_file.replace('.c', '')
-            
-            # Phase 5: Assembly & Linking
-            print("🔗 Phase 5: Assembly & Linking...")
-            
-            # Use GNU assembler and linker
-            import subprocess
-            
-            # Assemble to object file
-            object_file = source_file.replace('.c', '.o')
-            assemble_cmd = ['as', '--64', '-o', object_file, assembly_file]
-            
-            result = subprocess.run(assemble_cmd, capture_output=True, text=True)
-            if result.returncode != 0:
-                print(f"❌ Assembly failed: {result.stderr}")
-                return False
-            
-            print(f"   ✅ Assembled object file: {object_file}")
-            
-            # Link to executable
-            link_cmd = ['ld', '-o', output_file, object_file]
-            
-            result = subprocess.run(link_cmd, capture_output=True, text=True)
-            if result.returncode != 0:
-                print(f"❌ Linking failed: {result.stderr}")
+            shape = ProgramShape.parse(args.shape or "")
+        except ValueError as e:
+            log.error("❌ Invalid --shape: %s", e)
+            return False
+        source_code = SyntheticProgramGenerator(shape).generate()
+        name = f"<synthetic: {args.shape or 'default shape'}>"
+    
+    saved_level = log.level
+    log.set_level(LogLevel.ERROR)  # Measure the compiler, not its diagnostics
+    try:
+        # Produce every phase's input once, untimed
+        tokens = Lexer(source_code).tokenize()
+        ast = Parser(tokens).parse()
+        if not SemanticAnalyzer().analyze(ast):
+            log.error("❌ Benchmark program failed semantic analysis")
+            return False
+        nodes = count_nodes(ast)
+        optimizer = OptimizationManager(args.opt_level)
+        optimized = optimizer.optimize_ast(copy.deepcopy(ast)) if args.opt_level != 0 else ast
+        assembly = CodeGenerator().generate(optimized)
+        assembly_lines = assembly.count('\n') + 1
+        
+        def timed(run, setup=lambda: None) -> float:
+            """Best wall time of run(setup()) with setup excluded."""
+            best = float('inf')
+            for _ in range(args.iterations):
+                state = setup()
+                start = time.perf_counter()
+                run(state)
+                best = min(best, time.perf_counter() - start)
+            return best
+        
+        # (phase, run, setup, work amount, unit)
+        phases = [
+            ("lex", lambda _: Lexer(source_code).tokenize(), lambda: None, len(tokens), "tokens"),
+            ("parse", lambda _: Parser(tokens).parse(), lambda: None, nodes, "nodes"),
+            ("semantic", lambda tree: SemanticAnalyzer().analyze(tree),
+             lambda: copy.deepcopy(ast), nodes, "nodes"),
+            ("codegen", lambda _: CodeGenerator().generate(optimized), lambda: None,
+             assembly_lines, "asm lines"),
+        ]
+        if args.opt_level != 0:
+            phases.insert(3, ("optimize", lambda tree: OptimizationManager(args.opt_level).optimize_ast(tree),
+                              lambda: copy.deepcopy(ast), nodes, "nodes"))
+            phases.append(("peephole", lambda _: PeepholeOptimizerPass().optimize_assembly(assembly),
+                           lambda: None, assembly_lines, "asm lines"))
+        
+        results = {}
+        for phase, run, setup, amount, unit in phases:
+            seconds = timed(run, setup)
+            results[phase] = {'seconds': seconds, 'throughput': amount / seconds,
+                              'unit': f"{unit}/s", 'amount': amount}
+        
+        # Peak memory per phase, measured separately so tracing doesn't skew timings
+        tracemalloc.start(1)
+        for phase, run, setup, _, _ in phases:
+            state = setup()
+            base = tracemalloc.get_traced_memory()[0]
+            tracemalloc.reset_peak()
+            run(state)
+            results[phase]['peak_bytes'] = tracemalloc.get_traced_memory()[1] - base
+        tracemalloc.stop()
+    finally:
+        log.set_level(saved_level)
+    
+    print(f"⏱️  Compiler benchmark: {name} (-O{args.opt_level}, {args.iterations} iterations, best of)")
+    print(f"   {len(source_code.splitlines())} source lines, {len(tokens)} tokens, "
+          f"{nodes} AST nodes, {assembly_lines} assembly lines")
+    print(f"   {'Phase':<10} {'Time (ms)':>10} {'Throughput':>14} {'Unit':<12} {'Peak KiB':>9}")
+    for phase, result in results.items():
+        print(f"   {phase:<10} {result['seconds'] * 1000:>10.2f} {result['throughput']:>14,.0f} "
+              f"{result['unit']:<12} {result['peak_bytes'] / 1024:>9.1f}")
+    total = sum(r['seconds'] for r in results.values())
+    print(f"   {'total':<10} {total * 1000:>10.2f} {len(source_code.splitlines()) / total:>14,.0f} "
+          f"{'lines/s':<12}")
+    
+    import dataclasses
+    report = {'compiler_version': COMPILER_VERSION, 'python': sys.version.split()[0],
+              'optimization_level': args.opt_level,
+              'shape': dataclasses.asdict(shape) if shape else {'source': args.source},
+              'phases': results}
+    
+    if args.save_baseline:
+        with open(args.save_baseline, 'w') as f:
+            json.dump(report, f, indent=2)
+        print(f"📄 Saved baseline to {args.save_baseline}")
+    
+    if args.baseline:
+        with open(args.baseline, 'r') as f:
+            baseline = json.load(f)
+        if baseline.get('shape') != report['shape'] or \
+           baseline.get('optimization_level') != args.opt_level:
+            print("⚠️  Baseline was recorded with a different program shape or -O level")
+        print(f"📏 Against baseline {args.baseline} (threshold +{args.threshold:.0f}%):")
+        regressions = []
+        for phase, result in results.items():
+            base = baseline.get('phases', {}).get(phase)
+            if not base:
+                continue
+            change = (result['seconds'] / base['seconds'] - 1) * 100
+            regressed = change > args.threshold
+            marker = "❌ regression" if regressed else "✅"
+            print(f"   {phase:<10} {base['seconds'] * 1000:>10.2f} → {result['seconds'] * 1000:>8.2f} ms "
+                  f"({change:+6.1f}%) {marker}")
+            if regressed:
+                regressions.append(phase)
+        if regressions:
+            log.error("❌ Throughput regressed beyond %.0f%% in: %s", args.threshold, ", ".join(regressions))
+            return False
+    return True
+
+@benchmark('scaling', 'Compile-time growth as one --shape knob doubles (--scale KNOB)')
+def benchmark_scaling(args) -> bool:
+    """
+    Compile random programs of doubling size and flag super-linear phases.
+    
+    A phase whose cost per AST node grows with the knob scales worse than
+    linearly; the worst such phase (or the slowest phase, if none) at the
+    largest size is profiled to name the functions responsible.
+    """
+    import copy
+    import time
+    import pstats
+    import cProfile
+    import dataclasses
+    
+    knobs = [f.name for f in dataclasses.fields(ProgramShape) if f.name != 'seed']
+    if args.scale not in knobs:
+        log.error("❌ --scale must be one of %s", ", ".join(knobs))
+        return False
+    try:
+        base = ProgramShape.parse(args.shape or "", FUZZ_SHAPE)
+    except ValueError as e:
+        log.error("❌ Invalid --shape: %s", e)
+        return False
+    
+    def frontend(source):
+        program = Parser(Lexer(source).tokenize()).parse()
+        SemanticAnalyzer().analyze(program)
+        return program
+    
+    # (phase, run, untimed setup producing run's input from (source, program, optimized))
+    phases = [("frontend", frontend, lambda inputs: inputs[0])]
+    if args.opt_level != 0:
+        phases.append(("optimize", lambda tree: OptimizationManager(args.opt_level).optimize_ast(tree),
+                       lambda inputs: copy.deepcopy(inputs[1])))
+    phases.append(("codegen", lambda tree: CodeGenerator().generate(tree), lambda inputs: inputs[2]))
+    
+    start_value = max(1, getattr(base, args.scale))
+    sizes = [start_value * 2 ** step for step in range(5)]
+    print(f"📈 Scaling benchmark: {args.scale} = {', '.join(map(str, sizes))} "
+          f"({args.iterations} iterations, best of)")
+    print(f"   {args.scale:<18} {'AST nodes':>10}" + "".join(f" {phase[0] + ' (ms)':>15}" for phase in phases))
+    
+    saved_level = log.level
+    log.set_level(LogLevel.ERROR)
+    rows = []
+    try:
+        for size in sizes:
+            source = RandomProgramGenerator(dataclasses.replace(base, **{args.scale: size})).generate()
+            program = frontend(source)
+            optimized = program
+            if args.opt_level != 0:
+                optimized = OptimizationManager(args.opt_level).optimize_ast(copy.deepcopy(program))
+            timings = []
+            for _, run, setup in phases:
+                best = float('inf')
+                for _ in range(args.iterations):
+                    argument = setup((source, program, optimized))
+                    start = time.perf_counter()
+                    run(argument)
+                    best = min(best, time.perf_counter() - start)
+                timings.append(best)
+            rows.append((size, count_nodes(program), timings, (source, program, optimized)))
+            print(f"   {size:<18} {rows[-1][1]:>10}" + "".join(f" {t * 1000:>15.2f}" for t in timings))
+    finally:
+        log.set_level(saved_level)
+    
+    # Random programs vary in size, so compare cost per AST node rather than raw time
+    print(f"   Cost per AST node (µs) as {args.scale} grows; growth above 2x marks a super-linear phase:")
+    cliffs = []
+    for index, (name, _, _) in enumerate(phases):
+        per_node = [row[2][index] * 1e6 / max(row[1], 1) for row in rows]
+        growth = per_node[-1] / max(per_node[0], 1e-9)
+        marker = f"⚠️  super-linear ({growth:.1f}x)" if growth > 2 else f"✅ ({growth:.1f}x)"
+        print(f"   {name:<18} " + " ".join(f"{cost:>7.2f}" for cost in per_node) + f"  {marker}")
+        if growth > 2:
+            cliffs.append(index)
+    
+    # Name the functions behind the slowest phase at the largest size
+    largest = rows[-1]
+    slowest = max(cliffs or range(len(phases)), key=lambda i: largest[2][i])
+    name, run, setup = phases[slowest]
+    profiler = cProfile.Profile()
+    log.set_level(LogLevel.ERROR)
+    try:
+        profiler.runcall(run, setup(largest[3]))
+    finally:
+        log.set_level(saved_level)
+    stats = pstats.Stats(profiler).sort_stats('tottime')
+    print(f"   Hottest functions in {name} at {args.scale} = {largest[0]}:")
+    for (filename, line, function), (_, calls, total, _, _) in \
+            sorted(stats.stats.items(), key=lambda item: -item[1][2])[:6]:
+        print(f"      {total * 1000:>9.2f} ms  {calls:>9} calls  {function} "
+              f"({os.path.basename(filename)}:{line})")
+    return True
+
+def _perf_instructions(command: List[str]) -> Optional[int]:
+    """Retired instruction count from `perf stat`, or None when unavailable."""
+    import shutil
+    import subprocess
+    
+    if not shutil.which('perf'):
+        return None
+    try:
+        result = subprocess.run(['perf', 'stat', '-x', ',', '-e', 'instructions', '--'] + command,
+                                capture_output=True, text=True, timeout=60)
+    except subprocess.TimeoutExpired:
+        return None
+    for line in result.stderr.splitlines():
+        fields = line.split(',')
+        if len(fields) > 2 and fields[2].startswith('instructions'):
+            return int(fields[0]) if fields[0].isdigit() else None
+    return None
+
+@benchmark('codegen', 'Run time of generated code at each -O level (with --gcc-reference)')
+def benchmark_codegen(args) -> bool:
+    """
+    Build each kernel at every optimization setting and time the executables.
+    
+    Exit statuses are checked against the bytecode VM; a miscompiled kernel
+    is reported instead of timed, since its run time means nothing.
+    """
+    import io
+    import shutil
+    import tempfile
+    import subprocess
+    
+    if args.source:
+        with open(args.source, 'r') as f:
+            kernels = {os.path.splitext(os.path.basename(args.source))[0]: f.read()}
+    else:
+        kernels = CODEGEN_BENCHMARK_KERNELS
+    
+    # (label, optimization level, advanced register allocation)
+    configurations = [
+        ("-O0", 0, True),
+        ("-O1", 1, True),
+        ("-O2", 2, True),
+        ("-O1 --no-advanced-regs", 1, False),
+    ]
+    references = []
+    if args.gcc_reference:
+        if shutil.which('gcc'):
+            references = [("gcc -O0", "-O0"), ("gcc -O2", "-O2")]
+        else:
+            log.error("⚠️  gcc not found; skipping the reference builds")
+    
+    def time_executable(path: str):
+        """Best wall time and exit status of path, or (None, reason)."""
+        best, status = float('inf'), None
+        for _ in range(args.iterations):
+            try:
+                start = time.perf_counter()
+                result = subprocess.run([path], capture_output=True, timeout=30)
+                best = min(best, time.perf_counter() - start)
+            except subprocess.TimeoutExpired:
+                return None, "timeout"
+            status = result.returncode
+        return best, status
+    
+    import time
+    print(f"⏱️  Generated-code benchmark: {len(kernels)} kernels ({args.iterations} runs, best of)")
+    if not shutil.which('perf'):
+        print("   perf not available: instruction counts omitted")
+    
+    saved_level = log.level
+    log.set_level(LogLevel.ERROR)
+    built_any = False
+    mismatches = 0
+    with tempfile.TemporaryDirectory(prefix="vibe-cc-bench-") as workdir:
+        for kernel, source_code in kernels.items():
+            # Expected exit status from the bytecode VM on the unoptimized program
+            reference = CCompiler()
+            reference.set_optimization_level(0)
+            program = reference.analyze_source(source_code)
+            if program is None:
+                log.set_level(saved_level)
+                log.error("❌ Kernel %s failed to compile", kernel)
                 return False
+            expected = BytecodeVM(BytecodeCompiler().compile_program(program),
+                                  output=io.StringIO()).run("main") & 0xFF
             
-            print(f"   ✅ Created executable: {output_file}")
-            print(f"   Run with: ./{output_file}")
+            rows = []
+            for index, (label, level, advanced) in enumerate(configurations):
+                source_file = os.path.join(workdir, f"{kernel}_{index}.c")
+                executable = source_file[:-2]
+                with open(source_file, 'w') as f:
+                    f.write(source_code)
+                compiler = CCompiler()
+                compiler.set_optimization_level(level)
+                compiler.code_generator.set_advanced_allocation(advanced)
+                if not compiler.compile_to_executable(source_file, executable):
+                    rows.append((label, None, "build failed", None))
+                    continue
+                rows.append((label,) + time_executable(executable) + (_perf_instructions([executable]),))
             
-            return True
+            for index, (label, flag) in enumerate(references):
+                source_file = os.path.join(workdir, f"{kernel}_gcc{index}.c")
+                executable = source_file[:-2]
+                with open(source_file, 'w') as f:
+                    f.write(source_code)
+                result = subprocess.run(['gcc', flag, '-w', '-o', executable, source_file],
+                                        capture_output=True, text=True)
+                if result.returncode != 0:
+                    rows.append((label, None, "build failed", None))
+                    continue
+                rows.append((label,) + time_executable(executable) + (_perf_instructions([executable]),))
             
-        except FileNotFoundError as e:
-            print(f"❌ Tool not found: {e}. Install GNU binutils (as, ld)")
-            return False
+            baseline = next((seconds for _, seconds, status, _ in rows
+                             if seconds is not None and status == expected), None)
+            print(f"\n   {kernel} (expected exit status {expected})")
+            print(f"   {'Configuration':<24} {'Time (ms)':>10} {'Speedup':>8} {'Instructions':>14}  Result")
+            for label, seconds, status, instructions in rows:
+                counted = f"{instructions:,}" if instructions is not None else "n/a"
+                if seconds is None:
+                    print(f"   {label:<24} {'-':>10} {'-':>8} {'-':>14}  ❌ {status}")
+                    continue
+                built_any = True
+                if status != expected:
+                    mismatches += 1
+                    print(f"   {label:<24} {'-':>10} {'-':>8} {counted:>14}  ❌ exit status {status}")
+                    continue
+                speedup = f"{baseline / seconds:.2f}x" if baseline else "-"
+                print(f"   {label:<24} {seconds * 1000:>10.2f} {speedup:>8} {counted:>14}  ✅")
+    log.set_level(saved_level)
+    
+    if not built_any:
+        log.error("❌ No kernel could be built; is GNU binutils installed?")
+        return False
+    if mismatches:
+        print(f"\n⚠️  {mismatches} build(s) produced the wrong exit status and were not timed")
+    return True
+
+# ============================================================================
+# DIFFERENTIAL TESTING
+# ============================================================================
+
+class CSourcePrinter:
+    """Print an AST back as C source (fully parenthesized expressions)."""
+    
+    ESCAPES = {'\\': '\\\\', '"': '\\"', '\n': '\\n', '\t': '\\t', '\r': '\\r', '\0': '\\0'}
+    
+    def __init__(self):
+        self.lines = []
+    
+    def print_program(self, program: Program) -> str:
+        self.lines = []
+        for declaration in program.declarations:
+            if isinstance(declaration, FunctionDeclaration):
+                self.print_function(declaration)
+            elif isinstance(declaration, VariableDeclaration):
+                self.lines.append(self.declaration(declaration))
+            self.lines.append("")
+        return "\n".join(self.lines)
+    
+    def print_function(self, node: FunctionDeclaration):
+        parameters = ", ".join(f"{p.type} {p.name}" for p in node.parameters)
+        signature = f"{node.return_type} {node.name}({parameters})"
+        if node.body is None:
+            self.lines.append(signature + ";")
+            return
+        self.lines.append(signature + " {")
+        for statement in node.body.statements:
+            self.print_statement(statement, 1)
+        self.lines.append("}")
+    
+    def declaration(self, node: VariableDeclaration) -> str:
+        if node.initializer is None:
+            return f"{node.type} {node.name};"
+        return f"{node.type} {node.name} = {self.expression(node.initializer, True)};"
+    
+    def print_statement(self, node: ASTNode, depth: int):
+        pad = "    " * depth
+        if isinstance(node, CompoundStatement):
+            self.lines.append(pad + "{")
+            for statement in node.statements:
+                self.print_statement(statement, depth + 1)
+            self.lines.append(pad + "}")
+        elif isinstance(node, VariableDeclaration):
+            self.lines.append(pad + self.declaration(node))
+        elif isinstance(node, ExpressionStatement):
+            text = self.expression(node.expression, True) if node.expression else ""
+            self.lines.append(f"{pad}{text};")
+        elif isinstance(node, ReturnStatement):
+            if node.expression is None:
+                self.lines.append(pad + "return;")
+            else:
+                self.lines.append(f"{pad}return {self.expression(node.expression, True)};")
+        elif isinstance(node, IfStatement):
+            self.lines.append(f"{pad}if ({self.expression(node.condition, True)})")
+            self.print_body(node.then_statement, depth)
+            if node.else_statement is not None:
+                self.lines.append(pad + "else")
+                self.print_body(node.else_statement, depth)
+        elif isinstance(node, WhileStatement):
+            self.lines.append(f"{pad}while ({self.expression(node.condition, True)})")
+            self.print_body(node.body, depth)
+        elif isinstance(node, ForStatement):
+            clauses = [self.expression(clause, True) if clause is not None else ""
+                       for clause in (node.init, node.condition, node.update)]
+            self.lines.append(f"{pad}for ({clauses[0]}; {clauses[1]}; {clauses[2]})")
+            self.print_body(node.body, depth)
+        else:
+            self.lines.append(f"{pad}{self.expression(node, True)};")
+    
+    def print_body(self, node: ASTNode, depth: int):
+        """Bodies are always braced so dangling else can't change meaning."""
+        if isinstance(node, CompoundStatement):
+            self.print_statement(node, depth)
+        else:
+            self.print_statement(CompoundStatement([node]), depth)
+    
+    def expression(self, node: ASTNode, top_level: bool = False) -> str:
+        if isinstance(node, IntegerLiteral):
+            return str(node.value) if node.value >= 0 else f"({node.value})"
+        if isinstance(node, FloatLiteral):
+            return repr(node.value)
+        if isinstance(node, Identifier):
+            return node.name
+        if isinstance(node, StringLiteral):
+            return '"' + "".join(self.ESCAPES.get(c, c) for c in node.value) + '"'
+        if isinstance(node, CharLiteral):
+            return f"'{node.value}'"
+        if isinstance(node, CallExpression):
+            arguments = ", ".join(self.expression(a, True) for a in node.arguments)
+            return f"{self.expression(node.function)}({arguments})"
+        if isinstance(node, UnaryExpression):
+            if node.operator.startswith('post'):
+                text = f"{self.expression(node.operand)}{node.operator[4:]}"
+            else:
+                text = f"{node.operator}{self.expression(node.operand)}"
+        elif isinstance(node, (BinaryExpression, AssignmentExpression)):
+            text = f"{self.expression(node.left)} {node.operator} {self.expression(node.right)}"
+        else:
+            raise ValueError(f"cannot print {type(node).__name__}")
+        return text if top_level else f"({text})"
+
+class ExecutionTimeout(Exception):
+    """A program under differential test ran past its time limit."""
+    pass
+
+class DifferentialTester:
+    """
+    Run programs through this compiler and the system gcc and compare.
+    
+    Each configuration is a (backend, optimization level) pair; the
+    'vm' backend executes on the bytecode VM, 'native' builds an executable
+    with compile_to_executable. An outcome is (exit status, stdout), or
+    ('error', message) when the program fails to build or run.
+    """
+    
+    BACKENDS = ('vm', 'native')
+    LEVELS = (0, 1, 2, 3, 's')
+    GCC_STRICTNESS = ['-Werror=uninitialized', '-Werror=maybe-uninitialized', '-Werror=return-type',
+                      '-Werror=implicit-function-declaration', '-Werror=implicit-int',
+                      '-Werror=int-conversion', '-Werror=incompatible-pointer-types',
+                      '-fsanitize=undefined', '-fno-sanitize-recover=undefined']
+    
+    def __init__(self, backends: List[str], timeout: float = 5.0, workdir: Optional[str] = None):
+        import tempfile
+        self.backends = backends
+        self.timeout = timeout
+        self.workdir = workdir or tempfile.mkdtemp(prefix="vibe-cc-diff-")
+        self.configurations = [(backend, level) for backend in backends for level in self.LEVELS]
+        self.runs = 0
+    
+    def _source_file(self, source: str, tag: str) -> str:
+        path = os.path.join(self.workdir, f"{tag}.c")
+        with open(path, 'w') as f:
+            f.write(source)
+        return path
+    
+    def _execute(self, command: List[str], env: Optional[Dict[str, str]] = None) -> Tuple:
+        import subprocess
+        try:
+            result = subprocess.run(command, capture_output=True, text=True, timeout=self.timeout,
+                                    env=env)
+        except subprocess.TimeoutExpired:
+            return ('error', 'timeout')
+        if result.returncode < 0:
+            return ('error', f"killed by signal {-result.returncode}")
+        return (result.returncode, result.stdout)
+    
+    def reference(self, source: str) -> Tuple:
+        """Outcome of the program built by gcc (the oracle)."""
+        import subprocess
+        self.runs += 1
+        source_file = self._source_file(source, "reference")
+        executable = source_file[:-2]
+        # The subset has no preprocessor, so printf's prototype is injected. Programs
+        # with undefined behavior have no reference result: uninitialized reads, missing
+        # returns and type confusion fail the build, and UBSan aborts on overflow or
+        # division by zero. Without abort_on_error UBSan exits with status 1, which
+        # would pass for an ordinary result.
+        result = subprocess.run(['gcc', '-O0', '-include', 'stdio.h'] + self.GCC_STRICTNESS +
+                                ['-o', executable, source_file], capture_output=True, text=True)
+        if result.returncode != 0:
+            errors = [line for line in result.stderr.splitlines() if 'error' in line]
+            return ('error', errors[0] if errors else 'gcc failed')
+        import os
+        env = dict(os.environ, UBSAN_OPTIONS='abort_on_error=1:print_stacktrace=0')
+        return self._execute([executable], env)
+    
+    def observe(self, source: str, backend: str, level: int) -> Tuple:
+        """Outcome of the program built by this compiler (its diagnostics are discarded)."""
+        import io
+        import contextlib
+        with contextlib.redirect_stdout(io.StringIO()):
+            return self._observe(source, backend, level)
+    
+    def _observe(self, source: str, backend: str, level: int) -> Tuple:
+        import io
+        self.runs += 1
+        compiler = CCompiler()
+        compiler.set_optimization_level(level)
+        
+        if backend == 'native':
+            source_file = self._source_file(source, f"native_O{level}")
+            if not compiler.compile_to_executable(source_file, source_file[:-2]):
+                return ('error', compiler.errors[-1] if compiler.errors else 'build failed')
+            return self._execute([source_file[:-2]])
+        
+        import signal
+        def expire(signum, frame):
+            raise ExecutionTimeout()
+        
+        output = io.StringIO()
+        previous = signal.signal(signal.SIGALRM, expire)
+        signal.setitimer(signal.ITIMER_REAL, self.timeout)
+        try:
+            program = compiler.analyze_source(source)
+            if program is None:
+                return ('error', 'compilation failed')
+            status = BytecodeVM(BytecodeCompiler().compile_program(program), output=output).run("main")
+            return (int(status) & 0xFF, output.getvalue())
+        except ExecutionTimeout:
+            return ('error', 'timeout')
+        except (VMError, SyntaxError, RecursionError) as e:
+            return ('error', f"{type(e).__name__}: {e}")
         except Exception as e:
-            print(f"❌ Build error: {e}")
+            return ('error', f"compiler crash: {type(e).__name__}: {e}")
+        finally:
+            signal.setitimer(signal.ITIMER_REAL, 0)
+            signal.signal(signal.SIGALRM, previous)
+    
+    def check(self, source: str) -> Tuple[Optional[Tuple], List[Tuple]]:
+        """Reference outcome and the (configuration, outcome) pairs that differ from it."""
+        expected = self.reference(source)
+        if expected[0] == 'error':
+            return expected, []
+        mismatches = []
+        for backend, level in self.configurations:
+            actual = self.observe(source, backend, level)
+            if actual != expected:
+                mismatches.append(((backend, level), actual))
+        return expected, mismatches
+    
+    # ------------------------------------------------------------------------
+    # Test case minimization
+    # ------------------------------------------------------------------------
+    
+    def minimize(self, source: str, configuration: Tuple[str, int], max_tests: int = 400) -> str:
+        """
+        Greedily shrink a failing program while it still fails the same way.
+        
+        Reductions delete declarations and statements, replace if/loops by
+        their bodies and expressions by operands or constants. A candidate
+        is kept only if gcc still builds and runs it and the configuration
+        still disagrees with the same kind of outcome (wrong result versus
+        build/run error), so the search can't wander off to a different bug.
+        """
+        import copy
+        backend, level = configuration
+        
+        def kind(outcome: Tuple) -> str:
+            """'result' for a wrong answer, else the error class (e.g. 'VMError')."""
+            return outcome[1].split(':')[0] if outcome[0] == 'error' else 'result'
+        
+        original = kind(self.observe(source, backend, level))
+        
+        def interesting(candidate_source: str) -> bool:
+            expected = self.reference(candidate_source)
+            if expected[0] == 'error':
+                return False
+            actual = self.observe(candidate_source, backend, level)
+            return actual != expected and kind(actual) == original
+        
+        best = Parser(Lexer(source).tokenize()).parse()
+        best_source = CSourcePrinter().print_program(best)
+        if not interesting(best_source):
+            return source  # The printed form no longer reproduces; keep the input as-is
+        
+        tests = 0
+        progress = True
+        while progress and tests < max_tests:
+            progress = False
+            index = 0
+            while index < len(list(self._reduction_slots(best))) and tests < max_tests:
+                for replacement in self._replacements(best, index):
+                    candidate = copy.deepcopy(best)
+                    self._apply(candidate, index, replacement)
+                    candidate_source = CSourcePrinter().print_program(candidate)
+                    tests += 1
+                    if interesting(candidate_source):
+                        best, best_source, progress = candidate, candidate_source, True
+                        break
+                else:
+                    index += 1
+        log.debug("   🔬 Minimization ran %s candidate programs", tests)
+        return best_source
+    
+    EXPRESSIONS = (BinaryExpression, UnaryExpression, AssignmentExpression, CallExpression,
+                   Identifier, IntegerLiteral)
+    
+    def _reduction_slots(self, node: ASTNode):
+        """Yield (container, key) for every reducible child position, in tree order."""
+        import dataclasses
+        for field_info in dataclasses.fields(node):
+            value = getattr(node, field_info.name)
+            if isinstance(value, list):
+                for index, item in enumerate(value):
+                    if isinstance(item, ASTNode) and not isinstance(item, Parameter):
+                        yield (value, index)
+                        yield from self._reduction_slots(item)
+            elif isinstance(value, ASTNode):
+                yield (node, field_info.name)
+                yield from self._reduction_slots(value)
+    
+    def _slot(self, tree: ASTNode, index: int):
+        for position, slot in enumerate(self._reduction_slots(tree)):
+            if position == index:
+                return slot
+        raise IndexError(index)
+    
+    def _replacements(self, tree: ASTNode, index: int) -> List:
+        """Smaller stand-ins for the node at slot index (None deletes a list item)."""
+        container, key = self._slot(tree, index)
+        node = container[key] if isinstance(container, list) else getattr(container, key)
+        candidates = []
+        if isinstance(container, FunctionDeclaration):
+            return candidates  # A function body must stay a block
+        if isinstance(container, list) and not (isinstance(node, FunctionDeclaration) and node.name == "main"):
+            candidates.append(None)
+        if isinstance(node, IfStatement):
+            candidates.extend(s for s in (node.then_statement, node.else_statement) if s is not None)
+        elif isinstance(node, (WhileStatement, ForStatement)):
+            candidates.append(node.body)
+        elif isinstance(node, CompoundStatement) and len(node.statements) == 1:
+            candidates.append(node.statements[0])
+        elif isinstance(node, self.EXPRESSIONS) and not isinstance(container, CallExpression):
+            candidates.extend(child for child in iter_child_nodes(node)
+                              if isinstance(child, self.EXPRESSIONS))
+            if not (isinstance(node, IntegerLiteral) and node.value in (0, 1)):
+                candidates.extend([IntegerLiteral(0), IntegerLiteral(1)])
+        return candidates
+    
+    def _apply(self, tree: ASTNode, index: int, replacement: Optional[ASTNode]):
+        import copy
+        container, key = self._slot(tree, index)
+        if replacement is None:
+            del container[key]
+        elif isinstance(container, list):
+            container[key] = copy.deepcopy(replacement)
+        else:
+            setattr(container, key, copy.deepcopy(replacement))
+
+DIFFERENTIAL_CORPUS = {
+    'vm_benchmark': VM_BENCHMARK_SOURCE,
+    **CODEGEN_BENCHMARK_KERNELS,
+    # The peephole folds the add into an immediate right before main's
+    # return jump; skipping one line too many exits through the fall-off path
+    'add_after_call': """int helper(int x) {
+    return x * 2;
+}
+
+int main() {
+    return helper(20) + 1;
+}
+""",
+    # The second call must not overwrite the first call's result in %rax
+    'call_plus_call': """int square(int x) {
+    return x * x;
+}
+
+int add3(int x) {
+    return x + 3;
+}
+
+int main() {
+    return square(4) + add3(2);
+}
+""",
+    # A constant-returning callee with side effects must still be called
+    'impure_constant_call': """int g = 0;
+
+int setg() {
+    g = 7;
+    return 1;
+}
+
+int useg() {
+    return g + 1;
+}
+
+int keep(int x) {
+    return 3;
+}
+
+int main() {
+    int x = 0;
+    int y = keep(x = 5);
+    setg();
+    return useg() * 10 + x + y;
+}
+""",
+    # Loop fusion must recognize the canonical i++ and i += k updates
+    'fused_loops': """int main() {
+    int i;
+    int s = 0;
+    int t = 0;
+    for (i = 0; i < 10; i++) {
+        s = s + i;
+    }
+    for (i = 0; i < 10; i++) {
+        t = t + i * 2;
+    }
+    int u = 0;
+    int w = 0;
+    for (i = 0; i < 20; i += 2) {
+        u = u + i;
+    }
+    for (i = 0; i < 20; i += 2) {
+        w = w + 1;
+    }
+    return s + t + u + w + i;
+}
+""",
+}
+
+def run_differential(args) -> bool:
+    """Check every source (or the built-in corpus) against gcc; True if all agree."""
+    import shutil
+    
+    if not shutil.which('gcc'):
+        log.error("❌ Differential testing needs gcc on PATH as the reference compiler")
+        return False
+    backends = [b.strip() for b in args.diff_backends.split(',') if b.strip()]
+    unknown = [b for b in backends if b not in DifferentialTester.BACKENDS]
+    if unknown:
+        log.error("❌ Unknown backend(s) %s (expected %s)", ", ".join(unknown), ", ".join(DifferentialTester.BACKENDS))
+        return False
+    
+    programs = {}
+    reproduce = {}  # Program name -> command line that regenerates it
+    for source in args.sources:
+        with open(source, 'r') as f:
+            programs[source] = f.read()
+    if args.fuzz:
+        import dataclasses
+        try:
+            shape = ProgramShape.parse(args.shape or "", FUZZ_SHAPE)
+        except ValueError as e:
+            log.error("❌ Invalid --shape: %s", e)
             return False
+        for seed in range(shape.seed, shape.seed + args.fuzz):
+            seeded = dataclasses.replace(shape, seed=seed)
+            name = f"random program (seed {seed})"
+            programs[name] = RandomProgramGenerator(seeded).generate()
+            knobs = ",".join(f"{key}={value}" for key, value in dataclasses.asdict(seeded).items())
+            reproduce[name] = f"--generate --shape {knobs} -o fuzz{seed}.c"
+    if not programs:
+        programs = dict(DIFFERENTIAL_CORPUS)
+    
+    tester = DifferentialTester(backends)
+    configurations = ", ".join(f"{b} -O{l}" for b, l in tester.configurations)
+    print(f"🔀 Differential testing {len(programs)} program(s) against gcc: {configurations}")
+    failures = 0
+    skipped = 0
+    for name, source in programs.items():
+        expected, mismatches = tester.check(source)
+        if expected[0] == 'error':
+            skipped += 1
+            print(f"   ⚠️  {name}: skipped, gcc reference failed ({expected[1]})")
+            continue
+        if not mismatches:
+            print(f"   ✅ {name}: exit status {expected[0]}, all configurations agree")
+            continue
+        failures += 1
+        print(f"   ❌ {name}: gcc gives exit status {expected[0]}")
+        if name in reproduce:
+            print(f"      Reproduce with: python3 c-compiler.py {reproduce[name]}")
+        for (backend, level), actual in mismatches:
+            if actual[0] == 'error':
+                detail = " ".join(actual[1].split())  # Toolchain errors span several lines
+            elif actual[0] != expected[0]:
+                detail = f"exit status {actual[0]}"
+            else:
+                detail = f"stdout differs: {actual[1]!r} vs {expected[1]!r}"
+            print(f"      {backend} -O{level}: {detail}")
+        if args.diff_minimize:
+            reduced = tester.minimize(source, mismatches[0][0])
+            backend, level = mismatches[0][0]
+            print(f"      Minimized failing input for {backend} -O{level}:")
+            for line in reduced.strip().splitlines():
+                print(f"      | {line}")
+    
+    shutil.rmtree(tester.workdir, ignore_errors=True)
+    print(f"🔀 {len(programs) - failures - skipped} passed, {failures} failed, {skipped} skipped "
+          f"({tester.runs} runs)")
+    return failures == 0
+
+# ============================================================================
+# COMPILER SERVER
+# ============================================================================
+
+def default_socket_path() -> str:
+    """
+    Per-user socket path shared by --server and c-compiler-client.py.
+    
+    The socket lives in $XDG_RUNTIME_DIR, or else in a private directory
+    under /tmp, never at a predictable path in a world-writable directory.
+    """
+    if os.environ.get('VIBE_CC_SOCKET'):
+        return os.environ['VIBE_CC_SOCKET']
+    if os.environ.get('XDG_RUNTIME_DIR'):
+        return os.path.join(os.environ['XDG_RUNTIME_DIR'], "vibe-cc.sock")
+    return f"/tmp/vibe-cc-{os.getuid()}/server.sock"
+
+def socket_directory_problem(directory: str) -> Optional[str]:
+    """Why another user could replace a socket in directory, or None if they cannot."""
+    import stat
+    info = os.lstat(directory)
+    if not stat.S_ISDIR(info.st_mode):
+        return "is not a directory"
+    if info.st_uid not in (os.getuid(), 0):
+        return f"is owned by uid {info.st_uid}"
+    if info.st_mode & 0o022 and not info.st_mode & stat.S_ISVTX:
+        return "is writable by other users"
+    return None
+
+def peer_uid(connection) -> Optional[int]:
+    """User id of the process on the other end of a Unix socket (None where unsupported)."""
+    import socket
+    import struct
+    if not hasattr(socket, 'SO_PEERCRED'):
+        return None
+    credentials = connection.getsockopt(socket.SOL_SOCKET, socket.SO_PEERCRED, struct.calcsize('3i'))
+    return struct.unpack('3i', credentials)[1]
+
+class StreamForwarder:
+    """File-like object that forwards writes to the client as JSON lines."""
+    
+    def __init__(self, wfile, stream: str):
+        self.wfile = wfile
+        self.stream = stream
+    
+    def write(self, data: str) -> int:
+        if data:
+            import json
+            message = json.dumps({'stream': self.stream, 'data': data}) + "\n"
+            self.wfile.write(message.encode())
+            self.wfile.flush()
+        return len(data)
+    
+    def flush(self):
+        self.wfile.flush()
+    
+    def isatty(self) -> bool:
+        return False
+
+def serve_compile_request(rfile, wfile):
+    """
+    Handle one client request in a forked child of the warm server.
+    
+    Protocol (one JSON object per line):
+    - client -> server: {"argv": [...], "cwd": "/path"}
+    - server -> client: {"stream": "stdout"|"stderr", "data": "..."} ...
+    - server -> client: {"exit": status}
+    """
+    import json
+    stderr = StreamForwarder(wfile, 'stderr')
+    try:
+        request = json.loads(rfile.readline().decode())
+        argv = [str(arg) for arg in request['argv']]
+        os.chdir(request.get('cwd', os.getcwd()))
+    except (ValueError, KeyError, TypeError, OSError) as e:
+        stderr.write(f"❌ Bad request: {e}\n")
+        wfile.write((json.dumps({'exit': 2}) + "\n").encode())
+        return
+    
+    sys.stdout = StreamForwarder(wfile, 'stdout')
+    sys.stderr = stderr
+    status = 0
+    try:
+        if '--server' in argv:
+            print("❌ Error: --server cannot be forwarded to a running server", file=sys.stderr)
+            status = 2
+        else:
+            main(argv)
+    except SystemExit as e:
+        if isinstance(e.code, int):
+            status = e.code
+        elif e.code:
+            print(e.code, file=sys.stderr)
+            status = 1
+    except Exception as e:
+        print(f"❌ Internal compiler error: {e}", file=sys.stderr)
+        status = 1
+    finally:
+        sys.stdout, sys.stderr = sys.__stdout__, sys.__stderr__
+    wfile.write((json.dumps({'exit': status}) + "\n").encode())
+    wfile.flush()
+
+def run_server(socket_path: str, workers: int):
+    """
+    Serve compile requests on a Unix domain socket until interrupted.
+    
+    The compiler module is imported and warmed once; each request runs in a
+    forked child, so requests are isolated (cwd, globals, crashes) while
+    skipping interpreter startup. At most `workers` requests run at once.
+    """
+    import socketserver
+    # Import everything requests use lazily, so forked children start warm
+    import argparse, json, subprocess, hashlib, tempfile, concurrent.futures  # noqa: F401
+    
+    class Handler(socketserver.StreamRequestHandler):
+        def handle(self):
+            if peer_uid(self.request) not in (None, os.getuid()):
+                return  # Requests carry paths and sources; only serve this user
+            serve_compile_request(self.rfile, self.wfile)
+    
+    class Server(socketserver.ForkingMixIn, socketserver.UnixStreamServer):
+        max_children = workers
+    
+    import stat
+    directory = os.path.dirname(os.path.abspath(socket_path))
+    old_umask = os.umask(0o077)  # Directory and socket are private to this user
+    try:
+        os.makedirs(directory, exist_ok=True)
+        problem = socket_directory_problem(directory)
+        if problem:
+            log.error("❌ Error: socket directory %s %s", directory, problem)
+            sys.exit(1)
+        
+        if os.path.lexists(socket_path):
+            info = os.lstat(socket_path)
+            if not stat.S_ISSOCK(info.st_mode) or info.st_uid != os.getuid():
+                log.error("❌ Error: %s exists and is not a socket of this user; not replacing it",
+                          socket_path)
+                sys.exit(1)
+            import socket
+            probe = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            try:
+                probe.connect(socket_path)
+                log.error("❌ Error: a server is already listening on %s", socket_path)
+                sys.exit(1)
+            except OSError:
+                os.unlink(socket_path)  # Stale socket from a dead server
+            finally:
+                probe.close()
+        
+        server = Server(socket_path, Handler)
+    finally:
+        os.umask(old_umask)
+    bound = os.stat(socket_path).st_ino
+    
+    def shutdown(signum, frame):
+        raise KeyboardInterrupt
+    import signal
+    signal.signal(signal.SIGTERM, shutdown)
+    
+    log.info("🛰️  Compiler server listening on %s (%s workers)", socket_path, workers)
+    option = "" if socket_path == default_socket_path() else f"--socket {socket_path} "
+    log.info("   Connect with: python3 c-compiler-client.py %s<compiler arguments>", option)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        log.info("\n🛑 Shutting down compiler server")
+    finally:
+        server.server_close()
+        # Only remove the socket this server created, not a later server's
+        if os.path.lexists(socket_path) and os.lstat(socket_path).st_ino == bound:
+            os.unlink(socket_path)
 
 # ============================================================================
 # COMMAND LINE INTERFACE
 # ============================================================================
 
-def main():
-    """Main entry point for the C compiler."""
+def main(argv: Optional[List[str]] = None):
+    """Main entry point for the C compiler (argv defaults to sys.argv[1:])."""
     import argparse
     
+    if argv is None:
+        argv = sys.argv[1:]
+    
     parser = argparse.ArgumentParser(description='🔧 VIBE-PY C Compiler')
-    parser.add_argument('source', help='C source file (.c)')
+    parser.add_argument('sources', nargs='*', metavar='source', help='C source files (.c)')
     parser.add_argument('-o', '--output', help='Output file name')
     parser.add_argument('-S', '--assembly', action='store_true', 
                        help='Generate assembly only (.s file)')
@@ -4481,38 +10971,314 @@ def main():
                        help='Enable basic optimizations (default)')
     parser.add_argument('-O2', '--optimize-more', action='store_true',
                        help='Enable aggressive optimizations')
+    parser.add_argument('-O3', '--optimize-max', action='store_true',
+                       help='Enable aggressive optimizations with larger unswitching and unrolling limits')
+    parser.add_argument('-Os', '--optimize-size', action='store_true',
+                       help='Optimize without passes that grow code (no unswitching or unrolling)')
+    parser.add_argument('--passes', metavar='LIST',
+                       help='Run this pass pipeline instead of the -O level\'s, e.g. '
+                            '"constprop,dce,unroll(factor=4),globaldce,peephole" '
+                            f'(passes: {", ".join(OPTIMIZATION_PASSES)})')
     parser.add_argument('--no-advanced-regs', action='store_true',
                        help='Disable advanced register allocation (use simple stack allocation)')
-    
-    if len(sys.argv) == 1:
+    parser.add_argument('-j', '--jobs', type=int, default=1,
+                       help='Compile multiple source files in N parallel worker processes')
+    parser.add_argument('--codegen-jobs', type=int, default=1, metavar='N',
+                       help='Generate the functions of each file in N parallel worker processes')
+    parser.add_argument('-flto', '--lto', action='store_true',
+                       help='Link-time optimization: compile sources to IR (.ir with -c), then merge '
+                            'and optimize the whole program before code generation')
+    parser.add_argument('--lto-partitions', type=int, default=1, metavar='N',
+                       help='Generate LTO code in N partitions (in parallel with -j)')
+    parser.add_argument('-g', action='store_true', dest='debug_info',
+                       help='Emit DWARF line tables and function ranges so debuggers and '
+                            'profilers can map instructions back to source lines')
+    parser.add_argument('-fsave-optimization-record', '--save-optimization-record',
+                        action='store_true', dest='optimization_record',
+                        help='Write optimization remarks (applied, missed and analysis, with reasons '
+                             'and metrics) as JSON Lines to <unit>.opt.jsonl')
+    parser.add_argument('-foptimization-record-file', '--optimization-record-file', metavar='FILE',
+                        help='Optimization record path for a single-file build (implies '
+                             '-fsave-optimization-record)')
+    parser.add_argument('--cache', action='store_true',
+                       help='Reuse assembly and objects from the persistent compilation cache')
+    parser.add_argument('--cache-dir', metavar='DIR',
+                       help='Cache directory (default: $VIBE_CC_CACHE_DIR or ~/.cache/vibe-cc)')
+    parser.add_argument('--cache-max-size', metavar='SIZE', type=parse_size,
+                       help='Evict least recently used entries above SIZE (e.g. 64M, default 256M)')
+    parser.add_argument('--cache-stats', action='store_true',
+                       help='Print compilation cache statistics and exit')
+    parser.add_argument('--cache-clear', action='store_true',
+                       help='Remove all compilation cache entries and exit')
+    parser.add_argument('--run', action='store_true',
+                       help='Execute the program on the built-in bytecode VM (no assembler or linker needed)')
+    parser.add_argument('--dump-bytecode', action='store_true',
+                       help='Print the bytecode listing when using --run')
+    parser.add_argument('--profile-run', action='store_true',
+                       help='Build the executable with -g, run it under perf (or a ptrace sampler) '
+                            'and report the hottest functions and source lines')
+    parser.add_argument('--benchmark', choices=sorted(BENCHMARKS),
+                       help='Run a built-in benchmark instead of compiling')
+    parser.add_argument('--iterations', type=int, default=5,
+                       help='Iterations per benchmark measurement (default: 5)')
+    parser.add_argument('--differential', action='store_true',
+                       help='Compare this compiler at -O0 to -O3 and -Os against gcc on the sources '
+                            '(or a built-in corpus) and report mismatches')
+    parser.add_argument('--diff-backends', default='vm', metavar='LIST',
+                       help='Backends to test differentially: vm, native (default: vm)')
+    parser.add_argument('--fuzz', type=int, default=0, metavar='N',
+                       help='Add N random well-defined programs (seeds from --shape seed) to --differential')
+    parser.add_argument('--generate', action='store_true',
+                       help='Write a random well-defined program shaped by --shape to -o (or stdout)')
+    parser.add_argument('--scale', default='statements', metavar='KNOB',
+                       help='Shape knob doubled by --benchmark scaling (default: statements)')
+    parser.add_argument('--no-minimize', dest='diff_minimize', action='store_false',
+                       help='Report differential mismatches without minimizing the input')
+    parser.add_argument('--gcc-reference', action='store_true',
+                       help='Also time gcc -O0/-O2 builds in --benchmark codegen')
+    parser.add_argument('--shape', metavar='KEY=N,...',
+                       help='Synthetic program shape for --benchmark compiler: functions, statements, '
+                            'expression_depth, loop_nesting, identifiers, seed')
+    parser.add_argument('--baseline', metavar='JSON',
+                       help='Compare --benchmark compiler results against a saved baseline')
+    parser.add_argument('--save-baseline', metavar='JSON',
+                       help='Save --benchmark compiler results as a baseline')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                       help='Allowed slowdown in percent before a phase counts as regressed (default: 10)')
+    parser.add_argument('-q', '--quiet', action='store_true',
+                       help='Only report errors')
+    parser.add_argument('-v', '--verbose', action='count', default=0,
+                       help='Show per-pass details (-vv: per-node, register and token traces)')
+    parser.add_argument('--trace', metavar='FILE',
+                       help='Write a Chrome trace-event timeline of phases and passes (view in Perfetto)')
+    parser.add_argument('--mem-report', metavar='JSON', nargs='?', const='mem-report.json',
+                       help='Report memory per phase and pass (tracemalloc); JSON goes to '
+                            'JSON (default: mem-report.json)')
+    parser.add_argument('--time-report', metavar='JSON', nargs='?', const='time-report.json',
+                       help='Report wall/CPU time, runs, nodes and changes per phase, pass and '
+                            'analysis, in total and per function; JSON goes to JSON '
+                            '(default: time-report.json)')
+    parser.add_argument('--server', action='store_true',
+                       help='Serve compile requests from c-compiler-client.py on a Unix socket '
+                            '(-j sets the worker count)')
+    parser.add_argument('--socket', metavar='PATH',
+                       help='Server socket path, also read by c-compiler-client.py (default: '
+                            '$VIBE_CC_SOCKET, else $XDG_RUNTIME_DIR/vibe-cc.sock, '
+                            'else /tmp/vibe-cc-<uid>/server.sock)')
+    
+    if not argv:
         parser.print_help()
         print("\n📖 Examples:")
         print("  python3 c-compiler.py program.c                    # Generate assembly")
         print("  python3 c-compiler.py program.c -S                 # Generate assembly only")
         print("  python3 c-compiler.py program.c --executable       # Create executable")
         print("  python3 c-compiler.py program.c -o my_program      # Specify output name")
+        print("  python3 c-compiler.py a.c b.c -j 4 --executable    # Parallel multi-file build")
+        print("  python3 c-compiler.py a.c b.c -flto --executable   # Whole-program optimization")
+        print("  python3 c-compiler.py big.c --codegen-jobs 8       # Generate functions in parallel")
+        print("  python3 c-compiler.py program.c --passes=constprop,dse,peephole  # Custom pipeline")
+        print("  python3 c-compiler.py program.c -O2 -fsave-optimization-record  # Remarks → program.opt.jsonl")
+        print("  python3 c-compiler.py program.c --run              # Run on the bytecode VM")
+        print("  python3 c-compiler.py program.c --profile-run      # Find the hot source lines")
+        print("  python3 c-compiler.py a.c b.c -j 4 -c --cache      # Reuse cached assembly/objects")
+        print("  python3 c-compiler.py --cache-stats                # Show cache hit rate")
+        print("  python3 c-compiler.py --benchmark vm               # Benchmark the bytecode VM")
+        print("  python3 c-compiler.py --benchmark compiler --shape functions=100 --baseline base.json")
+        print("  python3 c-compiler.py --benchmark codegen --gcc-reference  # Time generated code per -O level")
+        print("  python3 c-compiler.py --differential tests/*.c         # Compare -O levels against gcc")
+        print("  python3 c-compiler.py --differential --fuzz 100        # Fuzz with random programs")
+        print("  python3 c-compiler.py --benchmark scaling --scale identifiers  # Find compile-time cliffs")
+        print("  python3 c-compiler.py program.c -vv                # Trace every pass, register and token")
+        print("  python3 c-compiler.py program.c --trace trace.json # Timeline for Perfetto")
+        print("  python3 c-compiler.py program.c --mem-report       # Memory per phase and pass")
+        print("  python3 c-compiler.py program.c --time-report      # Time per phase, pass and function")
+        print("  python3 c-compiler.py --server -j 8                # Keep a warm compiler running")
+        print("  python3 c-compiler-client.py program.c -O2         # Compile via the server")
         sys.exit(1)
     
-    args = parser.parse_args()
+    args = parser.parse_args(argv)
     
-    if not args.source.endswith('.c'):
-        print("❌ Error: Source file must have .c extension")
-        sys.exit(1)
+    # Resolve the optimization level once for compilation and benchmarks
+    args.opt_level = 1
+    if args.no_optimize:
+        args.opt_level = 0
+    elif args.optimize_more:
+        args.opt_level = 2
+    elif args.optimize_max:
+        args.opt_level = 3
+    elif args.optimize_size:
+        args.opt_level = 's'
+    if args.passes is not None:
+        try:
+            parse_pipeline(args.passes)
+        except ValueError as e:
+            parser.error(f"invalid --passes: {e}")
+    
+    args.source = args.sources[0] if args.sources else None
+    
+    if args.quiet:
+        args.log_level = LogLevel.ERROR
+    else:
+        args.log_level = LogLevel(min(LogLevel.INFO + args.verbose, LogLevel.TRACE))
+    log.set_level(args.log_level)
+    
+    profiler = None
+    if args.mem_report:
+        if args.jobs > 1:
+            log.info("🧠 --mem-report measures this process; compiling with -j 1")
+            args.jobs = 1
+        profiler = MemoryProfiler()
+        profiler.start()
+    timer = None
+    if args.time_report:
+        if args.jobs > 1:
+            log.info("⏱️  --time-report measures this process; compiling with -j 1")
+            args.jobs = 1
+        timer = TimeReport()
+        timer.start()
+    if args.trace:
+        tracer.enable()
+    if args.optimization_record or args.optimization_record_file:
+        if args.optimization_record_file and len(args.sources) > 1:
+            parser.error("-foptimization-record-file needs a single source; "
+                         "with several, each unit writes <unit>.opt.jsonl")
+        remarks.enable()
+    
+    try:
+        run_command(args, parser)
+    finally:
+        if args.trace:
+            tracer.save(args.trace)
+        if profiler:
+            profiler.report(args.mem_report)
+            profiler.stop()
+        if timer:
+            timer.report(args.time_report)
+            timer.stop()
+
+def save_remarks(args):
+    """Write the single-file build's optimization record, if requested."""
+    if remarks.enabled:
+        remarks.save(args.optimization_record_file or remarks_file(args.source))
+
+def run_command(args, parser):
+    """Dispatch the parsed command line (server, benchmark, build, run or compile)."""
+    if args.server:
+        run_server(args.socket or default_socket_path(),
+                   args.jobs if args.jobs > 1 else (os.cpu_count() or 1))
+        return
+    
+    if args.benchmark:
+        benchmark_func, _ = BENCHMARKS[args.benchmark]
+        sys.exit(0 if benchmark_func(args) else 1)
+    
+    if args.differential:
+        sys.exit(0 if run_differential(args) else 1)
+    
+    if args.generate:
+        try:
+            shape = ProgramShape.parse(args.shape or "", FUZZ_SHAPE)
+        except ValueError as e:
+            parser.error(f"invalid --shape: {e}")
+        program = RandomProgramGenerator(shape).generate()
+        if args.output:
+            with open(args.output, 'w') as f:
+                f.write(program)
+            log.info("🎲 Wrote random program (seed %s) to %s", shape.seed, args.output)
+        else:
+            sys.stdout.write(program)
+        return
+    
+    if args.cache_stats or args.cache_clear:
+        cache = CompilationCache(args.cache_dir, args.cache_max_size)
+        if args.cache_clear:
+            cache.clear()
+            log.info("🧹 Cleared compilation cache: %s", cache.directory)
+        if args.cache_stats:
+            cache.report()
+        return
+    
+    cache = None
+    if args.cache or args.cache_dir:
+        if remarks.enabled:
+            log.info("📝 Optimization records need the optimizer to run; not using the cache")
+        else:
+            cache = CompilationCache(args.cache_dir, args.cache_max_size)
+    
+    if not args.sources:
+        parser.error("the following arguments are required: source")
+    
+    extensions = ('.c', '.ir') if args.lto else ('.c',)
+    for source in args.sources:
+        if not source.endswith(extensions):
+            log.error("❌ Error: Source file must have %s extension: %s",
+                      " or ".join(extensions), source)
+            sys.exit(1)
+    
+    if len(args.sources) > 1 or args.jobs > 1 or args.compile_only or args.lto:
+        if args.run or args.profile_run:
+            parser.error("--run and --profile-run accept a single source file")
+        if args.compile_only and any(s.endswith('.ir') for s in args.sources):
+            parser.error("-c -flto compiles .c sources; pass .ir files when linking")
+        options = BuildOptions(optimization_level=args.opt_level,
+                               advanced_registers=not args.no_advanced_regs,
+                               emit_object=args.compile_only or args.executable,
+                               whole_program=len(args.sources) == 1 and args.executable,
+                               cache_dir=cache.directory if cache else None,
+                               cache_max_size=args.cache_max_size,
+                               log_level=args.log_level,
+                               trace=tracer.enabled,
+                               lto=args.lto and args.compile_only,
+                               codegen_jobs=args.codegen_jobs,
+                               passes=args.passes,
+                               remarks=remarks.enabled,
+                               debug_info=args.debug_info)
+        if args.lto and args.debug_info:
+            log.info("⚠️  -g is not supported with -flto; no line tables will be emitted")
+        if args.lto and not args.compile_only:
+            driver = LinkTimeOptimizer(options, args.jobs, args.lto_partitions)
+        else:
+            driver = BuildDriver(options, args.jobs)
+        if not driver.build(args.sources, args.output, link=args.executable):
+            sys.exit(1)
+        log.info("🎉 Build completed successfully!")
+        return
     
     compiler = CCompiler()
     
     # Set optimization level
-    if args.no_optimize:
-        compiler.set_optimization_level(0)
-    elif args.optimize_more:
-        compiler.set_optimization_level(2)
-    elif args.optimize:
-        compiler.set_optimization_level(1)
-    # Default is already 1
+    compiler.set_optimization_level(args.opt_level)
+    if args.passes is not None:
+        compiler.set_pipeline(args.passes)
     
     # Configure register allocation
     if args.no_advanced_regs:
         compiler.code_generator.set_advanced_allocation(False)
+    compiler.code_generator.set_jobs(args.codegen_jobs)
+    compiler.set_debug_info(args.debug_info)
+    
+    # Assembly output may be linked with other units; only a build that ends
+    # in an executable (or a run) sees the entire program
+    compiler.set_whole_program(args.executable or args.run or args.profile_run)
+    compiler.set_cache(cache)
+    remarks.begin(args.source)
+    
+    if args.run:
+        # Execute on the bytecode VM; main's return value is the exit status
+        status = compiler.run(args.source, args.dump_bytecode)
+        save_remarks(args)
+        if status is None:
+            sys.exit(1)
+        log.info("🏁 Program exited with status %s", status)
+        sys.exit(status & 0xFF)
+    
+    if args.profile_run:
+        status = compiler.profile_run(args.source, args.output)
+        save_remarks(args)
+        if status is None:
+            sys.exit(1)
+        log.info("🏁 Program exited with status %s", status)
+        sys.exit(status & 0xFF)
     
     if args.executable:
         # Compile to executable
@@ -4520,11 +11286,12 @@ def main():
     else:
         # Default: compile to assembly
         success = compiler.compile(args.source, args.output)
+    save_remarks(args)
     
     if not success:
         sys.exit(1)
     
-    print("🎉 Compilation completed successfully!")
+    log.info("🎉 Compilation completed successfully!")
 
 if __name__ == "__main__":
     main()
\ No newline at end of file